@@ -1,7 +1,30 @@
+#define _GNU_SOURCE
 #include <stdio.h>
 #include <stdbool.h>
 #include <stdlib.h>
 #include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <math.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/epoll.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <arpa/inet.h>
 
 // =====================================================================
 // DEFINIÇÕES DE CONSTANTES E ESTRUTURAS
@@ -39,6 +62,13 @@ typedef enum {
     SAIR = 4
 } NivelJogo;
 
+// Resultado de uma tentativa de posicionamento de navio
+typedef enum {
+    POSICIONAMENTO_OK,
+    POSICIONAMENTO_INVALIDO,
+    POSICIONAMENTO_SOBREPOSTO
+} ResultadoPosicionamento;
+
 // Estrutura para representar um navio
 typedef struct {
     int linha;
@@ -65,15 +95,185 @@ int abs(int valor) {
     return valor < 0 ? -valor : valor;
 }
 
+// Contadores de alocação de memória, um par por thread (consultados pelo benchmark, que mede cada
+// operação na própria thread). Por serem locais, contar não custa nenhuma operação atômica nem
+// disputa de linha de cache entre as threads que alocam.
+static _Thread_local long alocacoesDaThread = 0;
+static _Thread_local long bytesAlocadosDaThread = 0;
+
+static inline void contarAlocacao(void* memoria, size_t tamanho) {
+    if (memoria != NULL) {
+        alocacoesDaThread++;
+        bytesAlocadosDaThread += (long) tamanho;
+    }
+}
+
+// Funções de alocação usadas em todo o programa: equivalem a malloc/calloc/realloc/aligned_alloc,
+// mas registram cada alocação nos contadores da thread
+void* alocarMemoria(size_t tamanho) {
+    void* memoria = malloc(tamanho);
+    contarAlocacao(memoria, tamanho);
+    return memoria;
+}
+
+void* alocarMemoriaZerada(size_t quantidade, size_t tamanho) {
+    void* memoria = calloc(quantidade, tamanho);
+    contarAlocacao(memoria, quantidade * tamanho);
+    return memoria;
+}
+
+void* realocarMemoria(void* anterior, size_t tamanho) {
+    void* memoria = realloc(anterior, tamanho);
+    contarAlocacao(memoria, tamanho);
+    return memoria;
+}
+
+void* alocarMemoriaAlinhada(size_t alinhamento, size_t tamanho) {
+    void* memoria = aligned_alloc(alinhamento, tamanho);
+    contarAlocacao(memoria, tamanho);
+    return memoria;
+}
+
 // Função para limpar a tela (multiplataforma)
 void limparTela() {
     #ifdef _WIN32
         system("cls");
     #else
-        system("clear");
+        // Sequência ANSI: posiciona o cursor no início e apaga a tela, sem criar um processo de shell
+        fputs("\x1b[H\x1b[2J", stdout);
+        fflush(stdout);
     #endif
 }
 
+// Buffer de saída reutilizável: o texto é montado em memória e escrito de uma só vez
+typedef struct {
+    char* dados;
+    size_t tamanho;
+    size_t capacidade;
+} BufferSaida;
+
+// Função para garantir espaço para mais 'adicional' bytes no buffer
+static bool reservarBufferSaida(BufferSaida* buffer, size_t adicional) {
+    if (buffer->tamanho + adicional <= buffer->capacidade) {
+        return true;
+    }
+    
+    size_t nova_capacidade = buffer->capacidade > 0 ? buffer->capacidade : 1024;
+    while (nova_capacidade < buffer->tamanho + adicional) {
+        nova_capacidade *= 2;
+    }
+    char* dados = realocarMemoria(buffer->dados, nova_capacidade);
+    if (dados == NULL) {
+        return false;
+    }
+    buffer->dados = dados;
+    buffer->capacidade = nova_capacidade;
+    return true;
+}
+
+// Função para anexar bytes ao buffer
+void anexarBufferSaida(BufferSaida* buffer, const char* texto, size_t tamanho) {
+    if (reservarBufferSaida(buffer, tamanho)) {
+        memcpy(buffer->dados + buffer->tamanho, texto, tamanho);
+        buffer->tamanho += tamanho;
+    }
+}
+
+// Função para anexar texto formatado (como printf) ao buffer
+void formatarBufferSaida(BufferSaida* buffer, const char* formato, ...) {
+    va_list argumentos;
+    va_start(argumentos, formato);
+    int necessario = vsnprintf(NULL, 0, formato, argumentos);
+    va_end(argumentos);
+    
+    if (necessario < 0 || !reservarBufferSaida(buffer, (size_t) necessario + 1)) {
+        return;
+    }
+    va_start(argumentos, formato);
+    vsnprintf(buffer->dados + buffer->tamanho, (size_t) necessario + 1, formato, argumentos);
+    va_end(argumentos);
+    buffer->tamanho += (size_t) necessario;
+}
+
+// Função para escrever todo o conteúdo de uma área de memória em um descritor (trata escritas parciais)
+bool escreverTudo(int descritor, const char* dados, size_t tamanho) {
+    while (tamanho > 0) {
+        ssize_t escrito = write(descritor, dados, tamanho);
+        if (escrito < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        dados += escrito;
+        tamanho -= (size_t) escrito;
+    }
+    return true;
+}
+
+// Função para escrever o buffer na saída padrão com uma única chamada de sistema e esvaziá-lo
+void descarregarBufferSaida(BufferSaida* buffer) {
+    fflush(stdout);
+    escreverTudo(STDOUT_FILENO, buffer->dados, buffer->tamanho);
+    buffer->tamanho = 0;
+}
+
+// Função para liberar a memória do buffer
+void liberarBufferSaida(BufferSaida* buffer) {
+    free(buffer->dados);
+    buffer->dados = NULL;
+    buffer->tamanho = 0;
+    buffer->capacidade = 0;
+}
+
+// Função para obter um instante monotônico em segundos (para medições de tempo)
+double segundosMonotonicos() {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return agora.tv_sec + agora.tv_nsec / 1e9;
+}
+
+// Função para ler um inteiro com sinal opcional, avançando o cursor
+bool lerInteiroTexto(const char** cursor, int* valor) {
+    const char* p = *cursor;
+    bool negativo = false;
+    
+    if (*p == '-' || *p == '+') {
+        negativo = (*p == '-');
+        p++;
+    }
+    if (*p < '0' || *p > '9') {
+        return false;
+    }
+    
+    // Acumula com sinal negativo, cuja faixa inclui INT_MIN
+    int resultado = 0;
+    while (*p >= '0' && *p <= '9') {
+        int digito = *p - '0';
+        if (resultado < (INT_MIN + digito) / 10) {
+            return false;   // Não cabe em int: trata como erro de sintaxe
+        }
+        resultado = resultado * 10 - digito;
+        p++;
+    }
+    if (!negativo && resultado == INT_MIN) {
+        return false;
+    }
+    
+    *valor = negativo ? resultado : -resultado;
+    *cursor = p;
+    return true;
+}
+
+// Função para consumir um caractere esperado, avançando o cursor
+static inline bool consumirCaractere(const char** cursor, char esperado) {
+    if (**cursor != esperado) {
+        return false;
+    }
+    (*cursor)++;
+    return true;
+}
+
 // Função para pausar execução
 void pausar() {
     printf("\nPressione Enter para continuar...");
@@ -81,6 +281,168 @@ void pausar() {
     getchar(); // Para capturar o Enter pendente
 }
 
+// =====================================================================
+// INSTRUMENTAÇÃO OPCIONAL (CONTADORES E TEMPOS POR FASE)
+// =====================================================================
+
+// A instrumentação só existe quando o programa é compilado com -DBATALHA_INSTRUMENTACAO.
+// Sem essa definição, todas as macros abaixo se reduzem a nada e o custo é zero.
+// Com ela, as métricas são impressas em stderr na saída do programa e a cada SIGUSR1,
+// em texto ou em JSON (variável de ambiente BATALHA_METRICAS=json).
+
+// Fases cronometradas dos níveis do jogo
+typedef enum {
+    FASE_INICIALIZACAO,
+    FASE_POSICIONAMENTO,
+    FASE_CONSTRUCAO_HABILIDADES,
+    FASE_APLICACAO_HABILIDADES,
+    FASE_RENDERIZACAO,
+    NUM_FASES
+} FaseInstrumentada;
+
+// Contadores de eventos
+typedef enum {
+    CONTADOR_NAVIOS_POSICIONADOS,
+    CONTADOR_REJEICOES_POSICAO,
+    CONTADOR_REJEICOES_SOBREPOSICAO,
+    CONTADOR_HABILIDADES_APLICADAS,
+    CONTADOR_CELULAS_ESCRITAS,
+    CONTADOR_CELULAS_FORA_LIMITES,
+    CONTADOR_CELULAS_NAVIO_PRESERVADO,
+    NUM_CONTADORES
+} ContadorInstrumentado;
+
+#ifdef BATALHA_INSTRUMENTACAO
+
+static _Atomic uint64_t chamadasFase[NUM_FASES];
+static _Atomic uint64_t nanossegundosFase[NUM_FASES];
+static _Atomic uint64_t valoresContador[NUM_CONTADORES];
+static bool metricasEmJson = false;
+
+static const char* const nomesFases[NUM_FASES] = {
+    "inicializacao", "posicionamento", "construcao_habilidades", "aplicacao_habilidades", "renderizacao"
+};
+static const char* const nomesContadores[NUM_CONTADORES] = {
+    "navios_posicionados", "rejeicoes_posicao", "rejeicoes_sobreposicao", "habilidades_aplicadas",
+    "celulas_escritas", "celulas_fora_limites", "celulas_navio_preservado"
+};
+
+// Função para obter o instante monotônico em nanossegundos
+static inline uint64_t nanossegundosMonotonicos() {
+    struct timespec agora;
+    clock_gettime(CLOCK_MONOTONIC, &agora);
+    return (uint64_t) agora.tv_sec * 1000000000ULL + (uint64_t) agora.tv_nsec;
+}
+
+static inline void registrarFase(FaseInstrumentada fase, uint64_t nanossegundos) {
+    atomic_fetch_add_explicit(&chamadasFase[fase], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&nanossegundosFase[fase], nanossegundos, memory_order_relaxed);
+}
+
+#define INSTRUMENTAR_CONTAR(contador, quantidade) \
+    atomic_fetch_add_explicit(&valoresContador[contador], (uint64_t) (quantidade), memory_order_relaxed)
+#define INSTRUMENTAR_FASE_INICIO(fase) uint64_t inicio_##fase = nanossegundosMonotonicos()
+#define INSTRUMENTAR_FASE_FIM(fase) registrarFase(fase, nanossegundosMonotonicos() - inicio_##fase)
+
+// Funções de formatação seguras para uso dentro de tratadores de sinal (sem printf nem malloc)
+static void anexarTextoSeguro(char* destino, size_t* posicao, size_t capacidade, const char* texto) {
+    while (*texto != '\0' && *posicao + 1 < capacidade) {
+        destino[(*posicao)++] = *texto++;
+    }
+}
+
+static void anexarNumeroSeguro(char* destino, size_t* posicao, size_t capacidade, uint64_t valor) {
+    char digitos[24];
+    int quantidade = 0;
+    
+    do {
+        digitos[quantidade++] = (char) ('0' + valor % 10);
+        valor /= 10;
+    } while (valor > 0);
+    
+    while (quantidade > 0 && *posicao + 1 < capacidade) {
+        destino[(*posicao)++] = digitos[--quantidade];
+    }
+}
+
+// Função para imprimir todas as métricas em stderr (segura para tratadores de sinal)
+void despejarMetricas() {
+    char texto[4096];
+    size_t p = 0;
+    const size_t c = sizeof(texto);
+    
+    if (metricasEmJson) {
+        anexarTextoSeguro(texto, &p, c, "{\"fases\":{");
+        for (int f = 0; f < NUM_FASES; f++) {
+            anexarTextoSeguro(texto, &p, c, f > 0 ? ",\"" : "\"");
+            anexarTextoSeguro(texto, &p, c, nomesFases[f]);
+            anexarTextoSeguro(texto, &p, c, "\":{\"chamadas\":");
+            anexarNumeroSeguro(texto, &p, c, atomic_load_explicit(&chamadasFase[f], memory_order_relaxed));
+            anexarTextoSeguro(texto, &p, c, ",\"ns\":");
+            anexarNumeroSeguro(texto, &p, c, atomic_load_explicit(&nanossegundosFase[f], memory_order_relaxed));
+            anexarTextoSeguro(texto, &p, c, "}");
+        }
+        anexarTextoSeguro(texto, &p, c, "},\"contadores\":{");
+        for (int k = 0; k < NUM_CONTADORES; k++) {
+            anexarTextoSeguro(texto, &p, c, k > 0 ? ",\"" : "\"");
+            anexarTextoSeguro(texto, &p, c, nomesContadores[k]);
+            anexarTextoSeguro(texto, &p, c, "\":");
+            anexarNumeroSeguro(texto, &p, c, atomic_load_explicit(&valoresContador[k], memory_order_relaxed));
+        }
+        anexarTextoSeguro(texto, &p, c, "}}\n");
+    } else {
+        anexarTextoSeguro(texto, &p, c, "=== MÉTRICAS ===\n");
+        for (int f = 0; f < NUM_FASES; f++) {
+            anexarTextoSeguro(texto, &p, c, nomesFases[f]);
+            anexarTextoSeguro(texto, &p, c, ": ");
+            anexarNumeroSeguro(texto, &p, c, atomic_load_explicit(&chamadasFase[f], memory_order_relaxed));
+            anexarTextoSeguro(texto, &p, c, " chamadas, ");
+            anexarNumeroSeguro(texto, &p, c, atomic_load_explicit(&nanossegundosFase[f], memory_order_relaxed));
+            anexarTextoSeguro(texto, &p, c, " ns\n");
+        }
+        for (int k = 0; k < NUM_CONTADORES; k++) {
+            anexarTextoSeguro(texto, &p, c, nomesContadores[k]);
+            anexarTextoSeguro(texto, &p, c, ": ");
+            anexarNumeroSeguro(texto, &p, c, atomic_load_explicit(&valoresContador[k], memory_order_relaxed));
+            anexarTextoSeguro(texto, &p, c, "\n");
+        }
+    }
+    
+    ssize_t ignorado = write(STDERR_FILENO, texto, p);
+    (void) ignorado;
+}
+
+static void tratarSinalMetricas(int sinal) {
+    (void) sinal;
+    despejarMetricas();
+}
+
+// Função para ativar o despejo das métricas na saída do programa e em SIGUSR1
+void inicializarInstrumentacao() {
+    const char* formato = getenv("BATALHA_METRICAS");
+    metricasEmJson = formato != NULL && strcmp(formato, "json") == 0;
+    
+    atexit(despejarMetricas);
+    
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratarSinalMetricas;
+    acao.sa_flags = SA_RESTART;
+    sigemptyset(&acao.sa_mask);
+    sigaction(SIGUSR1, &acao, NULL);
+}
+
+#else
+
+#define INSTRUMENTAR_CONTAR(contador, quantidade) ((void) (quantidade))
+#define INSTRUMENTAR_FASE_INICIO(fase) do { } while (0)
+#define INSTRUMENTAR_FASE_FIM(fase) do { } while (0)
+
+void inicializarInstrumentacao() {
+}
+
+#endif
+
 // =====================================================================
 // FUNÇÕES BÁSICAS DO TABULEIRO
 // =====================================================================
@@ -98,6 +460,175 @@ void inicializarTabuleiro(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO]) {
     printf("Tabuleiro inicializado com sucesso!\n\n");
 }
 
+// Estatísticas mantidas junto com o tabuleiro: cada escrita de célula atualiza os contadores,
+// então as consultas são O(1) e nunca exigem varrer o tabuleiro inteiro
+typedef struct {
+    int agua;
+    int navios;
+    int efeito;
+    int navios_linha[TAMANHO_TABULEIRO];
+    int navios_coluna[TAMANHO_TABULEIRO];
+    int efeito_linha[TAMANHO_TABULEIRO];
+    int efeito_coluna[TAMANHO_TABULEIRO];
+} EstatisticasTabuleiro;
+
+// Função para zerar as estatísticas de um tabuleiro só com água
+void inicializarEstatisticas(EstatisticasTabuleiro* estatisticas) {
+    memset(estatisticas, 0, sizeof(*estatisticas));
+    estatisticas->agua = TAMANHO_TABULEIRO * TAMANHO_TABULEIRO;
+}
+
+// Função para registrar a troca do valor de uma célula (de 'antigo' para 'novo')
+static inline void contabilizarCelula(EstatisticasTabuleiro* estatisticas, int linha, int coluna,
+                                      int antigo, int novo) {
+    if (antigo == novo) {
+        return;
+    }
+    
+    switch (antigo) {
+        case AGUA: estatisticas->agua--; break;
+        case NAVIO:
+            estatisticas->navios--;
+            estatisticas->navios_linha[linha]--;
+            estatisticas->navios_coluna[coluna]--;
+            break;
+        case AREA_EFEITO:
+            estatisticas->efeito--;
+            estatisticas->efeito_linha[linha]--;
+            estatisticas->efeito_coluna[coluna]--;
+            break;
+    }
+    switch (novo) {
+        case AGUA: estatisticas->agua++; break;
+        case NAVIO:
+            estatisticas->navios++;
+            estatisticas->navios_linha[linha]++;
+            estatisticas->navios_coluna[coluna]++;
+            break;
+        case AREA_EFEITO:
+            estatisticas->efeito++;
+            estatisticas->efeito_linha[linha]++;
+            estatisticas->efeito_coluna[coluna]++;
+            break;
+    }
+}
+
+// Registro de desfazer de uma escrita no tabuleiro (um navio ou uma habilidade): cada célula visitada
+// com o valor que tinha antes. Células com navio que a habilidade preservou também são registradas,
+// com anterior == NAVIO; como nenhuma escrita sobrepõe um navio, esse valor basta para distingui-las.
+#define MAX_CELULAS_ALTERACAO (TAMANHO_HABILIDADE * TAMANHO_HABILIDADE)
+
+typedef struct {
+    uint8_t indice;       // linha * TAMANHO_TABULEIRO + coluna
+    uint8_t anterior;
+} CelulaAlterada;
+
+typedef struct {
+    uint8_t valor_novo;   // NAVIO ou AREA_EFEITO
+    uint8_t num_celulas;
+    CelulaAlterada celulas[MAX_CELULAS_ALTERACAO];
+} AlteracaoTabuleiro;
+
+// Histórico de alterações para desfazer e refazer em sequência (busca em árvore, editor)
+typedef struct {
+    AlteracaoTabuleiro* alteracoes;
+    int capacidade;
+    int atual;            // Alterações aplicadas
+    int total;            // Aplicadas + desfeitas que ainda podem ser refeitas
+} HistoricoAlteracoes;
+
+// Função para anotar uma célula visitada no registro (registro pode ser NULL)
+static inline void anotarCelulaAlterada(AlteracaoTabuleiro* alteracao, int linha, int coluna, int anterior) {
+    if (alteracao != NULL) {
+        CelulaAlterada* celula = &alteracao->celulas[alteracao->num_celulas++];
+        celula->indice = (uint8_t) (linha * TAMANHO_TABULEIRO + coluna);
+        celula->anterior = (uint8_t) anterior;
+    }
+}
+
+// Função para desfazer uma alteração, em O(células alteradas) (estatisticas pode ser NULL)
+void desfazerAlteracao(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], const AlteracaoTabuleiro* alteracao,
+                       EstatisticasTabuleiro* estatisticas) {
+    for (int i = alteracao->num_celulas - 1; i >= 0; i--) {
+        int linha = alteracao->celulas[i].indice / TAMANHO_TABULEIRO;
+        int coluna = alteracao->celulas[i].indice % TAMANHO_TABULEIRO;
+        if (estatisticas != NULL) {
+            contabilizarCelula(estatisticas, linha, coluna, tabuleiro[linha][coluna], alteracao->celulas[i].anterior);
+        }
+        tabuleiro[linha][coluna] = alteracao->celulas[i].anterior;
+    }
+}
+
+// Função para refazer uma alteração desfeita; células de navio preservadas continuam intactas
+void refazerAlteracao(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], const AlteracaoTabuleiro* alteracao,
+                      EstatisticasTabuleiro* estatisticas) {
+    for (int i = 0; i < alteracao->num_celulas; i++) {
+        if (alteracao->celulas[i].anterior == NAVIO) {
+            continue;
+        }
+        int linha = alteracao->celulas[i].indice / TAMANHO_TABULEIRO;
+        int coluna = alteracao->celulas[i].indice % TAMANHO_TABULEIRO;
+        if (estatisticas != NULL) {
+            contabilizarCelula(estatisticas, linha, coluna, tabuleiro[linha][coluna], alteracao->valor_novo);
+        }
+        tabuleiro[linha][coluna] = alteracao->valor_novo;
+    }
+}
+
+// Função para criar um histórico com espaço para 'capacidade' alterações
+bool criarHistoricoAlteracoes(HistoricoAlteracoes* historico, int capacidade) {
+    historico->alteracoes = alocarMemoria(sizeof(AlteracaoTabuleiro) * (size_t) capacidade);
+    historico->capacidade = historico->alteracoes != NULL ? capacidade : 0;
+    historico->atual = 0;
+    historico->total = 0;
+    return historico->alteracoes != NULL;
+}
+
+void destruirHistoricoAlteracoes(HistoricoAlteracoes* historico) {
+    free(historico->alteracoes);
+    historico->alteracoes = NULL;
+    historico->capacidade = 0;
+    historico->atual = 0;
+    historico->total = 0;
+}
+
+// Função para reservar o registro da próxima alteração; descarta o que poderia ser refeito.
+// Devolve NULL se o histórico encheu (a alteração pode ser feita mesmo assim, sem registro).
+AlteracaoTabuleiro* proximaAlteracaoHistorico(HistoricoAlteracoes* historico) {
+    if (historico->atual == historico->capacidade) {
+        return NULL;
+    }
+    historico->total = historico->atual + 1;
+    return &historico->alteracoes[historico->atual++];
+}
+
+// Função para descartar o registro reservado quando a escrita foi rejeitada
+void cancelarAlteracaoHistorico(HistoricoAlteracoes* historico) {
+    if (historico->atual > 0) {
+        historico->total = --historico->atual;
+    }
+}
+
+// Função para desfazer a última alteração aplicada (false se não há nada a desfazer)
+bool desfazerHistorico(HistoricoAlteracoes* historico, int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO],
+                       EstatisticasTabuleiro* estatisticas) {
+    if (historico->atual == 0) {
+        return false;
+    }
+    desfazerAlteracao(tabuleiro, &historico->alteracoes[--historico->atual], estatisticas);
+    return true;
+}
+
+// Função para refazer a última alteração desfeita (false se não há nada a refazer)
+bool refazerHistorico(HistoricoAlteracoes* historico, int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO],
+                      EstatisticasTabuleiro* estatisticas) {
+    if (historico->atual == historico->total) {
+        return false;
+    }
+    refazerAlteracao(tabuleiro, &historico->alteracoes[historico->atual++], estatisticas);
+    return true;
+}
+
 // Função para obter caractere visual baseado no valor
 char obterCaractereVisual(int valor) {
     switch (valor) {
@@ -108,67 +639,69 @@ char obterCaractereVisual(int valor) {
     }
 }
 
-// Função para exibir o tabuleiro com caracteres visuais
-void exibirTabuleiro(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO]) {
-    printf("=== TABULEIRO DE BATALHA NAVAL ===\n");
-    printf("Legenda: ~ = Água, # = Navio, * = Área de Efeito\n\n");
-    
+// Buffer reaproveitado entre as exibições de tabuleiro
+static BufferSaida bufferExibicao;
+
+// Função para montar o cabeçalho de colunas e a linha separadora
+static void formatarCabecalhoTabuleiro(BufferSaida* buffer) {
     // Cabeçalho com números das colunas
-    printf("   ");
+    anexarBufferSaida(buffer, "   ", 3);
     for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
-        printf("%2d ", j);
+        formatarBufferSaida(buffer, "%2d ", j);
     }
-    printf("\n");
+    anexarBufferSaida(buffer, "\n", 1);
     
     // Linha separadora
-    printf("   ");
+    anexarBufferSaida(buffer, "   ", 3);
     for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
-        printf("---");
+        anexarBufferSaida(buffer, "---", 3);
     }
-    printf("\n");
+    anexarBufferSaida(buffer, "\n", 1);
+}
+
+// Função para exibir o tabuleiro com caracteres visuais
+void exibirTabuleiro(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO]) {
+    BufferSaida* buffer = &bufferExibicao;
+    
+    formatarBufferSaida(buffer, "=== TABULEIRO DE BATALHA NAVAL ===\n");
+    formatarBufferSaida(buffer, "Legenda: ~ = Água, # = Navio, * = Área de Efeito\n\n");
+    formatarCabecalhoTabuleiro(buffer);
     
     // Exibe cada linha do tabuleiro
     for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
-        printf("%2d|", i);
+        formatarBufferSaida(buffer, "%2d|", i);
         
         for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
-            char caractere = obterCaractereVisual(tabuleiro[i][j]);
-            printf(" %c ", caractere);
+            char celula[3] = {' ', obterCaractereVisual(tabuleiro[i][j]), ' '};
+            anexarBufferSaida(buffer, celula, sizeof(celula));
         }
-        printf("\n");
+        anexarBufferSaida(buffer, "\n", 1);
     }
-    printf("\n");
+    anexarBufferSaida(buffer, "\n", 1);
+    
+    descarregarBufferSaida(buffer);
 }
 
 // Função para exibir tabuleiro com valores numéricos
 void exibirTabuleiroNumerico(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO]) {
-    printf("=== TABULEIRO NUMÉRICO ===\n");
-    printf("Valores: 0 = Água, 3 = Navio, 5 = Área de Efeito\n\n");
-    
-    // Cabeçalho com números das colunas
-    printf("   ");
-    for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
-        printf("%2d ", j);
-    }
-    printf("\n");
+    BufferSaida* buffer = &bufferExibicao;
     
-    // Linha separadora
-    printf("   ");
-    for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
-        printf("---");
-    }
-    printf("\n");
+    formatarBufferSaida(buffer, "=== TABULEIRO NUMÉRICO ===\n");
+    formatarBufferSaida(buffer, "Valores: 0 = Água, 3 = Navio, 5 = Área de Efeito\n\n");
+    formatarCabecalhoTabuleiro(buffer);
     
     // Exibe cada linha do tabuleiro
     for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
-        printf("%2d|", i);
+        formatarBufferSaida(buffer, "%2d|", i);
         
         for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
-            printf("%2d ", tabuleiro[i][j]);
+            formatarBufferSaida(buffer, "%2d ", tabuleiro[i][j]);
         }
-        printf("\n");
+        anexarBufferSaida(buffer, "\n", 1);
     }
-    printf("\n");
+    anexarBufferSaida(buffer, "\n", 1);
+    
+    descarregarBufferSaida(buffer);
 }
 
 // =====================================================================
@@ -186,26 +719,44 @@ const char* obterNomeOrientacao(OrientacaoNavio orientacao) {
     }
 }
 
-// Função para validar se a posição está dentro dos limites
-bool posicaoValida(int linha, int coluna, int tamanho, OrientacaoNavio orientacao) {
-    if (linha < 0 || linha >= TAMANHO_TABULEIRO || coluna < 0 || coluna >= TAMANHO_TABULEIRO) {
+// Função para verificar se uma célula está dentro de um tabuleiro de dimensões quaisquer
+bool celulaDentroDosLimites(int linha, int coluna, int linhas, int colunas) {
+    return linha >= 0 && linha < linhas && coluna >= 0 && coluna < colunas;
+}
+
+// Função para verificar se uma área de raio 'raio' centrada na origem alcança o tabuleiro.
+// Origens mais distantes não tocam nenhuma célula e são descartadas antes de somar os
+// deslocamentos do padrão, o que também evita estourar o int.
+bool origemAlcancaTabuleiro(int linha, int coluna, int raio, int linhas, int colunas) {
+    return linha >= -raio && linha - raio < linhas && coluna >= -raio && coluna - raio < colunas;
+}
+
+// Função para validar se a posição está dentro dos limites de um tabuleiro linhas x colunas
+bool posicaoValidaDimensoes(int linha, int coluna, int tamanho, OrientacaoNavio orientacao,
+                            int linhas, int colunas) {
+    if (!celulaDentroDosLimites(linha, coluna, linhas, colunas)) {
         return false;
     }
     
     switch (orientacao) {
         case HORIZONTAL:
-            return (coluna + tamanho <= TAMANHO_TABULEIRO);
+            return (coluna + tamanho <= colunas);
         case VERTICAL:
-            return (linha + tamanho <= TAMANHO_TABULEIRO);
+            return (linha + tamanho <= linhas);
         case DIAGONAL_PRINCIPAL:
-            return (linha + tamanho <= TAMANHO_TABULEIRO && coluna + tamanho <= TAMANHO_TABULEIRO);
+            return (linha + tamanho <= linhas && coluna + tamanho <= colunas);
         case DIAGONAL_SECUNDARIA:
-            return (linha + tamanho <= TAMANHO_TABULEIRO && coluna - tamanho + 1 >= 0);
+            return (linha + tamanho <= linhas && coluna - tamanho + 1 >= 0);
         default:
             return false;
     }
 }
 
+// Função para validar se a posição está dentro dos limites
+bool posicaoValida(int linha, int coluna, int tamanho, OrientacaoNavio orientacao) {
+    return posicaoValidaDimensoes(linha, coluna, tamanho, orientacao, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO);
+}
+
 // Função para calcular posição do navio baseada na orientação
 void calcularPosicaoNavio(int linha_inicial, int coluna_inicial, OrientacaoNavio orientacao, 
                          int indice, int* linha_resultado, int* coluna_resultado) {
@@ -226,6 +777,11 @@ void calcularPosicaoNavio(int linha_inicial, int coluna_inicial, OrientacaoNavio
             *linha_resultado = linha_inicial + indice;
             *coluna_resultado = coluna_inicial - indice;
             break;
+        default:
+            // Orientação inválida: as saídas nunca ficam sem valor
+            *linha_resultado = 0;
+            *coluna_resultado = 0;
+            break;
     }
 }
 
@@ -243,41 +799,67 @@ bool verificarSobreposicao(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO],
     return false;
 }
 
-// Função para posicionar um navio no tabuleiro
-bool posicionarNavio(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], Navio navio) {
-    printf("Posicionando %s na posição (%d,%d) - %s\n", 
-           navio.nome, navio.linha, navio.coluna, obterNomeOrientacao(navio.orientacao));
-    
+// Função para posicionar um navio sem mensagens, informando o motivo da falha.
+// estatisticas e alteracao podem ser NULL; alteracao recebe o registro para desfazer.
+ResultadoPosicionamento tentarPosicionarNavio(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], Navio navio,
+                                              EstatisticasTabuleiro* estatisticas, AlteracaoTabuleiro* alteracao) {
     if (!posicaoValida(navio.linha, navio.coluna, TAMANHO_NAVIO, navio.orientacao)) {
-        printf("ERRO: Posição inválida para %s!\n", navio.nome);
-        return false;
+        INSTRUMENTAR_CONTAR(CONTADOR_REJEICOES_POSICAO, 1);
+        return POSICIONAMENTO_INVALIDO;
     }
     
     if (verificarSobreposicao(tabuleiro, navio.linha, navio.coluna, TAMANHO_NAVIO, navio.orientacao)) {
-        printf("ERRO: %s se sobrepõe a outro navio!\n", navio.nome);
-        return false;
+        INSTRUMENTAR_CONTAR(CONTADOR_REJEICOES_SOBREPOSICAO, 1);
+        return POSICIONAMENTO_SOBREPOSTO;
     }
     
+    if (alteracao != NULL) {
+        alteracao->valor_novo = NAVIO;
+        alteracao->num_celulas = 0;
+    }
     for (int i = 0; i < TAMANHO_NAVIO; i++) {
         int linha_atual, coluna_atual;
         calcularPosicaoNavio(navio.linha, navio.coluna, navio.orientacao, i, &linha_atual, &coluna_atual);
+        anotarCelulaAlterada(alteracao, linha_atual, coluna_atual, tabuleiro[linha_atual][coluna_atual]);
+        if (estatisticas != NULL) {
+            contabilizarCelula(estatisticas, linha_atual, coluna_atual, tabuleiro[linha_atual][coluna_atual], NAVIO);
+        }
         tabuleiro[linha_atual][coluna_atual] = NAVIO;
     }
     
-    printf("%s posicionado com sucesso!\n\n", navio.nome);
-    return true;
+    INSTRUMENTAR_CONTAR(CONTADOR_NAVIOS_POSICIONADOS, 1);
+    return POSICIONAMENTO_OK;
+}
+
+// Função para posicionar um navio no tabuleiro (estatisticas e alteracao podem ser NULL)
+bool posicionarNavio(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], Navio navio,
+                     EstatisticasTabuleiro* estatisticas, AlteracaoTabuleiro* alteracao) {
+    printf("Posicionando %s na posição (%d,%d) - %s\n", 
+           navio.nome, navio.linha, navio.coluna, obterNomeOrientacao(navio.orientacao));
+    
+    switch (tentarPosicionarNavio(tabuleiro, navio, estatisticas, alteracao)) {
+        case POSICIONAMENTO_INVALIDO:
+            printf("ERRO: Posição inválida para %s!\n", navio.nome);
+            return false;
+        case POSICIONAMENTO_SOBREPOSTO:
+            printf("ERRO: %s se sobrepõe a outro navio!\n", navio.nome);
+            return false;
+        default:
+            printf("%s posicionado com sucesso!\n\n", navio.nome);
+            return true;
+    }
 }
 
 // =====================================================================
 // FUNÇÕES DE HABILIDADES ESPECIAIS (NÍVEL MESTRE)
 // =====================================================================
 
-// Função para criar a matriz de habilidade em formato de CONE
-void criarHabilidadeCone(HabilidadeEspecial* habilidade) {
+// Função para gerar o padrão de habilidade em formato de CONE
+static void gerarPadraoCone(int matriz[TAMANHO_HABILIDADE][TAMANHO_HABILIDADE]) {
     // Inicializa toda a matriz com 0
     for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
         for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
-            habilidade->matriz[i][j] = 0;
+            matriz[i][j] = 0;
         }
     }
     
@@ -288,18 +870,18 @@ void criarHabilidadeCone(HabilidadeEspecial* habilidade) {
         for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
             int distancia_horizontal = abs(j - centro);
             if (distancia_horizontal <= i && i <= centro + 2) {
-                habilidade->matriz[i][j] = 1;
+                matriz[i][j] = 1;
             }
         }
     }
 }
 
-// Função para criar a matriz de habilidade em formato de CRUZ
-void criarHabilidadeCruz(HabilidadeEspecial* habilidade) {
+// Função para gerar o padrão de habilidade em formato de CRUZ
+static void gerarPadraoCruz(int matriz[TAMANHO_HABILIDADE][TAMANHO_HABILIDADE]) {
     // Inicializa toda a matriz com 0
     for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
         for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
-            habilidade->matriz[i][j] = 0;
+            matriz[i][j] = 0;
         }
     }
     
@@ -309,18 +891,18 @@ void criarHabilidadeCruz(HabilidadeEspecial* habilidade) {
     for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
         for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
             if (i == centro || j == centro) {
-                habilidade->matriz[i][j] = 1;
+                matriz[i][j] = 1;
             }
         }
     }
 }
 
-// Função para criar a matriz de habilidade em formato de OCTAEDRO
-void criarHabilidadeOctaedro(HabilidadeEspecial* habilidade) {
+// Função para gerar o padrão de habilidade em formato de OCTAEDRO
+static void gerarPadraoOctaedro(int matriz[TAMANHO_HABILIDADE][TAMANHO_HABILIDADE]) {
     // Inicializa toda a matriz com 0
     for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
         for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
-            habilidade->matriz[i][j] = 0;
+            matriz[i][j] = 0;
         }
     }
     
@@ -333,56 +915,6965 @@ void criarHabilidadeOctaedro(HabilidadeEspecial* habilidade) {
             int distancia_coluna = abs(j - centro);
             
             if (distancia_linha + distancia_coluna <= centro) {
-                habilidade->matriz[i][j] = 1;
+                matriz[i][j] = 1;
             }
         }
     }
 }
 
-// Função para exibir a matriz de uma habilidade
-void exibirMatrizHabilidade(HabilidadeEspecial* habilidade) {
-    printf("\n=== MATRIZ DA HABILIDADE %s ===\n", habilidade->nome);
+// Estrutura de uma faixa contínua de células afetadas em uma linha da habilidade,
+// com deslocamentos relativos ao centro
+typedef struct {
+    signed char deslocamento_linha;
+    signed char coluna_inicio;
+    signed char coluna_fim;
+} FaixaEstencil;
+
+// No máximo (TAMANHO_HABILIDADE + 1) / 2 faixas disjuntas cabem em uma linha
+#define MAX_FAIXAS_ESTENCIL (TAMANHO_HABILIDADE * ((TAMANHO_HABILIDADE + 1) / 2))
+
+// Estêncil pré-compilado: só as faixas que realmente são afetadas, ordenadas por linha
+typedef struct {
+    int num_faixas;
+    int num_celulas;
+    FaixaEstencil faixas[MAX_FAIXAS_ESTENCIL];
+} EstencilHabilidade;
+
+// Padrões e estênceis gerados uma única vez, na primeira utilização
+static int matrizesHabilidade[3][TAMANHO_HABILIDADE][TAMANHO_HABILIDADE];
+static EstencilHabilidade estenceisHabilidade[3];
+static pthread_once_t estenceisUnicos = PTHREAD_ONCE_INIT;
+
+// Função para compilar uma matriz de habilidade em faixas por linha
+void compilarEstencil(int matriz[TAMANHO_HABILIDADE][TAMANHO_HABILIDADE], EstencilHabilidade* estencil) {
+    int centro = TAMANHO_HABILIDADE / 2;
     
+    estencil->num_faixas = 0;
+    estencil->num_celulas = 0;
     for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
-        for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
-            printf("%d ", habilidade->matriz[i][j]);
+        int j = 0;
+        while (j < TAMANHO_HABILIDADE) {
+            if (matriz[i][j] != 1) {
+                j++;
+                continue;
+            }
+            
+            int inicio = j;
+            while (j < TAMANHO_HABILIDADE && matriz[i][j] == 1) {
+                j++;
+            }
+            
+            FaixaEstencil* faixa = &estencil->faixas[estencil->num_faixas++];
+            faixa->deslocamento_linha = (signed char) (i - centro);
+            faixa->coluna_inicio = (signed char) (inicio - centro);
+            faixa->coluna_fim = (signed char) (j - 1 - centro);
+            estencil->num_celulas += j - inicio;
         }
-        printf("\n");
     }
-    printf("\n");
 }
 
-// Função para aplicar habilidade ao tabuleiro
-void aplicarHabilidade(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], HabilidadeEspecial* habilidade) {
-    printf("Aplicando habilidade %s na posição (%d,%d)...\n", 
-           habilidade->nome, habilidade->linha_origem, habilidade->coluna_origem);
-    
-    int centro_habilidade = TAMANHO_HABILIDADE / 2;
+// Função para gerar os padrões e estênceis das habilidades
+static void montarEstenceis(void) {
+    gerarPadraoCone(matrizesHabilidade[CONE]);
+    gerarPadraoCruz(matrizesHabilidade[CRUZ]);
+    gerarPadraoOctaedro(matrizesHabilidade[OCTAEDRO]);
     
-    // Percorre toda a matriz de habilidade usando loops aninhados
-    for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
-        for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
-            // Condicional para verificar se a posição está na área de efeito
-            if (habilidade->matriz[i][j] == 1) {
-                int linha_tabuleiro = habilidade->linha_origem + (i - centro_habilidade);
-                int coluna_tabuleiro = habilidade->coluna_origem + (j - centro_habilidade);
-                
-                // Condicional para verificar limites do tabuleiro
-                if (linha_tabuleiro >= 0 && linha_tabuleiro < TAMANHO_TABULEIRO &&
-                    coluna_tabuleiro >= 0 && coluna_tabuleiro < TAMANHO_TABULEIRO) {
-                    
-                    // Condicional para não sobrescrever navios
-                    if (tabuleiro[linha_tabuleiro][coluna_tabuleiro] != NAVIO) {
-                        tabuleiro[linha_tabuleiro][coluna_tabuleiro] = AREA_EFEITO;
-                    }
+    for (int tipo = CONE; tipo <= OCTAEDRO; tipo++) {
+        compilarEstencil(matrizesHabilidade[tipo], &estenceisHabilidade[tipo]);
+    }
+}
+
+// Função para garantir que os estênceis existam (gerados uma única vez, mesmo com várias threads)
+void inicializarEstenceis() {
+    pthread_once(&estenceisUnicos, montarEstenceis);
+}
+
+// Função para obter o estêncil pré-compilado de um tipo de habilidade
+const EstencilHabilidade* obterEstencil(TipoHabilidade tipo) {
+    inicializarEstenceis();
+    return &estenceisHabilidade[tipo];
+}
+
+// Função para criar a matriz de habilidade em formato de CONE
+void criarHabilidadeCone(HabilidadeEspecial* habilidade) {
+    inicializarEstenceis();
+    memcpy(habilidade->matriz, matrizesHabilidade[CONE], sizeof(habilidade->matriz));
+}
+
+// Função para criar a matriz de habilidade em formato de CRUZ
+void criarHabilidadeCruz(HabilidadeEspecial* habilidade) {
+    inicializarEstenceis();
+    memcpy(habilidade->matriz, matrizesHabilidade[CRUZ], sizeof(habilidade->matriz));
+}
+
+// Função para criar a matriz de habilidade em formato de OCTAEDRO
+void criarHabilidadeOctaedro(HabilidadeEspecial* habilidade) {
+    inicializarEstenceis();
+    memcpy(habilidade->matriz, matrizesHabilidade[OCTAEDRO], sizeof(habilidade->matriz));
+}
+
+// Função para exibir a matriz de uma habilidade
+void exibirMatrizHabilidade(HabilidadeEspecial* habilidade) {
+    printf("\n=== MATRIZ DA HABILIDADE %s ===\n", habilidade->nome);
+    
+    for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
+        for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
+            printf("%d ", habilidade->matriz[i][j]);
+        }
+        printf("\n");
+    }
+    printf("\n");
+}
+
+// Função para marcar a área de uma habilidade sem mensagens; navios nunca são sobrescritos.
+// estatisticas e alteracao podem ser NULL; alteracao recebe o registro para desfazer.
+void marcarAreaHabilidade(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], const HabilidadeEspecial* habilidade,
+                          EstatisticasTabuleiro* estatisticas, AlteracaoTabuleiro* alteracao) {
+    if (alteracao != NULL) {
+        alteracao->valor_novo = AREA_EFEITO;
+        alteracao->num_celulas = 0;
+    }
+    
+    const EstencilHabilidade* estencil = obterEstencil(habilidade->tipo);
+    int celulas_visitadas = 0, celulas_escritas = 0;
+    
+    // Percorre apenas as faixas afetadas, recortando cada uma nas bordas do tabuleiro;
+    // de uma origem que não alcança o tabuleiro nenhuma faixa é percorrida
+    int num_faixas = origemAlcancaTabuleiro(habilidade->linha_origem, habilidade->coluna_origem, TAMANHO_HABILIDADE / 2,
+                                            TAMANHO_TABULEIRO, TAMANHO_TABULEIRO) ? estencil->num_faixas : 0;
+    for (int f = 0; f < num_faixas; f++) {
+        const FaixaEstencil* faixa = &estencil->faixas[f];
+        int linha_tabuleiro = habilidade->linha_origem + faixa->deslocamento_linha;
+        
+        // Condicional para verificar limites do tabuleiro (linha inteira de uma vez)
+        if (linha_tabuleiro < 0 || linha_tabuleiro >= TAMANHO_TABULEIRO) {
+            continue;
+        }
+        
+        int coluna_inicio = habilidade->coluna_origem + faixa->coluna_inicio;
+        int coluna_fim = habilidade->coluna_origem + faixa->coluna_fim;
+        if (coluna_inicio < 0) {
+            coluna_inicio = 0;
+        }
+        if (coluna_fim > TAMANHO_TABULEIRO - 1) {
+            coluna_fim = TAMANHO_TABULEIRO - 1;
+        }
+        
+        int* linha = tabuleiro[linha_tabuleiro];
+        for (int coluna = coluna_inicio; coluna <= coluna_fim; coluna++) {
+            anotarCelulaAlterada(alteracao, linha_tabuleiro, coluna, linha[coluna]);
+            
+            // Condicional para não sobrescrever navios
+            if (linha[coluna] != NAVIO) {
+                if (estatisticas != NULL) {
+                    contabilizarCelula(estatisticas, linha_tabuleiro, coluna, linha[coluna], AREA_EFEITO);
                 }
+                linha[coluna] = AREA_EFEITO;
+                celulas_escritas++;
             }
         }
+        celulas_visitadas += coluna_fim >= coluna_inicio ? coluna_fim - coluna_inicio + 1 : 0;
     }
     
+    INSTRUMENTAR_CONTAR(CONTADOR_HABILIDADES_APLICADAS, 1);
+    INSTRUMENTAR_CONTAR(CONTADOR_CELULAS_ESCRITAS, celulas_escritas);
+    INSTRUMENTAR_CONTAR(CONTADOR_CELULAS_NAVIO_PRESERVADO, celulas_visitadas - celulas_escritas);
+    INSTRUMENTAR_CONTAR(CONTADOR_CELULAS_FORA_LIMITES, estencil->num_celulas - celulas_visitadas);
+}
+
+// Função para aplicar habilidade ao tabuleiro (estatisticas e alteracao podem ser NULL)
+void aplicarHabilidade(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], HabilidadeEspecial* habilidade,
+                       EstatisticasTabuleiro* estatisticas, AlteracaoTabuleiro* alteracao) {
+    printf("Aplicando habilidade %s na posição (%d,%d)...\n", 
+           habilidade->nome, habilidade->linha_origem, habilidade->coluna_origem);
+    marcarAreaHabilidade(tabuleiro, habilidade, estatisticas, alteracao);
     printf("Habilidade %s aplicada com sucesso!\n\n", habilidade->nome);
 }
 
+// =====================================================================
+// MOTOR DE TABULEIRO EM BITS (BITBOARD DE 128 BITS)
+// =====================================================================
+
+#if TAMANHO_TABULEIRO * TAMANHO_TABULEIRO > 128
+#error "O motor em bits exige TAMANHO_TABULEIRO * TAMANHO_TABULEIRO <= 128"
+#endif
+
+#define TOTAL_CELULAS (TAMANHO_TABULEIRO * TAMANHO_TABULEIRO)
+
+// Máscara de 128 bits: a célula (linha, coluna) ocupa o bit linha * TAMANHO_TABULEIRO + coluna
+typedef struct {
+    uint64_t baixo;  // Bits 0..63
+    uint64_t alto;   // Bits 64..127
+} Mascara128;
+
+// Tabuleiro em bits: uma camada para navios e outra para área de efeito.
+// A água é tudo o que não está em nenhuma das duas camadas.
+typedef struct {
+    Mascara128 navios;
+    Mascara128 efeito;
+} TabuleiroBits;
+
+// Tabelas pré-calculadas de máscaras por (orientação, célula inicial) e por (tipo, célula de origem)
+static Mascara128 mascarasNavio[4][TOTAL_CELULAS];
+static bool navioCabeBits[4][TOTAL_CELULAS];
+static Mascara128 mascarasHabilidade[3][TOTAL_CELULAS];
+static Mascara128 mascarasLinha[TAMANHO_TABULEIRO];
+static Mascara128 mascarasColuna[TAMANHO_TABULEIRO];
+static pthread_once_t tabelasBitsUnicas = PTHREAD_ONCE_INIT;
+
+static inline Mascara128 mascaraVazia(void) {
+    Mascara128 m = {0, 0};
+    return m;
+}
+
+static inline Mascara128 mascaraOu(Mascara128 a, Mascara128 b) {
+    Mascara128 m = {a.baixo | b.baixo, a.alto | b.alto};
+    return m;
+}
+
+static inline Mascara128 mascaraE(Mascara128 a, Mascara128 b) {
+    Mascara128 m = {a.baixo & b.baixo, a.alto & b.alto};
+    return m;
+}
+
+// Retorna a & ~b
+static inline Mascara128 mascaraENao(Mascara128 a, Mascara128 b) {
+    Mascara128 m = {a.baixo & ~b.baixo, a.alto & ~b.alto};
+    return m;
+}
+
+static inline bool mascaraEhVazia(Mascara128 m) {
+    return (m.baixo | m.alto) == 0;
+}
+
+static inline bool mascaraSeCruzam(Mascara128 a, Mascara128 b) {
+    return ((a.baixo & b.baixo) | (a.alto & b.alto)) != 0;
+}
+
+static inline int mascaraContar(Mascara128 m) {
+    return __builtin_popcountll(m.baixo) + __builtin_popcountll(m.alto);
+}
+
+static inline Mascara128 mascaraDaCelula(int indice) {
+    Mascara128 m = {0, 0};
+    if (indice < 64) {
+        m.baixo = 1ULL << indice;
+    } else {
+        m.alto = 1ULL << (indice - 64);
+    }
+    return m;
+}
+
+static inline bool mascaraTestarCelula(Mascara128 m, int indice) {
+    return indice < 64 ? (m.baixo >> indice) & 1 : (m.alto >> (indice - 64)) & 1;
+}
+
+// Função para preencher a matriz de uma habilidade de acordo com o tipo
+void criarHabilidadePorTipo(HabilidadeEspecial* habilidade, TipoHabilidade tipo) {
+    switch (tipo) {
+        case CONE: criarHabilidadeCone(habilidade); break;
+        case CRUZ: criarHabilidadeCruz(habilidade); break;
+        case OCTAEDRO: criarHabilidadeOctaedro(habilidade); break;
+        default: memset(habilidade->matriz, 0, sizeof(habilidade->matriz)); break;    // Tipo desconhecido: não afeta nada
+    }
+}
+
+// Função para construir a máscara de uma habilidade a partir do seu estêncil (com recorte nas bordas)
+Mascara128 construirMascaraHabilidade(TipoHabilidade tipo, int linha_origem, int coluna_origem) {
+    const EstencilHabilidade* estencil = obterEstencil(tipo);
+    Mascara128 mascara = mascaraVazia();
+    
+    if (!origemAlcancaTabuleiro(linha_origem, coluna_origem, TAMANHO_HABILIDADE / 2, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return mascara;
+    }
+    
+    for (int f = 0; f < estencil->num_faixas; f++) {
+        const FaixaEstencil* faixa = &estencil->faixas[f];
+        int linha = linha_origem + faixa->deslocamento_linha;
+        
+        for (int coluna = coluna_origem + faixa->coluna_inicio; coluna <= coluna_origem + faixa->coluna_fim; coluna++) {
+            if (celulaDentroDosLimites(linha, coluna, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+                mascara = mascaraOu(mascara, mascaraDaCelula(linha * TAMANHO_TABULEIRO + coluna));
+            }
+        }
+    }
+    return mascara;
+}
+
+// Função para pré-calcular as máscaras de navios e habilidades
+static void montarTabelasBits(void) {
+    // Máscaras de navio por orientação e célula inicial
+    for (int orientacao = HORIZONTAL; orientacao <= DIAGONAL_SECUNDARIA; orientacao++) {
+        for (int indice = 0; indice < TOTAL_CELULAS; indice++) {
+            int linha = indice / TAMANHO_TABULEIRO;
+            int coluna = indice % TAMANHO_TABULEIRO;
+            
+            mascarasNavio[orientacao][indice] = mascaraVazia();
+            navioCabeBits[orientacao][indice] = posicaoValida(linha, coluna, TAMANHO_NAVIO, orientacao);
+            if (!navioCabeBits[orientacao][indice]) {
+                continue;
+            }
+            
+            for (int i = 0; i < TAMANHO_NAVIO; i++) {
+                int linha_atual, coluna_atual;
+                calcularPosicaoNavio(linha, coluna, orientacao, i, &linha_atual, &coluna_atual);
+                mascarasNavio[orientacao][indice] = mascaraOu(mascarasNavio[orientacao][indice],
+                    mascaraDaCelula(linha_atual * TAMANHO_TABULEIRO + coluna_atual));
+            }
+        }
+    }
+    
+    // Máscaras de habilidade por tipo e célula de origem
+    for (int tipo = CONE; tipo <= OCTAEDRO; tipo++) {
+        for (int indice = 0; indice < TOTAL_CELULAS; indice++) {
+            mascarasHabilidade[tipo][indice] = construirMascaraHabilidade(tipo, indice / TAMANHO_TABULEIRO,
+                                                                          indice % TAMANHO_TABULEIRO);
+        }
+    }
+    
+    // Máscaras de cada linha e de cada coluna, para contagens parciais por popcount
+    for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
+        mascarasLinha[i] = mascaraVazia();
+        mascarasColuna[i] = mascaraVazia();
+        for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+            mascarasLinha[i] = mascaraOu(mascarasLinha[i], mascaraDaCelula(i * TAMANHO_TABULEIRO + j));
+            mascarasColuna[i] = mascaraOu(mascarasColuna[i], mascaraDaCelula(j * TAMANHO_TABULEIRO + i));
+        }
+    }
+}
+
+// Função para garantir que as tabelas de bits existam (montadas uma única vez, mesmo com várias threads)
+void inicializarTabelasBits() {
+    pthread_once(&tabelasBitsUnicas, montarTabelasBits);
+}
+
+// Função para inicializar o tabuleiro em bits com água
+void inicializarTabuleiroBits(TabuleiroBits* tabuleiro) {
+    inicializarTabelasBits();
+    tabuleiro->navios = mascaraVazia();
+    tabuleiro->efeito = mascaraVazia();
+}
+
+// Função para obter a máscara de um navio (vazia se a posição for inválida)
+Mascara128 obterMascaraNavio(int linha, int coluna, OrientacaoNavio orientacao) {
+    if (linha < 0 || linha >= TAMANHO_TABULEIRO || coluna < 0 || coluna >= TAMANHO_TABULEIRO ||
+        orientacao < HORIZONTAL || orientacao > DIAGONAL_SECUNDARIA) {
+        return mascaraVazia();
+    }
+    return mascarasNavio[orientacao][linha * TAMANHO_TABULEIRO + coluna];
+}
+
+// Função para verificar sobreposição de navios com uma única operação AND
+bool verificarSobreposicaoBits(const TabuleiroBits* tabuleiro, int linha, int coluna, OrientacaoNavio orientacao) {
+    return mascaraSeCruzam(tabuleiro->navios, obterMascaraNavio(linha, coluna, orientacao));
+}
+
+// Função para tentar posicionar um navio no tabuleiro em bits, informando o motivo da falha
+ResultadoPosicionamento tentarPosicionarNavioBits(TabuleiroBits* tabuleiro, int linha, int coluna,
+                                                  OrientacaoNavio orientacao) {
+    if (!posicaoValida(linha, coluna, TAMANHO_NAVIO, orientacao)) {
+        return POSICIONAMENTO_INVALIDO;
+    }
+    
+    Mascara128 mascara = mascarasNavio[orientacao][linha * TAMANHO_TABULEIRO + coluna];
+    if (mascaraSeCruzam(tabuleiro->navios, mascara)) {
+        return POSICIONAMENTO_SOBREPOSTO;
+    }
+    
+    // O navio sobrescreve qualquer área de efeito existente, como na versão matricial
+    tabuleiro->navios = mascaraOu(tabuleiro->navios, mascara);
+    tabuleiro->efeito = mascaraENao(tabuleiro->efeito, mascara);
+    return POSICIONAMENTO_OK;
+}
+
+// Função para posicionar um navio no tabuleiro em bits (sem mensagens)
+bool posicionarNavioBits(TabuleiroBits* tabuleiro, Navio navio) {
+    return tentarPosicionarNavioBits(tabuleiro, navio.linha, navio.coluna, navio.orientacao) == POSICIONAMENTO_OK;
+}
+
+// Função para obter a área de uma habilidade: tabela para origens no tabuleiro, estêncil para as demais
+Mascara128 obterMascaraHabilidade(TipoHabilidade tipo, int linha_origem, int coluna_origem) {
+    if (celulaDentroDosLimites(linha_origem, coluna_origem, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return mascarasHabilidade[tipo][linha_origem * TAMANHO_TABULEIRO + coluna_origem];
+    }
+    return construirMascaraHabilidade(tipo, linha_origem, coluna_origem);
+}
+
+// Função para aplicar uma habilidade, dada por tipo e origem, ao tabuleiro em bits
+void aplicarHabilidadeTipoBits(TabuleiroBits* tabuleiro, TipoHabilidade tipo, int linha_origem, int coluna_origem) {
+    Mascara128 area = obterMascaraHabilidade(tipo, linha_origem, coluna_origem);
+    tabuleiro->efeito = mascaraOu(tabuleiro->efeito, mascaraENao(area, tabuleiro->navios));
+}
+
+// Função para aplicar uma habilidade ao tabuleiro em bits (navios não são sobrescritos)
+void aplicarHabilidadeBits(TabuleiroBits* tabuleiro, const HabilidadeEspecial* habilidade) {
+    aplicarHabilidadeTipoBits(tabuleiro, habilidade->tipo, habilidade->linha_origem, habilidade->coluna_origem);
+}
+
+// Função para obter o valor (AGUA, NAVIO ou AREA_EFEITO) de uma célula do tabuleiro em bits
+int obterCelulaBits(const TabuleiroBits* tabuleiro, int linha, int coluna) {
+    int indice = linha * TAMANHO_TABULEIRO + coluna;
+    if (mascaraTestarCelula(tabuleiro->navios, indice)) {
+        return NAVIO;
+    }
+    if (mascaraTestarCelula(tabuleiro->efeito, indice)) {
+        return AREA_EFEITO;
+    }
+    return AGUA;
+}
+
+// Função para converter o tabuleiro em bits para a matriz usada pelas funções de exibição
+void tabuleiroBitsParaMatriz(const TabuleiroBits* origem, int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO]) {
+    for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
+        for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+            tabuleiro[i][j] = obterCelulaBits(origem, i, j);
+        }
+    }
+}
+
+// Função para converter uma matriz de tabuleiro para o formato em bits
+void matrizParaTabuleiroBits(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], TabuleiroBits* destino) {
+    inicializarTabuleiroBits(destino);
+    for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
+        for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+            Mascara128 celula = mascaraDaCelula(i * TAMANHO_TABULEIRO + j);
+            if (tabuleiro[i][j] == NAVIO) {
+                destino->navios = mascaraOu(destino->navios, celula);
+            } else if (tabuleiro[i][j] == AREA_EFEITO) {
+                destino->efeito = mascaraOu(destino->efeito, celula);
+            }
+        }
+    }
+}
+
+// Funções de contagem por popcount
+int contarNaviosBits(const TabuleiroBits* tabuleiro) {
+    return mascaraContar(tabuleiro->navios);
+}
+
+int contarEfeitoBits(const TabuleiroBits* tabuleiro) {
+    return mascaraContar(tabuleiro->efeito);
+}
+
+int contarAguaBits(const TabuleiroBits* tabuleiro) {
+    return TOTAL_CELULAS - contarNaviosBits(tabuleiro) - contarEfeitoBits(tabuleiro);
+}
+
+// Funções de ocupação por linha e por coluna de uma camada (navios ou efeito)
+int contarLinhaBits(Mascara128 camada, int linha) {
+    inicializarTabelasBits();
+    return mascaraContar(mascaraE(camada, mascarasLinha[linha]));
+}
+
+int contarColunaBits(Mascara128 camada, int coluna) {
+    inicializarTabelasBits();
+    return mascaraContar(mascaraE(camada, mascarasColuna[coluna]));
+}
+
+// =====================================================================
+// IDENTIDADE DOS NAVIOS (ACERTO E AFUNDAMENTO EM O(1))
+// =====================================================================
+
+// Camada paralela ao tabuleiro: cada célula guarda qual navio a ocupa (0 = nenhum, i + 1 = navio i)
+// e cada navio guarda quantas partes ainda não foram atingidas. Um tiro resolve água, acerto ou
+// afundamento com uma leitura e um decremento, sem varrer o tabuleiro. Independe da representação
+// do tabuleiro (matriz ou bits): basta registrar cada navio depois de posicioná-lo.
+
+// Um navio ocupa 3 células, então no máximo 33 cabem no 10x10 e uma máscara de 64 bits os identifica
+#define MAX_NAVIOS_IDENTIFICADOS 64
+
+typedef enum {
+    TIRO_AGUA,
+    TIRO_ACERTO,
+    TIRO_AFUNDOU,
+    TIRO_REPETIDO,
+    TIRO_INVALIDO
+} ResultadoTiro;
+
+typedef struct {
+    uint8_t navio_da_celula[TOTAL_CELULAS];
+    uint8_t partes_restantes[MAX_NAVIOS_IDENTIFICADOS];
+    Mascara128 atingidas;
+    int num_navios;
+    int afundados;
+} CamadaNavios;
+
+// Função para esvaziar a camada (nenhum navio, nenhum tiro)
+void inicializarCamadaNavios(CamadaNavios* camada) {
+    memset(camada->navio_da_celula, 0, sizeof(camada->navio_da_celula));
+    camada->atingidas = mascaraVazia();
+    camada->num_navios = 0;
+    camada->afundados = 0;
+}
+
+// Função para registrar um navio já posicionado; devolve o índice dele ou -1 se a camada encheu
+int registrarNavioCamada(CamadaNavios* camada, Navio navio) {
+    if (camada->num_navios == MAX_NAVIOS_IDENTIFICADOS) {
+        return -1;
+    }
+    
+    int indice = camada->num_navios++;
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        int linha, coluna;
+        calcularPosicaoNavio(navio.linha, navio.coluna, navio.orientacao, i, &linha, &coluna);
+        camada->navio_da_celula[linha * TAMANHO_TABULEIRO + coluna] = (uint8_t) (indice + 1);
+    }
+    camada->partes_restantes[indice] = TAMANHO_NAVIO;
+    return indice;
+}
+
+// Função para obter o navio de uma célula (-1 se não há navio)
+static inline int obterNavioCelula(const CamadaNavios* camada, int linha, int coluna) {
+    return camada->navio_da_celula[linha * TAMANHO_TABULEIRO + coluna] - 1;
+}
+
+// Função para resolver um tiro em tempo constante; navio (pode ser NULL) recebe o navio atingido ou -1
+ResultadoTiro atirarCamadaNavios(CamadaNavios* camada, int linha, int coluna, int* navio) {
+    if (navio != NULL) {
+        *navio = -1;
+    }
+    if (!celulaDentroDosLimites(linha, coluna, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return TIRO_INVALIDO;
+    }
+    
+    int celula = linha * TAMANHO_TABULEIRO + coluna;
+    int atingido = camada->navio_da_celula[celula] - 1;
+    if (navio != NULL) {
+        *navio = atingido;
+    }
+    if (mascaraTestarCelula(camada->atingidas, celula)) {
+        return TIRO_REPETIDO;
+    }
+    camada->atingidas = mascaraOu(camada->atingidas, mascaraDaCelula(celula));
+    
+    if (atingido < 0) {
+        return TIRO_AGUA;
+    }
+    if (--camada->partes_restantes[atingido] > 0) {
+        return TIRO_ACERTO;
+    }
+    camada->afundados++;
+    return TIRO_AFUNDOU;
+}
+
+// Função para saber se toda a frota registrada já afundou
+static inline bool frotaAfundadaCamada(const CamadaNavios* camada) {
+    return camada->afundados == camada->num_navios;
+}
+
+// Função para obter os navios que uma alteração alcançou (bit i = navio i): as células de navio que a
+// habilidade preservou são exatamente as registradas com anterior == NAVIO
+uint64_t naviosTocadosAlteracao(const CamadaNavios* camada, const AlteracaoTabuleiro* alteracao) {
+    uint64_t tocados = 0;
+    
+    for (int i = 0; i < alteracao->num_celulas; i++) {
+        if (alteracao->celulas[i].anterior == NAVIO) {
+            int navio = camada->navio_da_celula[alteracao->celulas[i].indice] - 1;
+            if (navio >= 0) {
+                tocados |= UINT64_C(1) << navio;
+            }
+        }
+    }
+    return tocados;
+}
+
+// Função para obter os navios sob a área de uma habilidade no tabuleiro em bits (bit i = navio i)
+uint64_t naviosTocadosMascara(const CamadaNavios* camada, Mascara128 area) {
+    uint64_t tocados = 0;
+    
+    for (uint64_t bits = area.baixo; bits != 0; bits &= bits - 1) {
+        int navio = camada->navio_da_celula[__builtin_ctzll(bits)] - 1;
+        tocados |= navio >= 0 ? UINT64_C(1) << navio : 0;
+    }
+    for (uint64_t bits = area.alto; bits != 0; bits &= bits - 1) {
+        int navio = camada->navio_da_celula[64 + __builtin_ctzll(bits)] - 1;
+        tocados |= navio >= 0 ? UINT64_C(1) << navio : 0;
+    }
+    return tocados;
+}
+
+// Função para posicionar um navio na matriz (sem mensagens) e registrá-lo na camada
+ResultadoPosicionamento posicionarNavioIdentificado(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO],
+                                                    CamadaNavios* camada, Navio navio,
+                                                    EstatisticasTabuleiro* estatisticas) {
+    if (camada->num_navios == MAX_NAVIOS_IDENTIFICADOS) {
+        return POSICIONAMENTO_INVALIDO;
+    }
+    
+    ResultadoPosicionamento resultado = tentarPosicionarNavio(tabuleiro, navio, estatisticas, NULL);
+    if (resultado == POSICIONAMENTO_OK) {
+        registrarNavioCamada(camada, navio);
+    }
+    return resultado;
+}
+
+// Função para aplicar uma habilidade na matriz (sem mensagens) e devolver os navios que ela alcançou
+uint64_t aplicarHabilidadeIdentificada(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO],
+                                       const CamadaNavios* camada, const HabilidadeEspecial* habilidade,
+                                       EstatisticasTabuleiro* estatisticas) {
+    AlteracaoTabuleiro alteracao;
+    marcarAreaHabilidade(tabuleiro, habilidade, estatisticas, &alteracao);
+    return naviosTocadosAlteracao(camada, &alteracao);
+}
+
+// =====================================================================
+// TABULEIRO GRANDE EM BLOCOS (DIMENSÕES EM TEMPO DE EXECUÇÃO)
+// =====================================================================
+
+// Cada bloco guarda 8x8 células de 1 byte: 64 bytes, exatamente uma linha de cache
+#define LADO_BLOCO 8
+#define BITS_LADO_BLOCO 3
+
+typedef struct {
+    _Alignas(64) unsigned char celulas[LADO_BLOCO][LADO_BLOCO];
+} BlocoTabuleiro;
+
+// Tabuleiro com dimensões definidas em tempo de execução. O diretório tem dois níveis:
+// uma entrada por linha de blocos, e cada linha de blocos só é criada quando tocada.
+// Blocos que nunca receberam nada além de água não ocupam memória.
+typedef struct {
+    int linhas;
+    int colunas;
+    int linhas_blocos;
+    int colunas_blocos;
+    BlocoTabuleiro*** diretorio;
+    size_t blocos_alocados;
+    // Estatísticas mantidas a cada escrita (consultas em O(1), sem varrer os blocos)
+    long navios;
+    long efeito;
+    int* navios_linha;
+    int* efeito_linha;
+    int* navios_coluna;
+    int* efeito_coluna;
+} TabuleiroGrande;
+
+// Função para criar um tabuleiro grande vazio (somente água)
+bool criarTabuleiroGrande(TabuleiroGrande* tabuleiro, int linhas, int colunas) {
+    memset(tabuleiro, 0, sizeof(*tabuleiro));
+    if (linhas <= 0 || colunas <= 0) {
+        return false;
+    }
+    
+    tabuleiro->linhas = linhas;
+    tabuleiro->colunas = colunas;
+    tabuleiro->linhas_blocos = (linhas + LADO_BLOCO - 1) / LADO_BLOCO;
+    tabuleiro->colunas_blocos = (colunas + LADO_BLOCO - 1) / LADO_BLOCO;
+    tabuleiro->diretorio = alocarMemoriaZerada(tabuleiro->linhas_blocos, sizeof(BlocoTabuleiro**));
+    
+    // Os quatro vetores de ocupação compartilham uma única alocação
+    int* ocupacao = alocarMemoriaZerada(2 * ((size_t) linhas + colunas), sizeof(int));
+    tabuleiro->navios_linha = ocupacao;
+    if (ocupacao != NULL) {
+        tabuleiro->efeito_linha = ocupacao + linhas;
+        tabuleiro->navios_coluna = ocupacao + 2 * (size_t) linhas;
+        tabuleiro->efeito_coluna = ocupacao + 2 * (size_t) linhas + colunas;
+    }
+    return tabuleiro->diretorio != NULL && ocupacao != NULL;
+}
+
+// Função para liberar toda a memória de um tabuleiro grande
+void destruirTabuleiroGrande(TabuleiroGrande* tabuleiro) {
+    if (tabuleiro->diretorio != NULL) {
+        for (int i = 0; i < tabuleiro->linhas_blocos; i++) {
+            if (tabuleiro->diretorio[i] == NULL) {
+                continue;
+            }
+            for (int j = 0; j < tabuleiro->colunas_blocos; j++) {
+                free(tabuleiro->diretorio[i][j]);
+            }
+            free(tabuleiro->diretorio[i]);
+        }
+        free(tabuleiro->diretorio);
+    }
+    free(tabuleiro->navios_linha);
+    memset(tabuleiro, 0, sizeof(*tabuleiro));
+}
+
+// Função para obter o bloco de uma célula sem alocar (NULL se o bloco ainda é só água)
+static inline BlocoTabuleiro* obterBlocoGrande(const TabuleiroGrande* tabuleiro, int linha, int coluna) {
+    BlocoTabuleiro** linha_blocos = tabuleiro->diretorio[linha >> BITS_LADO_BLOCO];
+    return linha_blocos == NULL ? NULL : linha_blocos[coluna >> BITS_LADO_BLOCO];
+}
+
+// Função para obter o bloco de uma célula, alocando-o na primeira escrita
+static BlocoTabuleiro* obterOuCriarBlocoGrande(TabuleiroGrande* tabuleiro, int linha, int coluna) {
+    int bloco_linha = linha >> BITS_LADO_BLOCO;
+    int bloco_coluna = coluna >> BITS_LADO_BLOCO;
+    
+    if (tabuleiro->diretorio[bloco_linha] == NULL) {
+        tabuleiro->diretorio[bloco_linha] = alocarMemoriaZerada(tabuleiro->colunas_blocos, sizeof(BlocoTabuleiro*));
+        if (tabuleiro->diretorio[bloco_linha] == NULL) {
+            return NULL;
+        }
+    }
+    
+    BlocoTabuleiro* bloco = tabuleiro->diretorio[bloco_linha][bloco_coluna];
+    if (bloco == NULL) {
+        bloco = alocarMemoriaAlinhada(64, sizeof(BlocoTabuleiro));
+        if (bloco == NULL) {
+            return NULL;
+        }
+        memset(bloco, AGUA, sizeof(BlocoTabuleiro));
+        tabuleiro->diretorio[bloco_linha][bloco_coluna] = bloco;
+        tabuleiro->blocos_alocados++;
+    }
+    return bloco;
+}
+
+// Função para registrar a troca do valor de uma célula do tabuleiro grande (de 'antigo' para 'novo')
+static inline void contabilizarCelulaGrande(TabuleiroGrande* tabuleiro, int linha, int coluna, int antigo, int novo) {
+    if (antigo == novo) {
+        return;
+    }
+    
+    if (antigo == NAVIO) {
+        tabuleiro->navios--;
+        tabuleiro->navios_linha[linha]--;
+        tabuleiro->navios_coluna[coluna]--;
+    } else if (antigo == AREA_EFEITO) {
+        tabuleiro->efeito--;
+        tabuleiro->efeito_linha[linha]--;
+        tabuleiro->efeito_coluna[coluna]--;
+    }
+    if (novo == NAVIO) {
+        tabuleiro->navios++;
+        tabuleiro->navios_linha[linha]++;
+        tabuleiro->navios_coluna[coluna]++;
+    } else if (novo == AREA_EFEITO) {
+        tabuleiro->efeito++;
+        tabuleiro->efeito_linha[linha]++;
+        tabuleiro->efeito_coluna[coluna]++;
+    }
+}
+
+// Função para ler uma célula do tabuleiro grande (fora dos limites é tratado como água)
+int obterCelulaGrande(const TabuleiroGrande* tabuleiro, int linha, int coluna) {
+    if (!celulaDentroDosLimites(linha, coluna, tabuleiro->linhas, tabuleiro->colunas)) {
+        return AGUA;
+    }
+    
+    BlocoTabuleiro* bloco = obterBlocoGrande(tabuleiro, linha, coluna);
+    if (bloco == NULL) {
+        return AGUA;
+    }
+    return bloco->celulas[linha & (LADO_BLOCO - 1)][coluna & (LADO_BLOCO - 1)];
+}
+
+// Função para escrever uma célula do tabuleiro grande
+bool definirCelulaGrande(TabuleiroGrande* tabuleiro, int linha, int coluna, int valor) {
+    if (!celulaDentroDosLimites(linha, coluna, tabuleiro->linhas, tabuleiro->colunas)) {
+        return false;
+    }
+    
+    // Escrever água em um bloco inexistente não muda nada: evita alocar à toa
+    if (valor == AGUA && obterBlocoGrande(tabuleiro, linha, coluna) == NULL) {
+        return true;
+    }
+    
+    BlocoTabuleiro* bloco = obterOuCriarBlocoGrande(tabuleiro, linha, coluna);
+    if (bloco == NULL) {
+        return false;
+    }
+    unsigned char* celula = &bloco->celulas[linha & (LADO_BLOCO - 1)][coluna & (LADO_BLOCO - 1)];
+    contabilizarCelulaGrande(tabuleiro, linha, coluna, *celula, valor);
+    *celula = (unsigned char) valor;
+    return true;
+}
+
+// Funções de consulta das estatísticas do tabuleiro grande (O(1))
+long contarNaviosGrande(const TabuleiroGrande* tabuleiro) {
+    return tabuleiro->navios;
+}
+
+long contarEfeitoGrande(const TabuleiroGrande* tabuleiro) {
+    return tabuleiro->efeito;
+}
+
+long contarAguaGrande(const TabuleiroGrande* tabuleiro) {
+    return (long) tabuleiro->linhas * tabuleiro->colunas - tabuleiro->navios - tabuleiro->efeito;
+}
+
+// Função para verificar sobreposição de navios no tabuleiro grande
+bool verificarSobreposicaoGrande(const TabuleiroGrande* tabuleiro, int linha, int coluna,
+                                 int tamanho, OrientacaoNavio orientacao) {
+    for (int i = 0; i < tamanho; i++) {
+        int linha_atual, coluna_atual;
+        calcularPosicaoNavio(linha, coluna, orientacao, i, &linha_atual, &coluna_atual);
+        
+        if (obterCelulaGrande(tabuleiro, linha_atual, coluna_atual) == NAVIO) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Função para posicionar um navio no tabuleiro grande (sem mensagens)
+bool posicionarNavioGrande(TabuleiroGrande* tabuleiro, Navio navio) {
+    if (!posicaoValidaDimensoes(navio.linha, navio.coluna, TAMANHO_NAVIO, navio.orientacao,
+                                tabuleiro->linhas, tabuleiro->colunas)) {
+        return false;
+    }
+    
+    if (verificarSobreposicaoGrande(tabuleiro, navio.linha, navio.coluna, TAMANHO_NAVIO, navio.orientacao)) {
+        return false;
+    }
+    
+    // Aloca antes todos os blocos do navio: se faltar memória, nenhuma célula foi escrita
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        int linha_atual, coluna_atual;
+        calcularPosicaoNavio(navio.linha, navio.coluna, navio.orientacao, i, &linha_atual, &coluna_atual);
+        if (obterOuCriarBlocoGrande(tabuleiro, linha_atual, coluna_atual) == NULL) {
+            return false;
+        }
+    }
+    
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        int linha_atual, coluna_atual;
+        calcularPosicaoNavio(navio.linha, navio.coluna, navio.orientacao, i, &linha_atual, &coluna_atual);
+        definirCelulaGrande(tabuleiro, linha_atual, coluna_atual, NAVIO);
+    }
+    return true;
+}
+
+// Função para aplicar habilidade ao tabuleiro grande (sem mensagens)
+void aplicarHabilidadeGrande(TabuleiroGrande* tabuleiro, const HabilidadeEspecial* habilidade) {
+    if (!origemAlcancaTabuleiro(habilidade->linha_origem, habilidade->coluna_origem, TAMANHO_HABILIDADE / 2,
+                                tabuleiro->linhas, tabuleiro->colunas)) {
+        return;
+    }
+    const EstencilHabilidade* estencil = obterEstencil(habilidade->tipo);
+    
+    for (int f = 0; f < estencil->num_faixas; f++) {
+        const FaixaEstencil* faixa = &estencil->faixas[f];
+        int linha_tabuleiro = habilidade->linha_origem + faixa->deslocamento_linha;
+        if (linha_tabuleiro < 0 || linha_tabuleiro >= tabuleiro->linhas) {
+            continue;
+        }
+        
+        int coluna_inicio = habilidade->coluna_origem + faixa->coluna_inicio;
+        int coluna_fim = habilidade->coluna_origem + faixa->coluna_fim;
+        if (coluna_inicio < 0) {
+            coluna_inicio = 0;
+        }
+        if (coluna_fim > tabuleiro->colunas - 1) {
+            coluna_fim = tabuleiro->colunas - 1;
+        }
+        
+        for (int coluna = coluna_inicio; coluna <= coluna_fim; coluna++) {
+            if (obterCelulaGrande(tabuleiro, linha_tabuleiro, coluna) != NAVIO) {
+                definirCelulaGrande(tabuleiro, linha_tabuleiro, coluna, AREA_EFEITO);
+            }
+        }
+    }
+}
+
+// Função para estimar a memória ocupada pelo tabuleiro grande, em bytes
+size_t memoriaTabuleiroGrande(const TabuleiroGrande* tabuleiro) {
+    size_t total = (size_t) tabuleiro->linhas_blocos * sizeof(BlocoTabuleiro**);
+    
+    for (int i = 0; i < tabuleiro->linhas_blocos; i++) {
+        if (tabuleiro->diretorio[i] != NULL) {
+            total += (size_t) tabuleiro->colunas_blocos * sizeof(BlocoTabuleiro*);
+        }
+    }
+    total += 2 * ((size_t) tabuleiro->linhas + tabuleiro->colunas) * sizeof(int);
+    return total + tabuleiro->blocos_alocados * sizeof(BlocoTabuleiro);
+}
+
+// =====================================================================
+// HABILIDADES PREGUIÇOSAS (RESOLUÇÃO SOB DEMANDA NO TABULEIRO GRANDE)
+// =====================================================================
+
+// Em vez de reescrever as células na hora, cada habilidade só marca, no bloco 8x8 correspondente,
+// quais células ela alcança: uma máscara de 64 bits por bloco, alinhada com as células do bloco.
+// Habilidades repetidas ou sobrepostas se fundem no OU das máscaras, então cada célula é
+// materializada no máximo uma vez, e só quando é lida, escrita ou pedida numa região.
+// O resultado é idêntico ao da aplicação imediata, porque o efeito só troca água por área de
+// efeito: navios posicionados depois continuam vencendo, e uma escrita direta descarta a pendência.
+
+typedef struct {
+    TabuleiroGrande base;
+    uint64_t* pendentes;            // Uma máscara por bloco, em ordem de linhas de blocos
+    long celulas_enfileiradas;      // Células alcançadas pelas habilidades (o trabalho da versão imediata)
+    long celulas_resolvidas;        // Células efetivamente materializadas
+} TabuleiroPreguicoso;
+
+// Função para criar um tabuleiro preguiçoso vazio
+bool criarTabuleiroPreguicoso(TabuleiroPreguicoso* tabuleiro, int linhas, int colunas) {
+    tabuleiro->pendentes = NULL;
+    tabuleiro->celulas_enfileiradas = 0;
+    tabuleiro->celulas_resolvidas = 0;
+    if (!criarTabuleiroGrande(&tabuleiro->base, linhas, colunas)) {
+        return false;
+    }
+    tabuleiro->pendentes = alocarMemoriaZerada((size_t) tabuleiro->base.linhas_blocos * tabuleiro->base.colunas_blocos,
+                                               sizeof(uint64_t));
+    return tabuleiro->pendentes != NULL;
+}
+
+void destruirTabuleiroPreguicoso(TabuleiroPreguicoso* tabuleiro) {
+    destruirTabuleiroGrande(&tabuleiro->base);
+    free(tabuleiro->pendentes);
+    tabuleiro->pendentes = NULL;
+}
+
+// Função para enfileirar uma habilidade: O(faixas do estêncil), sem tocar nas células
+void enfileirarHabilidadePreguicosa(TabuleiroPreguicoso* tabuleiro, const HabilidadeEspecial* habilidade) {
+    if (!origemAlcancaTabuleiro(habilidade->linha_origem, habilidade->coluna_origem, TAMANHO_HABILIDADE / 2,
+                                tabuleiro->base.linhas, tabuleiro->base.colunas)) {
+        return;
+    }
+    const EstencilHabilidade* estencil = obterEstencil(habilidade->tipo);
+    
+    for (int f = 0; f < estencil->num_faixas; f++) {
+        const FaixaEstencil* faixa = &estencil->faixas[f];
+        int linha = habilidade->linha_origem + faixa->deslocamento_linha;
+        if (linha < 0 || linha >= tabuleiro->base.linhas) {
+            continue;
+        }
+        
+        int coluna_inicio = habilidade->coluna_origem + faixa->coluna_inicio;
+        int coluna_fim = habilidade->coluna_origem + faixa->coluna_fim;
+        if (coluna_inicio < 0) {
+            coluna_inicio = 0;
+        }
+        if (coluna_fim > tabuleiro->base.colunas - 1) {
+            coluna_fim = tabuleiro->base.colunas - 1;
+        }
+        if (coluna_inicio > coluna_fim) {
+            continue;
+        }
+        tabuleiro->celulas_enfileiradas += coluna_fim - coluna_inicio + 1;
+        
+        // A faixa cobre no máximo dois blocos vizinhos; em cada um vira um trecho de uma linha da máscara
+        uint64_t* pendentes_linha = tabuleiro->pendentes + (size_t) (linha >> BITS_LADO_BLOCO) * tabuleiro->base.colunas_blocos;
+        int deslocamento = (linha & (LADO_BLOCO - 1)) * LADO_BLOCO;
+        for (int bloco = coluna_inicio >> BITS_LADO_BLOCO; bloco <= coluna_fim >> BITS_LADO_BLOCO; bloco++) {
+            int inicio = coluna_inicio > bloco * LADO_BLOCO ? coluna_inicio & (LADO_BLOCO - 1) : 0;
+            int fim = coluna_fim < (bloco + 1) * LADO_BLOCO - 1 ? coluna_fim & (LADO_BLOCO - 1) : LADO_BLOCO - 1;
+            uint64_t trecho = ((1ULL << (fim - inicio + 1)) - 1) << inicio;
+            pendentes_linha[bloco] |= trecho << deslocamento;
+        }
+    }
+}
+
+// Função para materializar as células pendentes de um bloco indicadas em 'mascara'
+static bool resolverPendentesBloco(TabuleiroPreguicoso* tabuleiro, int bloco_linha, int bloco_coluna, uint64_t mascara) {
+    uint64_t* pendentes = &tabuleiro->pendentes[(size_t) bloco_linha * tabuleiro->base.colunas_blocos + bloco_coluna];
+    mascara &= *pendentes;
+    if (mascara == 0) {
+        return true;
+    }
+    
+    BlocoTabuleiro* bloco = obterOuCriarBlocoGrande(&tabuleiro->base, bloco_linha << BITS_LADO_BLOCO,
+                                                    bloco_coluna << BITS_LADO_BLOCO);
+    if (bloco == NULL) {
+        return false;
+    }
+    *pendentes &= ~mascara;
+    tabuleiro->celulas_resolvidas += __builtin_popcountll(mascara);
+    
+    while (mascara != 0) {
+        int bit = __builtin_ctzll(mascara);
+        unsigned char* celula = &bloco->celulas[bit >> BITS_LADO_BLOCO][bit & (LADO_BLOCO - 1)];
+        if (*celula != NAVIO) {
+            contabilizarCelulaGrande(&tabuleiro->base, (bloco_linha << BITS_LADO_BLOCO) + (bit >> BITS_LADO_BLOCO),
+                                     (bloco_coluna << BITS_LADO_BLOCO) + (bit & (LADO_BLOCO - 1)), *celula, AREA_EFEITO);
+            *celula = AREA_EFEITO;
+        }
+        mascara &= mascara - 1;
+    }
+    return true;
+}
+
+// Bit de uma célula dentro da máscara do seu bloco
+static inline uint64_t bitPendenteCelula(int linha, int coluna) {
+    return 1ULL << ((linha & (LADO_BLOCO - 1)) * LADO_BLOCO + (coluna & (LADO_BLOCO - 1)));
+}
+
+// Função para ler uma célula, materializando só ela se houver efeito pendente
+int obterCelulaPreguicosa(TabuleiroPreguicoso* tabuleiro, int linha, int coluna) {
+    if (!celulaDentroDosLimites(linha, coluna, tabuleiro->base.linhas, tabuleiro->base.colunas)) {
+        return AGUA;
+    }
+    resolverPendentesBloco(tabuleiro, linha >> BITS_LADO_BLOCO, coluna >> BITS_LADO_BLOCO, bitPendenteCelula(linha, coluna));
+    return obterCelulaGrande(&tabuleiro->base, linha, coluna);
+}
+
+// Função para escrever uma célula; o efeito pendente seria sobrescrito, então é só descartado
+bool definirCelulaPreguicosa(TabuleiroPreguicoso* tabuleiro, int linha, int coluna, int valor) {
+    if (!celulaDentroDosLimites(linha, coluna, tabuleiro->base.linhas, tabuleiro->base.colunas)) {
+        return false;
+    }
+    tabuleiro->pendentes[(size_t) (linha >> BITS_LADO_BLOCO) * tabuleiro->base.colunas_blocos + (coluna >> BITS_LADO_BLOCO)]
+        &= ~bitPendenteCelula(linha, coluna);
+    return definirCelulaGrande(&tabuleiro->base, linha, coluna, valor);
+}
+
+// Função para posicionar um navio. Efeito pendente nunca vira navio, então a verificação de
+// sobreposição vale sem resolver nada, e as células do navio ignoram o efeito quando ele chegar.
+bool posicionarNavioPreguicoso(TabuleiroPreguicoso* tabuleiro, Navio navio) {
+    return posicionarNavioGrande(&tabuleiro->base, navio);
+}
+
+// Função para materializar os blocos que tocam o retângulo [linha_inicio..linha_fim] x [coluna_inicio..coluna_fim]
+// (blocos inteiros: cada um é uma linha de cache, resolver parte dele não economiza nada)
+bool materializarRegiaoPreguicosa(TabuleiroPreguicoso* tabuleiro, int linha_inicio, int coluna_inicio,
+                                  int linha_fim, int coluna_fim) {
+    linha_inicio = linha_inicio < 0 ? 0 : linha_inicio;
+    coluna_inicio = coluna_inicio < 0 ? 0 : coluna_inicio;
+    linha_fim = linha_fim >= tabuleiro->base.linhas ? tabuleiro->base.linhas - 1 : linha_fim;
+    coluna_fim = coluna_fim >= tabuleiro->base.colunas ? tabuleiro->base.colunas - 1 : coluna_fim;
+    
+    bool sucesso = true;
+    for (int i = linha_inicio >> BITS_LADO_BLOCO; i <= linha_fim >> BITS_LADO_BLOCO && linha_inicio <= linha_fim; i++) {
+        for (int j = coluna_inicio >> BITS_LADO_BLOCO; j <= coluna_fim >> BITS_LADO_BLOCO && coluna_inicio <= coluna_fim; j++) {
+            sucesso = resolverPendentesBloco(tabuleiro, i, j, UINT64_MAX) && sucesso;
+        }
+    }
+    return sucesso;
+}
+
+// Função para materializar tudo (necessário antes de consultar as estatísticas do tabuleiro base)
+bool materializarTudoPreguicoso(TabuleiroPreguicoso* tabuleiro) {
+    return materializarRegiaoPreguicosa(tabuleiro, 0, 0, tabuleiro->base.linhas - 1, tabuleiro->base.colunas - 1);
+}
+
+// Função para contar as células ainda pendentes (já sem repetições)
+long contarPendentesPreguicoso(const TabuleiroPreguicoso* tabuleiro) {
+    long total = 0;
+    size_t num_blocos = (size_t) tabuleiro->base.linhas_blocos * tabuleiro->base.colunas_blocos;
+    for (size_t b = 0; b < num_blocos; b++) {
+        total += __builtin_popcountll(tabuleiro->pendentes[b]);
+    }
+    return total;
+}
+
+// =====================================================================
+// ÍNDICE ESPACIAL DE NAVIOS (GRADE UNIFORME PARA MAPAS GRANDES)
+// =====================================================================
+
+// O mapa é dividido em baldes de 8x8 células. Cada navio entra na lista de cada balde que seu
+// retângulo envolvente toca (no máximo 2x2, já que um navio tem 3 células), e cada entrada conhece as
+// vizinhas, então inserir e remover custam O(1). Uma habilidade de 7x7 também toca no máximo 2x2
+// baldes: a consulta visita só esses baldes, examina cada navio candidato uma única vez (uma marca
+// por consulta evita repetições) e confere as 3 células do navio contra a matriz da habilidade.
+// O custo fica proporcional aos navios próximos da área, não ao tamanho do mapa nem da frota.
+
+#define BITS_BALDE_INDICE 3
+#define MAX_BALDES_NAVIO 4
+
+// Entrada de um navio na lista duplamente encadeada de um balde
+typedef struct {
+    int navio;
+    int balde;
+    int anterior;       // -1 na cabeça do balde
+    int proxima;        // -1 no fim do balde; na lista de entradas livres, a próxima livre
+} EntradaIndice;
+
+typedef struct {
+    Navio navio;
+    int entradas[MAX_BALDES_NAVIO];
+    int num_entradas;   // 0 = posição livre
+    int proximo_livre;
+    uint32_t marca;     // Última consulta que já examinou este navio
+} NavioIndexado;
+
+typedef struct {
+    int linhas;
+    int colunas;
+    int baldes_linha;
+    int baldes_coluna;
+    int* cabecas;
+    EntradaIndice* entradas;
+    int capacidade_entradas;
+    int entrada_livre;
+    NavioIndexado* navios;
+    int capacidade_navios;
+    int navio_livre;
+    int num_navios;
+    uint32_t consulta_atual;
+} IndiceEspacialNavios;
+
+// Resultado de uma consulta em lote: os navios da habilidade h estão em navios[inicio[h] .. inicio[h + 1])
+typedef struct {
+    long* inicio;
+    int* navios;
+    long num_acertos;
+    long capacidade;
+} ResultadoConsultaLote;
+
+// Função para criar um índice vazio para um mapa linhas x colunas
+bool criarIndiceNavios(IndiceEspacialNavios* indice, int linhas, int colunas) {
+    memset(indice, 0, sizeof(*indice));
+    indice->linhas = linhas;
+    indice->colunas = colunas;
+    indice->baldes_linha = ((linhas - 1) >> BITS_BALDE_INDICE) + 1;
+    indice->baldes_coluna = ((colunas - 1) >> BITS_BALDE_INDICE) + 1;
+    indice->entrada_livre = -1;
+    indice->navio_livre = -1;
+    
+    size_t num_baldes = (size_t) indice->baldes_linha * (size_t) indice->baldes_coluna;
+    indice->cabecas = alocarMemoria(sizeof(int) * num_baldes);
+    if (indice->cabecas == NULL) {
+        return false;
+    }
+    memset(indice->cabecas, 0xff, sizeof(int) * num_baldes);    // Todos os baldes vazios (-1)
+    return true;
+}
+
+void destruirIndiceNavios(IndiceEspacialNavios* indice) {
+    free(indice->cabecas);
+    free(indice->entradas);
+    free(indice->navios);
+    memset(indice, 0, sizeof(*indice));
+}
+
+// Função para obter uma entrada livre, crescendo o vetor se preciso (-1 sem memória)
+static int obterEntradaLivreIndice(IndiceEspacialNavios* indice) {
+    if (indice->entrada_livre < 0) {
+        int capacidade = indice->capacidade_entradas > 0 ? indice->capacidade_entradas * 2 : 256;
+        EntradaIndice* entradas = realocarMemoria(indice->entradas, sizeof(EntradaIndice) * (size_t) capacidade);
+        if (entradas == NULL) {
+            return -1;
+        }
+        for (int e = capacidade - 1; e >= indice->capacidade_entradas; e--) {
+            entradas[e].proxima = indice->entrada_livre;
+            indice->entrada_livre = e;
+        }
+        indice->entradas = entradas;
+        indice->capacidade_entradas = capacidade;
+    }
+    
+    int entrada = indice->entrada_livre;
+    indice->entrada_livre = indice->entradas[entrada].proxima;
+    return entrada;
+}
+
+// Função para obter uma posição livre para um navio, crescendo o vetor se preciso (-1 sem memória)
+static int obterNavioLivreIndice(IndiceEspacialNavios* indice) {
+    if (indice->navio_livre < 0) {
+        int capacidade = indice->capacidade_navios > 0 ? indice->capacidade_navios * 2 : 256;
+        NavioIndexado* navios = realocarMemoria(indice->navios, sizeof(NavioIndexado) * (size_t) capacidade);
+        if (navios == NULL) {
+            return -1;
+        }
+        for (int n = capacidade - 1; n >= indice->capacidade_navios; n--) {
+            navios[n].num_entradas = 0;
+            navios[n].marca = 0;
+            navios[n].proximo_livre = indice->navio_livre;
+            indice->navio_livre = n;
+        }
+        indice->navios = navios;
+        indice->capacidade_navios = capacidade;
+    }
+    
+    int navio = indice->navio_livre;
+    indice->navio_livre = indice->navios[navio].proximo_livre;
+    return navio;
+}
+
+// Função para desligar as entradas de um navio dos baldes e devolver a sua posição à lista livre
+// (também serve para desfazer uma inserção interrompida, com qualquer número de entradas)
+static void liberarNavioIndice(IndiceEspacialNavios* indice, int identificador) {
+    NavioIndexado* navio = &indice->navios[identificador];
+    for (int i = 0; i < navio->num_entradas; i++) {
+        EntradaIndice* entrada = &indice->entradas[navio->entradas[i]];
+        if (entrada->anterior >= 0) {
+            indice->entradas[entrada->anterior].proxima = entrada->proxima;
+        } else {
+            indice->cabecas[entrada->balde] = entrada->proxima;
+        }
+        if (entrada->proxima >= 0) {
+            indice->entradas[entrada->proxima].anterior = entrada->anterior;
+        }
+        entrada->proxima = indice->entrada_livre;
+        indice->entrada_livre = navio->entradas[i];
+    }
+    
+    navio->num_entradas = 0;
+    navio->proximo_livre = indice->navio_livre;
+    indice->navio_livre = identificador;
+}
+
+// Função para remover um navio do índice em O(1) (false se o identificador não está em uso)
+bool removerNavioIndice(IndiceEspacialNavios* indice, int identificador) {
+    if (identificador < 0 || identificador >= indice->capacidade_navios ||
+        indice->navios[identificador].num_entradas == 0) {
+        return false;
+    }
+    
+    liberarNavioIndice(indice, identificador);
+    indice->num_navios--;
+    return true;
+}
+
+// Função para inserir um navio (posição já validada no mapa); devolve o identificador ou -1 sem memória
+int inserirNavioIndice(IndiceEspacialNavios* indice, Navio navio) {
+    int identificador = obterNavioLivreIndice(indice);
+    if (identificador < 0) {
+        return -1;
+    }
+    NavioIndexado* indexado = &indice->navios[identificador];
+    indexado->navio = navio;
+    indexado->num_entradas = 0;
+    
+    // Retângulo envolvente pelas duas pontas do navio
+    int linha_fim, coluna_fim;
+    calcularPosicaoNavio(navio.linha, navio.coluna, navio.orientacao, TAMANHO_NAVIO - 1, &linha_fim, &coluna_fim);
+    int balde_linha_inicio = navio.linha >> BITS_BALDE_INDICE;
+    int balde_linha_fim = linha_fim >> BITS_BALDE_INDICE;
+    int coluna_min = navio.coluna < coluna_fim ? navio.coluna : coluna_fim;
+    int coluna_max = navio.coluna < coluna_fim ? coluna_fim : navio.coluna;
+    
+    for (int bl = balde_linha_inicio; bl <= balde_linha_fim; bl++) {
+        for (int bc = coluna_min >> BITS_BALDE_INDICE; bc <= coluna_max >> BITS_BALDE_INDICE; bc++) {
+            int entrada = obterEntradaLivreIndice(indice);
+            if (entrada < 0) {
+                liberarNavioIndice(indice, identificador);
+                return -1;
+            }
+            
+            int balde = bl * indice->baldes_coluna + bc;
+            EntradaIndice* nova = &indice->entradas[entrada];
+            nova->navio = identificador;
+            nova->balde = balde;
+            nova->anterior = -1;
+            nova->proxima = indice->cabecas[balde];
+            if (nova->proxima >= 0) {
+                indice->entradas[nova->proxima].anterior = entrada;
+            }
+            indice->cabecas[balde] = entrada;
+            indexado->entradas[indexado->num_entradas++] = entrada;
+        }
+    }
+    indice->num_navios++;
+    return identificador;
+}
+
+// Função para saber se alguma célula do navio está na área da habilidade
+static inline bool navioNaAreaHabilidade(const Navio* navio, const HabilidadeEspecial* habilidade) {
+    const int raio = TAMANHO_HABILIDADE / 2;
+    
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        int linha, coluna;
+        calcularPosicaoNavio(navio->linha, navio->coluna, navio->orientacao, i, &linha, &coluna);
+        int dl = linha - habilidade->linha_origem + raio;
+        int dc = coluna - habilidade->coluna_origem + raio;
+        if ((unsigned) dl < TAMANHO_HABILIDADE && (unsigned) dc < TAMANHO_HABILIDADE &&
+            matrizesHabilidade[habilidade->tipo][dl][dc] == 1) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Função para anexar um navio atingido ao resultado, crescendo o vetor se preciso
+static bool anexarAcertoConsulta(ResultadoConsultaLote* resultado, int navio) {
+    if (resultado->num_acertos == resultado->capacidade) {
+        long capacidade = resultado->capacidade > 0 ? resultado->capacidade * 2 : 1024;
+        int* navios = realocarMemoria(resultado->navios, sizeof(int) * (size_t) capacidade);
+        if (navios == NULL) {
+            return false;
+        }
+        resultado->navios = navios;
+        resultado->capacidade = capacidade;
+    }
+    resultado->navios[resultado->num_acertos++] = navio;
+    return true;
+}
+
+// Função para listar, para cada habilidade do lote, os navios que sua área alcança
+bool consultarHabilidadesIndice(IndiceEspacialNavios* indice, const HabilidadeEspecial* habilidades,
+                                long num_habilidades, ResultadoConsultaLote* resultado) {
+    const int raio = TAMANHO_HABILIDADE / 2;
+    
+    inicializarEstenceis();
+    resultado->num_acertos = 0;
+    resultado->inicio = realocarMemoria(resultado->inicio, sizeof(long) * (size_t) (num_habilidades + 1));
+    if (resultado->inicio == NULL) {
+        return false;
+    }
+    
+    for (long h = 0; h < num_habilidades; h++) {
+        const HabilidadeEspecial* habilidade = &habilidades[h];
+        resultado->inicio[h] = resultado->num_acertos;
+        
+        // Uma marca nova por consulta; na volta do contador, as marcas antigas são apagadas
+        if (++indice->consulta_atual == 0) {
+            for (int n = 0; n < indice->capacidade_navios; n++) {
+                indice->navios[n].marca = 0;
+            }
+            indice->consulta_atual = 1;
+        }
+        if (!origemAlcancaTabuleiro(habilidade->linha_origem, habilidade->coluna_origem, raio,
+                                    indice->linhas, indice->colunas)) {
+            continue;
+        }
+        
+        int linha_min = habilidade->linha_origem - raio < 0 ? 0 : habilidade->linha_origem - raio;
+        int linha_max = habilidade->linha_origem + raio >= indice->linhas ? indice->linhas - 1 : habilidade->linha_origem + raio;
+        int coluna_min = habilidade->coluna_origem - raio < 0 ? 0 : habilidade->coluna_origem - raio;
+        int coluna_max = habilidade->coluna_origem + raio >= indice->colunas ? indice->colunas - 1 : habilidade->coluna_origem + raio;
+        
+        for (int bl = linha_min >> BITS_BALDE_INDICE; linha_min <= linha_max && bl <= linha_max >> BITS_BALDE_INDICE; bl++) {
+            for (int bc = coluna_min >> BITS_BALDE_INDICE; coluna_min <= coluna_max && bc <= coluna_max >> BITS_BALDE_INDICE; bc++) {
+                for (int e = indice->cabecas[bl * indice->baldes_coluna + bc]; e >= 0; e = indice->entradas[e].proxima) {
+                    NavioIndexado* candidato = &indice->navios[indice->entradas[e].navio];
+                    if (candidato->marca == indice->consulta_atual) {
+                        continue;
+                    }
+                    candidato->marca = indice->consulta_atual;
+                    if (navioNaAreaHabilidade(&candidato->navio, habilidade) &&
+                        !anexarAcertoConsulta(resultado, indice->entradas[e].navio)) {
+                        return false;
+                    }
+                }
+            }
+        }
+    }
+    resultado->inicio[num_habilidades] = resultado->num_acertos;
+    return true;
+}
+
+void liberarResultadoConsulta(ResultadoConsultaLote* resultado) {
+    free(resultado->inicio);
+    free(resultado->navios);
+    memset(resultado, 0, sizeof(*resultado));
+}
+
+// =====================================================================
+// MOTORES ESPECIALIZADOS POR TAMANHO DE TABULEIRO
+// =====================================================================
+
+// Tabuleiros densos (um byte por célula, linha a linha) com as operações básicas geradas em tempo
+// de compilação para os lados mais usados. Com o lado constante, o índice de cada célula vira
+// deslocamentos fixos, as 3 partes do navio são escritas sem laço e a validação usa limites
+// pré-calculados por orientação. Outros lados usam o motor genérico, com o lado em tempo de execução.
+
+_Static_assert(TAMANHO_NAVIO == 3, "os motores especializados desenrolam navios de 3 células");
+
+// Faixa de origens válidas de um navio em cada orientação (as bordas do tabuleiro)
+typedef struct {
+    int linha_max;
+    int coluna_min;
+    int coluna_max;
+} LimitesOrientacao;
+
+// Operações de um motor; os especializados ignoram o parâmetro 'lado'.
+// verificarSobreposicao exige uma posição válida (confira com posicaoValida antes).
+typedef struct {
+    int lado;                       // 0 no motor genérico
+    const char* nome;
+    void (*inicializar)(uint8_t* celulas, int lado);
+    bool (*posicaoValida)(int linha, int coluna, OrientacaoNavio orientacao, int lado);
+    void (*calcularPosicaoNavio)(int linha, int coluna, OrientacaoNavio orientacao, int indices[TAMANHO_NAVIO], int lado);
+    bool (*verificarSobreposicao)(const uint8_t* celulas, int linha, int coluna, OrientacaoNavio orientacao, int lado);
+    ResultadoPosicionamento (*posicionarNavio)(uint8_t* celulas, int linha, int coluna, OrientacaoNavio orientacao, int lado);
+    int (*aplicarHabilidade)(uint8_t* celulas, TipoHabilidade tipo, int linha_origem, int coluna_origem, int lado);
+} MotorTabuleiro;
+
+typedef struct {
+    int lado;
+    uint8_t* celulas;
+    const MotorTabuleiro* motor;
+} TabuleiroDenso;
+
+// Função para marcar uma faixa da habilidade, sem sobrescrever navios; devolve as células escritas
+static inline int marcarFaixaDensa(uint8_t* linha, int coluna_inicio, int coluna_fim) {
+    int escritas = 0;
+    for (int coluna = coluna_inicio; coluna <= coluna_fim; coluna++) {
+        bool agua_ou_efeito = linha[coluna] != NAVIO;
+        linha[coluna] = agua_ou_efeito ? AREA_EFEITO : NAVIO;
+        escritas += agua_ou_efeito;
+    }
+    return escritas;
+}
+
+// Gera o motor de lado N. Habilidades com a origem longe das bordas dispensam o recorte de cada faixa.
+#define DEFINIR_MOTOR_TABULEIRO(N)                                                                          \
+static const LimitesOrientacao limitesNavio##N[4] = {                                                     \
+    [HORIZONTAL] = {N - 1, 0, N - TAMANHO_NAVIO},                                                         \
+    [VERTICAL] = {N - TAMANHO_NAVIO, 0, N - 1},                                                           \
+    [DIAGONAL_PRINCIPAL] = {N - TAMANHO_NAVIO, 0, N - TAMANHO_NAVIO},                                     \
+    [DIAGONAL_SECUNDARIA] = {N - TAMANHO_NAVIO, TAMANHO_NAVIO - 1, N - 1}                                 \
+};                                                                                                          \
+static const int passosNavio##N[4] = {1, N, N + 1, N - 1};                                                \
+                                                                                                            \
+static void inicializarTabuleiro##N(uint8_t* celulas, int lado) {                                         \
+    (void) lado;                                                                                            \
+    memset(celulas, AGUA, (size_t) N * N);                                                                  \
+}                                                                                                           \
+                                                                                                            \
+static bool posicaoValida##N(int linha, int coluna, OrientacaoNavio orientacao, int lado) {              \
+    (void) lado;                                                                                            \
+    if ((unsigned) orientacao > DIAGONAL_SECUNDARIA) {                                                     \
+        return false;                                                                                       \
+    }                                                                                                       \
+    const LimitesOrientacao* limites = &limitesNavio##N[orientacao];                                      \
+    return (unsigned) linha <= (unsigned) limites->linha_max &&                                            \
+           (unsigned) (coluna - limites->coluna_min) <= (unsigned) (limites->coluna_max - limites->coluna_min); \
+}                                                                                                           \
+                                                                                                            \
+static void calcularPosicaoNavio##N(int linha, int coluna, OrientacaoNavio orientacao,                    \
+                                    int indices[TAMANHO_NAVIO], int lado) {                                \
+    (void) lado;                                                                                            \
+    int passo = passosNavio##N[orientacao];                                                                 \
+    indices[0] = linha * N + coluna;                                                                        \
+    indices[1] = indices[0] + passo;                                                                        \
+    indices[2] = indices[0] + 2 * passo;                                                                    \
+}                                                                                                           \
+                                                                                                            \
+static bool verificarSobreposicao##N(const uint8_t* celulas, int linha, int coluna,                       \
+                                     OrientacaoNavio orientacao, int lado) {                               \
+    (void) lado;                                                                                            \
+    const uint8_t* inicio = celulas + linha * N + coluna;                                                   \
+    int passo = passosNavio##N[orientacao];                                                                 \
+    return (inicio[0] == NAVIO) | (inicio[passo] == NAVIO) | (inicio[2 * passo] == NAVIO);                \
+}                                                                                                           \
+                                                                                                            \
+static ResultadoPosicionamento posicionarNavio##N(uint8_t* celulas, int linha, int coluna,                \
+                                                  OrientacaoNavio orientacao, int lado) {                  \
+    if (!posicaoValida##N(linha, coluna, orientacao, lado)) {                                              \
+        return POSICIONAMENTO_INVALIDO;                                                                     \
+    }                                                                                                       \
+    if (verificarSobreposicao##N(celulas, linha, coluna, orientacao, lado)) {                              \
+        return POSICIONAMENTO_SOBREPOSTO;                                                                   \
+    }                                                                                                       \
+    uint8_t* inicio = celulas + linha * N + coluna;                                                         \
+    int passo = passosNavio##N[orientacao];                                                                 \
+    inicio[0] = NAVIO;                                                                                      \
+    inicio[passo] = NAVIO;                                                                                  \
+    inicio[2 * passo] = NAVIO;                                                                              \
+    return POSICIONAMENTO_OK;                                                                               \
+}                                                                                                           \
+                                                                                                            \
+static int aplicarHabilidade##N(uint8_t* celulas, TipoHabilidade tipo, int linha_origem,                   \
+                                int coluna_origem, int lado) {                                             \
+    (void) lado;                                                                                            \
+    const EstencilHabilidade* estencil = obterEstencil(tipo);                                               \
+    const int raio = TAMANHO_HABILIDADE / 2;                                                                \
+    int escritas = 0;                                                                                       \
+                                                                                                            \
+    if (!origemAlcancaTabuleiro(linha_origem, coluna_origem, raio, N, N)) {                                 \
+        return 0;                                                                                           \
+    }                                                                                                       \
+    if ((unsigned) (linha_origem - raio) <= (unsigned) (N - TAMANHO_HABILIDADE) &&                         \
+        (unsigned) (coluna_origem - raio) <= (unsigned) (N - TAMANHO_HABILIDADE)) {                        \
+        uint8_t* centro = celulas + linha_origem * N + coluna_origem;                                       \
+        for (int f = 0; f < estencil->num_faixas; f++) {                                                    \
+            const FaixaEstencil* faixa = &estencil->faixas[f];                                              \
+            escritas += marcarFaixaDensa(centro + faixa->deslocamento_linha * N,                            \
+                                         faixa->coluna_inicio, faixa->coluna_fim);                          \
+        }                                                                                                   \
+        return escritas;                                                                                    \
+    }                                                                                                       \
+                                                                                                            \
+    for (int f = 0; f < estencil->num_faixas; f++) {                                                        \
+        const FaixaEstencil* faixa = &estencil->faixas[f];                                                  \
+        int linha = linha_origem + faixa->deslocamento_linha;                                               \
+        if ((unsigned) linha >= N) {                                                                        \
+            continue;                                                                                       \
+        }                                                                                                   \
+        int coluna_inicio = coluna_origem + faixa->coluna_inicio;                                           \
+        int coluna_fim = coluna_origem + faixa->coluna_fim;                                                 \
+        coluna_inicio = coluna_inicio < 0 ? 0 : coluna_inicio;                                              \
+        coluna_fim = coluna_fim > N - 1 ? N - 1 : coluna_fim;                                               \
+        escritas += marcarFaixaDensa(celulas + linha * N, coluna_inicio, coluna_fim);                       \
+    }                                                                                                       \
+    return escritas;                                                                                        \
+}
+
+#define MOTOR_TABULEIRO(N) \
+    {N, #N "x" #N, inicializarTabuleiro##N, posicaoValida##N, calcularPosicaoNavio##N, \
+     verificarSobreposicao##N, posicionarNavio##N, aplicarHabilidade##N}
+
+DEFINIR_MOTOR_TABULEIRO(10)
+DEFINIR_MOTOR_TABULEIRO(16)
+DEFINIR_MOTOR_TABULEIRO(64)
+
+// Motor genérico: mesmas operações, com o lado lido em tempo de execução
+static void inicializarTabuleiroGenerico(uint8_t* celulas, int lado) {
+    memset(celulas, AGUA, (size_t) lado * (size_t) lado);
+}
+
+static bool posicaoValidaGenerica(int linha, int coluna, OrientacaoNavio orientacao, int lado) {
+    return posicaoValidaDimensoes(linha, coluna, TAMANHO_NAVIO, orientacao, lado, lado);
+}
+
+static void calcularPosicaoNavioGenerica(int linha, int coluna, OrientacaoNavio orientacao,
+                                         int indices[TAMANHO_NAVIO], int lado) {
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        int linha_atual, coluna_atual;
+        calcularPosicaoNavio(linha, coluna, orientacao, i, &linha_atual, &coluna_atual);
+        indices[i] = linha_atual * lado + coluna_atual;
+    }
+}
+
+static bool verificarSobreposicaoGenerica(const uint8_t* celulas, int linha, int coluna,
+                                          OrientacaoNavio orientacao, int lado) {
+    int indices[TAMANHO_NAVIO];
+    calcularPosicaoNavioGenerica(linha, coluna, orientacao, indices, lado);
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        if (celulas[indices[i]] == NAVIO) {
+            return true;
+        }
+    }
+    return false;
+}
+
+static ResultadoPosicionamento posicionarNavioGenerico(uint8_t* celulas, int linha, int coluna,
+                                                       OrientacaoNavio orientacao, int lado) {
+    if (!posicaoValidaGenerica(linha, coluna, orientacao, lado)) {
+        return POSICIONAMENTO_INVALIDO;
+    }
+    if (verificarSobreposicaoGenerica(celulas, linha, coluna, orientacao, lado)) {
+        return POSICIONAMENTO_SOBREPOSTO;
+    }
+    
+    int indices[TAMANHO_NAVIO];
+    calcularPosicaoNavioGenerica(linha, coluna, orientacao, indices, lado);
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        celulas[indices[i]] = NAVIO;
+    }
+    return POSICIONAMENTO_OK;
+}
+
+static int aplicarHabilidadeGenerica(uint8_t* celulas, TipoHabilidade tipo, int linha_origem,
+                                     int coluna_origem, int lado) {
+    const EstencilHabilidade* estencil = obterEstencil(tipo);
+    int escritas = 0;
+    
+    if (!origemAlcancaTabuleiro(linha_origem, coluna_origem, TAMANHO_HABILIDADE / 2, lado, lado)) {
+        return 0;
+    }
+    for (int f = 0; f < estencil->num_faixas; f++) {
+        const FaixaEstencil* faixa = &estencil->faixas[f];
+        int linha = linha_origem + faixa->deslocamento_linha;
+        if (linha < 0 || linha >= lado) {
+            continue;
+        }
+        
+        int coluna_inicio = coluna_origem + faixa->coluna_inicio;
+        int coluna_fim = coluna_origem + faixa->coluna_fim;
+        if (coluna_inicio < 0) {
+            coluna_inicio = 0;
+        }
+        if (coluna_fim > lado - 1) {
+            coluna_fim = lado - 1;
+        }
+        escritas += marcarFaixaDensa(celulas + (size_t) linha * (size_t) lado, coluna_inicio, coluna_fim);
+    }
+    return escritas;
+}
+
+static const MotorTabuleiro motoresEspecializados[] = {
+    MOTOR_TABULEIRO(10),
+    MOTOR_TABULEIRO(16),
+    MOTOR_TABULEIRO(64)
+};
+
+static const MotorTabuleiro motorGenerico = {
+    0, "generico", inicializarTabuleiroGenerico, posicaoValidaGenerica, calcularPosicaoNavioGenerica,
+    verificarSobreposicaoGenerica, posicionarNavioGenerico, aplicarHabilidadeGenerica
+};
+
+// Função para escolher o motor de um lado: o especializado, se existir, ou o genérico
+const MotorTabuleiro* obterMotorTabuleiro(int lado) {
+    for (size_t m = 0; m < sizeof(motoresEspecializados) / sizeof(motoresEspecializados[0]); m++) {
+        if (motoresEspecializados[m].lado == lado) {
+            return &motoresEspecializados[m];
+        }
+    }
+    return &motorGenerico;
+}
+
+// Função para criar um tabuleiro denso só com água; motor pode ser NULL para escolher pelo lado
+bool criarTabuleiroDenso(TabuleiroDenso* tabuleiro, int lado, const MotorTabuleiro* motor) {
+    tabuleiro->lado = lado;
+    tabuleiro->motor = motor != NULL ? motor : obterMotorTabuleiro(lado);
+    tabuleiro->celulas = alocarMemoria((size_t) lado * (size_t) lado);
+    if (tabuleiro->celulas == NULL) {
+        return false;
+    }
+    tabuleiro->motor->inicializar(tabuleiro->celulas, lado);
+    return true;
+}
+
+void destruirTabuleiroDenso(TabuleiroDenso* tabuleiro) {
+    free(tabuleiro->celulas);
+    tabuleiro->celulas = NULL;
+}
+
+ResultadoPosicionamento posicionarNavioDenso(TabuleiroDenso* tabuleiro, Navio navio) {
+    return tabuleiro->motor->posicionarNavio(tabuleiro->celulas, navio.linha, navio.coluna, navio.orientacao,
+                                             tabuleiro->lado);
+}
+
+int aplicarHabilidadeDenso(TabuleiroDenso* tabuleiro, const HabilidadeEspecial* habilidade) {
+    return tabuleiro->motor->aplicarHabilidade(tabuleiro->celulas, habilidade->tipo, habilidade->linha_origem,
+                                               habilidade->coluna_origem, tabuleiro->lado);
+}
+
+// =====================================================================
+// COBERTURA EM LOTE DE HABILIDADES (ARRAYS DE DIFERENÇAS)
+// =====================================================================
+
+// Em vez de carimbar cada habilidade célula por célula, cada uma deixa só duas marcas por
+// coluna afetada (+1 na primeira linha, -1 logo depois da última). Uma soma acumulada de
+// cima para baixo transforma as marcas na contagem de habilidades que cobrem cada célula.
+// O custo passa de habilidades x células do padrão para habilidades x colunas do padrão,
+// mais uma única varredura do tabuleiro, que o compilador vetoriza por ser linha a linha.
+
+// Faixa contínua de células afetadas em uma coluna da habilidade, relativa ao centro
+typedef struct {
+    signed char deslocamento_coluna;
+    signed char linha_inicio;
+    signed char linha_fim;
+} FaixaVertical;
+
+// Estêncil por colunas: o mesmo padrão de EstencilHabilidade, transposto
+typedef struct {
+    int num_faixas;
+    FaixaVertical faixas[MAX_FAIXAS_ESTENCIL];
+} EstencilVertical;
+
+static EstencilVertical estenceisVerticais[3];
+static pthread_once_t estenceisVerticaisUnicos = PTHREAD_ONCE_INIT;
+
+// Função para compilar uma matriz de habilidade em faixas por coluna
+void compilarEstencilVertical(int matriz[TAMANHO_HABILIDADE][TAMANHO_HABILIDADE], EstencilVertical* estencil) {
+    int centro = TAMANHO_HABILIDADE / 2;
+    
+    estencil->num_faixas = 0;
+    for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
+        int i = 0;
+        while (i < TAMANHO_HABILIDADE) {
+            if (matriz[i][j] != 1) {
+                i++;
+                continue;
+            }
+            
+            int inicio = i;
+            while (i < TAMANHO_HABILIDADE && matriz[i][j] == 1) {
+                i++;
+            }
+            
+            FaixaVertical* faixa = &estencil->faixas[estencil->num_faixas++];
+            faixa->deslocamento_coluna = (signed char) (j - centro);
+            faixa->linha_inicio = (signed char) (inicio - centro);
+            faixa->linha_fim = (signed char) (i - 1 - centro);
+        }
+    }
+}
+
+// Função para compilar os estênceis por colunas de todas as habilidades
+static void montarEstenceisVerticais(void) {
+    inicializarEstenceis();
+    for (int t = CONE; t <= OCTAEDRO; t++) {
+        compilarEstencilVertical(matrizesHabilidade[t], &estenceisVerticais[t]);
+    }
+}
+
+// Função para obter o estêncil por colunas de um tipo de habilidade
+const EstencilVertical* obterEstencilVertical(TipoHabilidade tipo) {
+    pthread_once(&estenceisVerticaisUnicos, montarEstenceisVerticais);
+    return &estenceisVerticais[tipo];
+}
+
+// Função para calcular, em um tabuleiro linhas x colunas, quantas habilidades cobrem cada célula.
+// 'cobertura' recebe linhas * colunas contadores em ordem de linhas. O próprio vetor de saída
+// guarda as marcas de diferença, então nenhuma memória extra é usada. As contas são módulo 2^32,
+// o que torna as marcas negativas intermediárias inofensivas.
+void calcularCoberturaLote(const HabilidadeEspecial* habilidades, long num_habilidades,
+                           int linhas, int colunas, uint32_t* cobertura) {
+    memset(cobertura, 0, (size_t) linhas * colunas * sizeof(uint32_t));
+    
+    // Fase 1: duas marcas por faixa vertical, recortadas nas bordas do tabuleiro
+    for (long h = 0; h < num_habilidades; h++) {
+        const HabilidadeEspecial* habilidade = &habilidades[h];
+        const EstencilVertical* estencil = obterEstencilVertical(habilidade->tipo);
+        if (!origemAlcancaTabuleiro(habilidade->linha_origem, habilidade->coluna_origem, TAMANHO_HABILIDADE / 2,
+                                    linhas, colunas)) {
+            continue;
+        }
+        
+        for (int f = 0; f < estencil->num_faixas; f++) {
+            const FaixaVertical* faixa = &estencil->faixas[f];
+            int coluna = habilidade->coluna_origem + faixa->deslocamento_coluna;
+            if (coluna < 0 || coluna >= colunas) {
+                continue;
+            }
+            
+            int linha_inicio = habilidade->linha_origem + faixa->linha_inicio;
+            int linha_fim = habilidade->linha_origem + faixa->linha_fim;
+            if (linha_inicio < 0) {
+                linha_inicio = 0;
+            }
+            if (linha_fim > linhas - 1) {
+                linha_fim = linhas - 1;
+            }
+            if (linha_inicio > linha_fim) {
+                continue;
+            }
+            
+            cobertura[(size_t) linha_inicio * colunas + coluna] += 1;
+            // A marca de saída só existe se a faixa termina antes da última linha
+            if (linha_fim + 1 < linhas) {
+                cobertura[(size_t) (linha_fim + 1) * colunas + coluna] -= 1;
+            }
+        }
+    }
+    
+    // Fase 2: soma acumulada por coluna, feita linha a linha (laço interno contíguo e vetorizável)
+    for (int linha = 1; linha < linhas; linha++) {
+        const uint32_t* restrict anterior = cobertura + (size_t) (linha - 1) * colunas;
+        uint32_t* restrict atual = cobertura + (size_t) linha * colunas;
+        for (int coluna = 0; coluna < colunas; coluna++) {
+            atual[coluna] += anterior[coluna];
+        }
+    }
+}
+
+// =====================================================================
+// FORMAS DE HABILIDADE PERSONALIZADAS (CARREGADAS DE ARQUIVO)
+// =====================================================================
+
+// Formato do arquivo de formas (texto):
+//   forma NOME RAIO [ROTACAO]     ROTACAO em graus no sentido horário: 0, 90, 180 ou 270
+//   seguido de 2 * RAIO + 1 linhas com 2 * RAIO + 1 caracteres cada:
+//     '.' ou '0' = fora da forma, '#' = intensidade 1, '1'..'9' = intensidade
+// Linhas vazias ou iniciadas por '#' entre as formas são ignoradas.
+//
+// Cada forma é compilada, na carga, num kernel com as faixas horizontais (para carimbar) e verticais
+// (para marcas de diferença, como na cobertura em lote). Linhas com faixas idênticas, comuns em formas
+// simétricas, apontam para a mesma lista. Formas densas (faixas verticais longas) são acumuladas com
+// marcas de diferença; formas esparsas são carimbadas célula a célula. As formas padrão passam pelo
+// mesmo compilador, então uma forma nova custa o mesmo que uma padrão do mesmo tamanho.
+
+#define MAX_RAIO_FORMA 63
+#define MAX_FORMAS_CATALOGO 64
+#define MAX_NOME_FORMA 32
+
+// Faixa de células com a mesma intensidade, relativa ao centro
+typedef struct {
+    int16_t inicio;
+    int16_t fim;
+    uint16_t intensidade;
+} FaixaForma;
+
+// Onde começam, na lista de faixas, as faixas de uma linha (ou coluna) da forma
+typedef struct {
+    int primeira;
+    int quantidade;
+} TrechoForma;
+
+typedef enum {
+    APLICACAO_CARIMBO,
+    APLICACAO_DIFERENCAS
+} EstrategiaForma;
+
+typedef struct {
+    char nome[MAX_NOME_FORMA];
+    int raio;
+    int num_celulas;
+    int num_faixas_linhas;       // Faixas horizontais somando todas as linhas (trabalho de carimbar)
+    int num_faixas_colunas;      // Faixas verticais somando todas as colunas (marcas de diferença / 2)
+    int num_faixas_distintas;    // Faixas realmente guardadas depois de compartilhar linhas e colunas iguais
+    EstrategiaForma estrategia;
+    TrechoForma* linhas;         // 2 * raio + 1 trechos, do deslocamento -raio ao +raio
+    TrechoForma* colunas;
+    FaixaForma* faixas;
+} KernelForma;
+
+typedef struct {
+    KernelForma formas[MAX_FORMAS_CATALOGO];
+    int num_formas;
+} CatalogoFormas;
+
+// Aplicação de uma forma do catálogo com origem em (linha, coluna)
+typedef struct {
+    int forma;
+    int linha;
+    int coluna;
+} AplicacaoForma;
+
+// Função para girar uma grade quadrada 90 graus no sentido horário, de 'origem' para 'destino'
+static void girarGradeForma(const uint8_t* origem, uint8_t* destino, int lado) {
+    for (int i = 0; i < lado; i++) {
+        for (int j = 0; j < lado; j++) {
+            destino[i * lado + j] = origem[(lado - 1 - j) * lado + i];
+        }
+    }
+}
+
+// Função para extrair as faixas de uma linha da grade (passo 1) ou de uma coluna (passo = lado).
+// Se outra linha já produziu exatamente as mesmas faixas, reaproveita as dela.
+static TrechoForma extrairFaixasForma(const uint8_t* inicio, int passo, int lado, FaixaForma* faixas,
+                                      int* num_faixas, const TrechoForma* anteriores, int num_anteriores) {
+    TrechoForma trecho = {*num_faixas, 0};
+    int raio = lado / 2;
+    
+    for (int k = 0; k < lado; ) {
+        uint8_t intensidade = inicio[k * passo];
+        if (intensidade == 0) {
+            k++;
+            continue;
+        }
+        int comeco = k;
+        while (k < lado && inicio[k * passo] == intensidade) {
+            k++;
+        }
+        FaixaForma faixa = {(int16_t) (comeco - raio), (int16_t) (k - 1 - raio), intensidade};
+        faixas[trecho.primeira + trecho.quantidade++] = faixa;
+    }
+    
+    for (int a = 0; a < num_anteriores; a++) {
+        if (anteriores[a].quantidade == trecho.quantidade && trecho.quantidade > 0 &&
+            memcmp(&faixas[anteriores[a].primeira], &faixas[trecho.primeira],
+                   sizeof(FaixaForma) * (size_t) trecho.quantidade) == 0) {
+            return anteriores[a];
+        }
+    }
+    *num_faixas += trecho.quantidade;
+    return trecho;
+}
+
+// Função para compilar uma grade (2 * raio + 1)^2 de intensidades num kernel
+bool compilarKernelForma(const uint8_t* grade, int raio, const char* nome, KernelForma* kernel) {
+    int lado = 2 * raio + 1;
+    
+    memset(kernel, 0, sizeof(*kernel));
+    snprintf(kernel->nome, sizeof(kernel->nome), "%s", nome);
+    kernel->raio = raio;
+    kernel->linhas = alocarMemoria(sizeof(TrechoForma) * (size_t) lado);
+    kernel->colunas = alocarMemoria(sizeof(TrechoForma) * (size_t) lado);
+    // Pior caso: cada célula é uma faixa, tanto nas linhas quanto nas colunas
+    kernel->faixas = alocarMemoria(sizeof(FaixaForma) * (size_t) lado * (size_t) lado * 2);
+    if (kernel->linhas == NULL || kernel->colunas == NULL || kernel->faixas == NULL) {
+        free(kernel->linhas);
+        free(kernel->colunas);
+        free(kernel->faixas);
+        return false;
+    }
+    
+    int num_faixas = 0;
+    for (int i = 0; i < lado; i++) {
+        kernel->linhas[i] = extrairFaixasForma(grade + i * lado, 1, lado, kernel->faixas, &num_faixas,
+                                               kernel->linhas, i);
+        kernel->num_faixas_linhas += kernel->linhas[i].quantidade;
+        for (int j = 0; j < lado; j++) {
+            kernel->num_celulas += grade[i * lado + j] != 0;
+        }
+    }
+    for (int j = 0; j < lado; j++) {
+        kernel->colunas[j] = extrairFaixasForma(grade + j, lado, lado, kernel->faixas, &num_faixas,
+                                                kernel->colunas, j);
+        kernel->num_faixas_colunas += kernel->colunas[j].quantidade;
+    }
+    kernel->num_faixas_distintas = num_faixas;
+    
+    // Marcas de diferença custam 2 escritas por faixa vertical; carimbar custa 1 por célula
+    kernel->estrategia = kernel->num_celulas >= 2 * kernel->num_faixas_colunas ? APLICACAO_DIFERENCAS
+                                                                              : APLICACAO_CARIMBO;
+    FaixaForma* justas = realocarMemoria(kernel->faixas, sizeof(FaixaForma) * (size_t) (num_faixas > 0 ? num_faixas : 1));
+    if (justas != NULL) {
+        kernel->faixas = justas;
+    }
+    return true;
+}
+
+void destruirKernelForma(KernelForma* kernel) {
+    free(kernel->linhas);
+    free(kernel->colunas);
+    free(kernel->faixas);
+    memset(kernel, 0, sizeof(*kernel));
+}
+
+void liberarCatalogoFormas(CatalogoFormas* catalogo) {
+    for (int f = 0; f < catalogo->num_formas; f++) {
+        destruirKernelForma(&catalogo->formas[f]);
+    }
+    catalogo->num_formas = 0;
+}
+
+// Função para obter o índice de uma forma pelo nome (-1 se não existe)
+int buscarFormaCatalogo(const CatalogoFormas* catalogo, const char* nome) {
+    for (int f = 0; f < catalogo->num_formas; f++) {
+        if (strcmp(catalogo->formas[f].nome, nome) == 0) {
+            return f;
+        }
+    }
+    return -1;
+}
+
+// Função para acrescentar ao catálogo as formas padrão (CONE, CRUZ e OCTAEDRO)
+bool adicionarFormasPadrao(CatalogoFormas* catalogo) {
+    static const char* nomes[3] = {"CONE", "CRUZ", "OCTAEDRO"};
+    uint8_t grade[TAMANHO_HABILIDADE * TAMANHO_HABILIDADE];
+    
+    inicializarEstenceis();
+    for (int tipo = CONE; tipo <= OCTAEDRO; tipo++) {
+        if (catalogo->num_formas == MAX_FORMAS_CATALOGO) {
+            return false;
+        }
+        for (int i = 0; i < TAMANHO_HABILIDADE; i++) {
+            for (int j = 0; j < TAMANHO_HABILIDADE; j++) {
+                grade[i * TAMANHO_HABILIDADE + j] = (uint8_t) matrizesHabilidade[tipo][i][j];
+            }
+        }
+        if (!compilarKernelForma(grade, TAMANHO_HABILIDADE / 2, nomes[tipo], &catalogo->formas[catalogo->num_formas])) {
+            return false;
+        }
+        catalogo->num_formas++;
+    }
+    return true;
+}
+
+// Função para carregar as formas de um arquivo para o catálogo.
+// Em erro, linha_erro recebe a linha do arquivo com problema (0 se faltou memória ou espaço no catálogo).
+bool carregarFormasHabilidade(FILE* entrada, CatalogoFormas* catalogo, int* linha_erro) {
+    char* linha = NULL;
+    size_t capacidade = 0;
+    uint8_t* grade = NULL;
+    int numero_linha = 0;
+    bool sucesso = true;
+    
+    *linha_erro = 0;
+    while (sucesso && getline(&linha, &capacidade, entrada) != -1) {
+        numero_linha++;
+        if (linha[0] == '#' || linha[0] == '\n' || linha[0] == '\r' || linha[0] == '\0') {
+            continue;
+        }
+        
+        char nome[MAX_NOME_FORMA];
+        int raio, rotacao = 0;
+        int campos = sscanf(linha, "forma %31s %d %d", nome, &raio, &rotacao);
+        if (campos < 2 || raio < 0 || raio > MAX_RAIO_FORMA || rotacao % 90 != 0 ||
+            buscarFormaCatalogo(catalogo, nome) >= 0) {
+            *linha_erro = numero_linha;
+            sucesso = false;
+            break;
+        }
+        if (catalogo->num_formas == MAX_FORMAS_CATALOGO) {
+            sucesso = false;
+            break;
+        }
+        
+        // A grade e a área auxiliar das rotações vêm numa única alocação
+        int lado = 2 * raio + 1;
+        grade = alocarMemoriaZerada(2 * (size_t) lado, (size_t) lado);
+        if (grade == NULL) {
+            sucesso = false;
+            break;
+        }
+        for (int i = 0; i < lado && sucesso; i++) {
+            numero_linha++;
+            if (getline(&linha, &capacidade, entrada) == -1) {
+                *linha_erro = numero_linha;
+                sucesso = false;
+                break;
+            }
+            for (int j = 0; j < lado; j++) {
+                char c = linha[j];
+                if (c == '#') {
+                    grade[i * lado + j] = 1;
+                } else if (c >= '1' && c <= '9') {
+                    grade[i * lado + j] = (uint8_t) (c - '0');
+                } else if (c != '.' && c != '0') {
+                    *linha_erro = numero_linha;
+                    sucesso = false;
+                    break;
+                }
+            }
+        }
+        
+        if (sucesso) {
+            uint8_t* atual = grade;
+            uint8_t* auxiliar = grade + (size_t) lado * (size_t) lado;
+            for (int quartos = ((rotacao / 90) % 4 + 4) % 4; quartos > 0; quartos--) {
+                girarGradeForma(atual, auxiliar, lado);
+                uint8_t* girada = auxiliar;
+                auxiliar = atual;
+                atual = girada;
+            }
+            sucesso = compilarKernelForma(atual, raio, nome, &catalogo->formas[catalogo->num_formas]);
+            catalogo->num_formas += sucesso;
+        }
+        free(grade);
+        grade = NULL;
+    }
+    
+    free(linha);
+    return sucesso;
+}
+
+// Função para aplicar uma forma à matriz 10x10 (sem mensagens), sem sobrescrever navios.
+// Intensidades não cabem na matriz: toda célula alcançada vira AREA_EFEITO. Devolve as células escritas.
+int aplicarFormaMatriz(int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO], const KernelForma* kernel,
+                       int linha_origem, int coluna_origem, EstatisticasTabuleiro* estatisticas) {
+    int escritas = 0;
+    
+    if (!origemAlcancaTabuleiro(linha_origem, coluna_origem, kernel->raio, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return 0;
+    }
+    for (int d = -kernel->raio; d <= kernel->raio; d++) {
+        int linha = linha_origem + d;
+        if (linha < 0 || linha >= TAMANHO_TABULEIRO) {
+            continue;
+        }
+        
+        const TrechoForma* trecho = &kernel->linhas[d + kernel->raio];
+        for (int f = 0; f < trecho->quantidade; f++) {
+            const FaixaForma* faixa = &kernel->faixas[trecho->primeira + f];
+            int coluna_inicio = coluna_origem + faixa->inicio < 0 ? 0 : coluna_origem + faixa->inicio;
+            int coluna_fim = coluna_origem + faixa->fim > TAMANHO_TABULEIRO - 1 ? TAMANHO_TABULEIRO - 1
+                                                                                : coluna_origem + faixa->fim;
+            for (int coluna = coluna_inicio; coluna <= coluna_fim; coluna++) {
+                if (tabuleiro[linha][coluna] != NAVIO) {
+                    if (estatisticas != NULL) {
+                        contabilizarCelula(estatisticas, linha, coluna, tabuleiro[linha][coluna], AREA_EFEITO);
+                    }
+                    tabuleiro[linha][coluna] = AREA_EFEITO;
+                    escritas++;
+                }
+            }
+        }
+    }
+    return escritas;
+}
+
+// Função para aplicar uma forma a um tabuleiro denso, sem sobrescrever navios; devolve as células escritas
+int aplicarFormaDenso(TabuleiroDenso* tabuleiro, const KernelForma* kernel, int linha_origem, int coluna_origem) {
+    int lado = tabuleiro->lado;
+    int escritas = 0;
+    
+    if (!origemAlcancaTabuleiro(linha_origem, coluna_origem, kernel->raio, lado, lado)) {
+        return 0;
+    }
+    for (int d = -kernel->raio; d <= kernel->raio; d++) {
+        int linha = linha_origem + d;
+        if (linha < 0 || linha >= lado) {
+            continue;
+        }
+        
+        uint8_t* celulas = tabuleiro->celulas + (size_t) linha * (size_t) lado;
+        const TrechoForma* trecho = &kernel->linhas[d + kernel->raio];
+        for (int f = 0; f < trecho->quantidade; f++) {
+            const FaixaForma* faixa = &kernel->faixas[trecho->primeira + f];
+            int coluna_inicio = coluna_origem + faixa->inicio < 0 ? 0 : coluna_origem + faixa->inicio;
+            int coluna_fim = coluna_origem + faixa->fim > lado - 1 ? lado - 1 : coluna_origem + faixa->fim;
+            escritas += marcarFaixaDensa(celulas, coluna_inicio, coluna_fim);
+        }
+    }
+    return escritas;
+}
+
+// Função para somar, em cada célula de um tabuleiro linhas x colunas, a intensidade de todas as
+// aplicações que a alcançam. Formas densas deixam marcas de diferença por coluna, resolvidas por uma
+// única soma acumulada; formas esparsas são carimbadas depois, direto no resultado.
+void acumularFormasLote(const CatalogoFormas* catalogo, const AplicacaoForma* aplicacoes, long num_aplicacoes,
+                        int linhas, int colunas, uint32_t* intensidade) {
+    memset(intensidade, 0, (size_t) linhas * colunas * sizeof(uint32_t));
+    
+    // Fase 1: marcas de diferença das formas densas
+    bool alguma_densa = false;
+    for (long a = 0; a < num_aplicacoes; a++) {
+        const KernelForma* kernel = &catalogo->formas[aplicacoes[a].forma];
+        if (kernel->estrategia != APLICACAO_DIFERENCAS ||
+            !origemAlcancaTabuleiro(aplicacoes[a].linha, aplicacoes[a].coluna, kernel->raio, linhas, colunas)) {
+            continue;
+        }
+        alguma_densa = true;
+        
+        for (int d = -kernel->raio; d <= kernel->raio; d++) {
+            int coluna = aplicacoes[a].coluna + d;
+            if (coluna < 0 || coluna >= colunas) {
+                continue;
+            }
+            
+            const TrechoForma* trecho = &kernel->colunas[d + kernel->raio];
+            for (int f = 0; f < trecho->quantidade; f++) {
+                const FaixaForma* faixa = &kernel->faixas[trecho->primeira + f];
+                int linha_inicio = aplicacoes[a].linha + faixa->inicio < 0 ? 0 : aplicacoes[a].linha + faixa->inicio;
+                int linha_fim = aplicacoes[a].linha + faixa->fim;
+                if (linha_fim > linhas - 1) {
+                    linha_fim = linhas - 1;
+                }
+                if (linha_inicio > linha_fim) {
+                    continue;
+                }
+                
+                intensidade[(size_t) linha_inicio * colunas + coluna] += faixa->intensidade;
+                if (linha_fim + 1 < linhas) {
+                    intensidade[(size_t) (linha_fim + 1) * colunas + coluna] -= faixa->intensidade;
+                }
+            }
+        }
+    }
+    
+    // Fase 2: soma acumulada por coluna, linha a linha
+    for (int linha = 1; alguma_densa && linha < linhas; linha++) {
+        const uint32_t* restrict anterior = intensidade + (size_t) (linha - 1) * colunas;
+        uint32_t* restrict atual = intensidade + (size_t) linha * colunas;
+        for (int coluna = 0; coluna < colunas; coluna++) {
+            atual[coluna] += anterior[coluna];
+        }
+    }
+    
+    // Fase 3: formas esparsas carimbadas por faixas horizontais
+    for (long a = 0; a < num_aplicacoes; a++) {
+        const KernelForma* kernel = &catalogo->formas[aplicacoes[a].forma];
+        if (kernel->estrategia != APLICACAO_CARIMBO ||
+            !origemAlcancaTabuleiro(aplicacoes[a].linha, aplicacoes[a].coluna, kernel->raio, linhas, colunas)) {
+            continue;
+        }
+        
+        for (int d = -kernel->raio; d <= kernel->raio; d++) {
+            int linha = aplicacoes[a].linha + d;
+            if (linha < 0 || linha >= linhas) {
+                continue;
+            }
+            
+            uint32_t* destino = intensidade + (size_t) linha * colunas;
+            const TrechoForma* trecho = &kernel->linhas[d + kernel->raio];
+            for (int f = 0; f < trecho->quantidade; f++) {
+                const FaixaForma* faixa = &kernel->faixas[trecho->primeira + f];
+                int coluna_inicio = aplicacoes[a].coluna + faixa->inicio < 0 ? 0 : aplicacoes[a].coluna + faixa->inicio;
+                int coluna_fim = aplicacoes[a].coluna + faixa->fim > colunas - 1 ? colunas - 1
+                                                                                 : aplicacoes[a].coluna + faixa->fim;
+                for (int coluna = coluna_inicio; coluna <= coluna_fim; coluna++) {
+                    destino[coluna] += faixa->intensidade;
+                }
+            }
+        }
+    }
+}
+
+// Função para exibir o resumo dos kernels do catálogo em CSV
+void exibirCatalogoFormas(const CatalogoFormas* catalogo, FILE* saida) {
+    fprintf(saida, "forma,raio,celulas,faixas_linhas,faixas_colunas,faixas_distintas,estrategia\n");
+    for (int f = 0; f < catalogo->num_formas; f++) {
+        const KernelForma* kernel = &catalogo->formas[f];
+        fprintf(saida, "%s,%d,%d,%d,%d,%d,%s\n", kernel->nome, kernel->raio, kernel->num_celulas,
+                kernel->num_faixas_linhas, kernel->num_faixas_colunas, kernel->num_faixas_distintas,
+                kernel->estrategia == APLICACAO_DIFERENCAS ? "diferencas" : "carimbo");
+    }
+}
+
+// =====================================================================
+// GERADOR DE FROTAS ALEATÓRIAS (REPRODUTÍVEL POR SEMENTE)
+// =====================================================================
+
+// Gerador pseudoaleatório xoshiro256**: rápido, com estado pequeno e sequência reproduzível
+typedef struct {
+    uint64_t estado[4];
+} GeradorAleatorio;
+
+// Função de mistura splitmix64, usada para expandir a semente no estado do gerador
+static inline uint64_t misturarSplitMix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+// Função para semear o gerador. Sementes e fluxos diferentes produzem sequências independentes,
+// o que permite gerar em paralelo e ainda reproduzir cada sequência isoladamente.
+void semearGerador(GeradorAleatorio* gerador, uint64_t semente, uint64_t fluxo) {
+    uint64_t x = semente ^ (fluxo * 0xD1B54A32D192ED03ULL);
+    for (int i = 0; i < 4; i++) {
+        gerador->estado[i] = misturarSplitMix64(&x);
+    }
+}
+
+static inline uint64_t rotacionarEsquerda(uint64_t valor, int bits) {
+    return (valor << bits) | (valor >> (64 - bits));
+}
+
+// Função para sortear o próximo número de 64 bits
+static inline uint64_t proximoAleatorio(GeradorAleatorio* gerador) {
+    uint64_t* s = gerador->estado;
+    uint64_t resultado = rotacionarEsquerda(s[1] * 5, 7) * 9;
+    uint64_t t = s[1] << 17;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rotacionarEsquerda(s[3], 45);
+    return resultado;
+}
+
+// Função para sortear um inteiro uniforme em [0, limite) sem viés (método multiplicativo de Lemire)
+static inline uint32_t aleatorioAte(GeradorAleatorio* gerador, uint32_t limite) {
+    uint64_t produto = (uint64_t) (uint32_t) (proximoAleatorio(gerador) >> 32) * limite;
+    uint32_t resto = (uint32_t) produto;
+    
+    if (resto < limite) {
+        uint32_t piso = -limite % limite;
+        while (resto < piso) {
+            produto = (uint64_t) (uint32_t) (proximoAleatorio(gerador) >> 32) * limite;
+            resto = (uint32_t) produto;
+        }
+    }
+    return (uint32_t) (produto >> 32);
+}
+
+// Posicionamento legal de um navio: já respeita posicaoValida e traz a máscara pronta
+typedef struct {
+    Mascara128 mascara;
+    unsigned char linha;
+    unsigned char coluna;
+    unsigned char orientacao;
+} PosicionamentoLegal;
+
+#define MAX_NAVIOS_FROTA 16
+#define MAX_TENTATIVAS_FROTA 1000000
+
+static PosicionamentoLegal posicionamentosLegais[4 * TOTAL_CELULAS];
+static int numPosicionamentosLegais = 0;
+static pthread_once_t posicionamentosLegaisUnicos = PTHREAD_ONCE_INIT;
+
+// Função para montar a tabela de todos os posicionamentos legais
+static void montarPosicionamentosLegais(void) {
+    int total = 0;
+    
+    inicializarTabelasBits();
+    for (int orientacao = HORIZONTAL; orientacao <= DIAGONAL_SECUNDARIA; orientacao++) {
+        for (int indice = 0; indice < TOTAL_CELULAS; indice++) {
+            if (!navioCabeBits[orientacao][indice]) {
+                continue;
+            }
+            PosicionamentoLegal* posicionamento = &posicionamentosLegais[total++];
+            posicionamento->mascara = mascarasNavio[orientacao][indice];
+            posicionamento->linha = (unsigned char) (indice / TAMANHO_TABULEIRO);
+            posicionamento->coluna = (unsigned char) (indice % TAMANHO_TABULEIRO);
+            posicionamento->orientacao = (unsigned char) orientacao;
+        }
+    }
+    numPosicionamentosLegais = total;
+}
+
+// Função para garantir que a tabela exista (montada uma única vez, mesmo com várias threads)
+void inicializarPosicionamentosLegais() {
+    pthread_once(&posicionamentosLegaisUnicos, montarPosicionamentosLegais);
+}
+
+// Função para gerar uma frota aleatória válida, uniforme entre todas as frotas possíveis.
+// Cada navio é sorteado entre os posicionamentos legais; se algum se sobrepõe, a frota inteira
+// é descartada (descartar só o navio tornaria a distribuição não uniforme).
+// Retorna o número de tentativas usadas, ou 0 se a frota não coube após MAX_TENTATIVAS_FROTA.
+int gerarFrotaAleatoria(GeradorAleatorio* gerador, int num_navios, Navio navios[], TabuleiroBits* tabuleiro) {
+    inicializarPosicionamentosLegais();
+    
+    for (int tentativa = 1; tentativa <= MAX_TENTATIVAS_FROTA; tentativa++) {
+        Mascara128 ocupado = mascaraVazia();
+        int colocados = 0;
+        
+        while (colocados < num_navios) {
+            const PosicionamentoLegal* sorteado =
+                &posicionamentosLegais[aleatorioAte(gerador, (uint32_t) numPosicionamentosLegais)];
+            if (mascaraSeCruzam(ocupado, sorteado->mascara)) {
+                break;
+            }
+            
+            ocupado = mascaraOu(ocupado, sorteado->mascara);
+            navios[colocados].linha = sorteado->linha;
+            navios[colocados].coluna = sorteado->coluna;
+            navios[colocados].orientacao = sorteado->orientacao;
+            navios[colocados].nome = "Navio aleatório";
+            colocados++;
+        }
+        
+        if (colocados == num_navios) {
+            if (tabuleiro != NULL) {
+                tabuleiro->navios = ocupado;
+                tabuleiro->efeito = mascaraVazia();
+            }
+            return tentativa;
+        }
+    }
+    return 0;
+}
+
+// Função para escrever uma frota no formato do modo em lote (N:linha,coluna,orientacao ...)
+static char* escreverFrotaLote(char* destino, const Navio navios[], int num_navios) {
+    static const char codigos_orientacao[] = "HVPS";
+    
+    for (int i = 0; i < num_navios; i++) {
+        if (i > 0) {
+            *destino++ = ' ';
+        }
+        *destino++ = 'N';
+        *destino++ = ':';
+        destino += sprintf(destino, "%d,%d,", navios[i].linha, navios[i].coluna);
+        *destino++ = codigos_orientacao[navios[i].orientacao];
+    }
+    *destino++ = '\n';
+    return destino;
+}
+
+// Função para gerar várias frotas e gravá-las no formato do modo em lote
+bool executarGeradorFrotas(long quantidade, uint64_t semente, int num_navios, FILE* saida) {
+    static char buffer_saida[1 << 16];
+    char linha[MAX_NAVIOS_FROTA * 16 + 2];
+    Navio navios[MAX_NAVIOS_FROTA];
+    GeradorAleatorio gerador;
+    
+    if (num_navios < 1 || num_navios > MAX_NAVIOS_FROTA) {
+        fprintf(stderr, "ERRO: a frota deve ter entre 1 e %d navios\n", MAX_NAVIOS_FROTA);
+        return false;
+    }
+    
+    setvbuf(saida, buffer_saida, _IOFBF, sizeof(buffer_saida));
+    semearGerador(&gerador, semente, 0);
+    
+    for (long i = 0; i < quantidade; i++) {
+        if (gerarFrotaAleatoria(&gerador, num_navios, navios, NULL) == 0) {
+            fprintf(stderr, "ERRO: não foi possível posicionar %d navios\n", num_navios);
+            return false;
+        }
+        char* fim = escreverFrotaLote(linha, navios, num_navios);
+        fwrite(linha, 1, (size_t) (fim - linha), saida);
+    }
+    
+    fflush(saida);
+    return true;
+}
+
+// =====================================================================
+// MIRA POR DENSIDADE DE PROBABILIDADE (MONTE CARLO EM PARALELO)
+// =====================================================================
+
+// Tiros já disparados contra um tabuleiro: acertos (navio) e erros (água)
+typedef struct {
+    Mascara128 acertos;
+    Mascara128 erros;
+} EstadoTiros;
+
+// Resultado da escolha de alvo
+typedef struct {
+    int linha;
+    int coluna;
+    double probabilidade;   // Fração das amostras com navio na célula escolhida
+    long amostras;          // Frotas consistentes com os tiros que foram amostradas
+    long tentativas;        // Frotas sorteadas no total (incluindo as descartadas)
+} ResultadoMira;
+
+#define MAX_TENTATIVAS_POR_AMOSTRA 64
+#define MAX_NOS_COBERTURA_ACERTOS 64
+
+// Candidatos que ainda não passam por nenhum erro, com o índice invertido célula -> candidatos.
+// Reaproveitado entre tiros da mesma partida: novos erros só removem candidatos.
+typedef struct {
+    PosicionamentoLegal candidatos[4 * TOTAL_CELULAS];
+    int num_candidatos;
+    int inicio_cobertura[TOTAL_CELULAS + 1];   // Para cada célula, onde começam em cobertura os candidatos que a ocupam
+    int cobertura[4 * TOTAL_CELULAS * TAMANHO_NAVIO];
+    Mascara128 erros;                          // Erros já descontados dos candidatos
+} ContextoMira;
+
+// Dados compartilhados (somente leitura) e acumuladores próprios de cada thread
+typedef struct {
+    const ContextoMira* contexto;
+    const EstadoTiros* tiros;
+    int num_navios;
+    double prazo;
+    long max_amostras;
+    uint64_t semente;
+    int indice_thread;
+    
+    // Resultados da thread, gravados uma única vez ao final e mesclados pela thread principal
+    uint32_t contagens[TOTAL_CELULAS];
+    long amostras;
+    long tentativas;
+} TrabalhoMira;
+
+// Função para iniciar um estado de tiros vazio
+void inicializarEstadoTiros(EstadoTiros* tiros) {
+    tiros->acertos = mascaraVazia();
+    tiros->erros = mascaraVazia();
+}
+
+// Função para montar o índice invertido célula -> candidatos (contagem, prefixo e preenchimento)
+static void indexarCoberturaMira(ContextoMira* contexto) {
+    int preenchidos[TOTAL_CELULAS] = {0};
+    
+    memset(contexto->inicio_cobertura, 0, sizeof(contexto->inicio_cobertura));
+    for (int i = 0; i < contexto->num_candidatos; i++) {
+        for (int k = 0; k < TAMANHO_NAVIO; k++) {
+            int linha_atual, coluna_atual;
+            calcularPosicaoNavio(contexto->candidatos[i].linha, contexto->candidatos[i].coluna,
+                                 contexto->candidatos[i].orientacao, k, &linha_atual, &coluna_atual);
+            contexto->inicio_cobertura[linha_atual * TAMANHO_TABULEIRO + coluna_atual + 1]++;
+        }
+    }
+    for (int c = 0; c < TOTAL_CELULAS; c++) {
+        contexto->inicio_cobertura[c + 1] += contexto->inicio_cobertura[c];
+    }
+    for (int i = 0; i < contexto->num_candidatos; i++) {
+        for (int k = 0; k < TAMANHO_NAVIO; k++) {
+            int linha_atual, coluna_atual;
+            calcularPosicaoNavio(contexto->candidatos[i].linha, contexto->candidatos[i].coluna,
+                                 contexto->candidatos[i].orientacao, k, &linha_atual, &coluna_atual);
+            int c = linha_atual * TAMANHO_TABULEIRO + coluna_atual;
+            contexto->cobertura[contexto->inicio_cobertura[c] + preenchidos[c]++] = i;
+        }
+    }
+}
+
+// Função para preparar um contexto de mira sem nenhum erro conhecido (todos os posicionamentos legais)
+void prepararContextoMira(ContextoMira* contexto) {
+    inicializarPosicionamentosLegais();
+    memcpy(contexto->candidatos, posicionamentosLegais, sizeof(PosicionamentoLegal) * numPosicionamentosLegais);
+    contexto->num_candidatos = numPosicionamentosLegais;
+    contexto->erros = mascaraVazia();
+    indexarCoberturaMira(contexto);
+}
+
+// Função para descontar do contexto os erros que ele ainda não viu.
+// Os candidatos só diminuem, então basta compactar os que passam pelos erros novos;
+// sem erros novos, nada é refeito.
+static void atualizarContextoMira(ContextoMira* contexto, Mascara128 erros) {
+    Mascara128 novos = mascaraENao(erros, contexto->erros);
+    if (mascaraEhVazia(novos)) {
+        return;
+    }
+    
+    int restantes = 0;
+    for (int i = 0; i < contexto->num_candidatos; i++) {
+        if (!mascaraSeCruzam(contexto->candidatos[i].mascara, novos)) {
+            contexto->candidatos[restantes++] = contexto->candidatos[i];
+        }
+    }
+    contexto->erros = mascaraOu(contexto->erros, novos);
+    if (restantes != contexto->num_candidatos) {
+        contexto->num_candidatos = restantes;
+        indexarCoberturaMira(contexto);
+    }
+}
+
+// Função para cobrir os acertos ainda pendentes com navios que não se cruzam (busca em profundidade).
+// Os candidatos de cada acerto são visitados em ordem aleatória e a busca para no primeiro arranjo
+// que cobre todos; *orcamento limita os nós visitados. Retorna quantos navios sobraram, ou -1.
+static int cobrirAcertosPendentes(GeradorAleatorio* gerador, const TrabalhoMira* trabalho,
+                                  Mascara128* ocupado, int navios_livres, int* orcamento) {
+    const ContextoMira* contexto = trabalho->contexto;
+    Mascara128 pendentes = mascaraENao(trabalho->tiros->acertos, *ocupado);
+    
+    if (mascaraEhVazia(pendentes)) {
+        return navios_livres;
+    }
+    if (navios_livres == 0 || --*orcamento < 0) {
+        return -1;
+    }
+    
+    int celula = pendentes.baixo != 0 ? __builtin_ctzll(pendentes.baixo) : 64 + __builtin_ctzll(pendentes.alto);
+    const PosicionamentoLegal* opcoes[4 * TAMANHO_NAVIO];
+    int num_opcoes = 0;
+    for (int k = contexto->inicio_cobertura[celula]; k < contexto->inicio_cobertura[celula + 1]; k++) {
+        const PosicionamentoLegal* candidato = &contexto->candidatos[contexto->cobertura[k]];
+        if (!mascaraSeCruzam(*ocupado, candidato->mascara)) {
+            opcoes[num_opcoes++] = candidato;
+        }
+    }
+    
+    // Embaralha sob demanda: cada opção sorteada troca de lugar com a última ainda não tentada
+    for (int restantes = num_opcoes; restantes > 0 && *orcamento >= 0; restantes--) {
+        int escolhida = (int) aleatorioAte(gerador, (uint32_t) restantes);
+        const PosicionamentoLegal* candidato = opcoes[escolhida];
+        opcoes[escolhida] = opcoes[restantes - 1];
+        
+        Mascara128 anterior = *ocupado;
+        *ocupado = mascaraOu(*ocupado, candidato->mascara);
+        int sobra = cobrirAcertosPendentes(gerador, trabalho, ocupado, navios_livres - 1, orcamento);
+        if (sobra >= 0) {
+            return sobra;
+        }
+        *ocupado = anterior;
+    }
+    return -1;
+}
+
+// Função para sortear uma frota consistente com os tiros (false se a tentativa foi descartada).
+// Acertos ainda não cobertos são resolvidos primeiro, com navios que passam por eles; só então os
+// navios restantes são sorteados livremente. Sem acertos, a amostra é uniforme; com acertos, é uma
+// aproximação que evita descartar quase todas as tentativas.
+static inline bool amostrarFrotaConsistente(GeradorAleatorio* gerador, const TrabalhoMira* trabalho,
+                                            Mascara128* ocupado) {
+    const ContextoMira* contexto = trabalho->contexto;
+    int orcamento = MAX_NOS_COBERTURA_ACERTOS;
+    
+    *ocupado = mascaraVazia();
+    int navios_livres = cobrirAcertosPendentes(gerador, trabalho, ocupado, trabalho->num_navios, &orcamento);
+    if (navios_livres < 0) {
+        return false;
+    }
+    
+    for (int i = 0; i < navios_livres; i++) {
+        const PosicionamentoLegal* sorteado =
+            &contexto->candidatos[aleatorioAte(gerador, (uint32_t) contexto->num_candidatos)];
+        if (mascaraSeCruzam(*ocupado, sorteado->mascara)) {
+            return false;
+        }
+        *ocupado = mascaraOu(*ocupado, sorteado->mascara);
+    }
+    return true;
+}
+
+// Função executada por cada thread: amostra até o prazo e acumula ocupação por célula
+static void* executarTrabalhoMira(void* argumento) {
+    TrabalhoMira* trabalho = argumento;
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, trabalho->semente, (uint64_t) trabalho->indice_thread + 1);
+    
+    // Acumula em variáveis locais: os TrabalhoMira das threads são vizinhos no mesmo vetor, e
+    // escrever neles a cada amostra faria as threads disputarem as mesmas linhas de cache
+    uint32_t contagens[TOTAL_CELULAS] = {0};
+    long amostras = 0;
+    long tentativas = 0;
+    
+    // Limita as tentativas para que tiros impossíveis de satisfazer não travem a busca
+    long max_tentativas = trabalho->max_amostras > LONG_MAX / MAX_TENTATIVAS_POR_AMOSTRA
+                          ? LONG_MAX : trabalho->max_amostras * MAX_TENTATIVAS_POR_AMOSTRA;
+    
+    while (amostras < trabalho->max_amostras && tentativas < max_tentativas) {
+        // Consulta o relógio só a cada lote de tentativas para não pesar no laço
+        if ((tentativas & 1023) == 0 && segundosMonotonicos() >= trabalho->prazo) {
+            break;
+        }
+        tentativas++;
+        
+        Mascara128 ocupado;
+        if (!amostrarFrotaConsistente(&gerador, trabalho, &ocupado)) {
+            continue;
+        }
+        
+        amostras++;
+        for (uint64_t bits = ocupado.baixo; bits != 0; bits &= bits - 1) {
+            contagens[__builtin_ctzll(bits)]++;
+        }
+        for (uint64_t bits = ocupado.alto; bits != 0; bits &= bits - 1) {
+            contagens[64 + __builtin_ctzll(bits)]++;
+        }
+    }
+    
+    memcpy(trabalho->contagens, contagens, sizeof(contagens));
+    trabalho->amostras = amostras;
+    trabalho->tentativas = tentativas;
+    return NULL;
+}
+
+// Função para obter o número de núcleos disponíveis
+int obterNumeroNucleos() {
+    long nucleos = sysconf(_SC_NPROCESSORS_ONLN);
+    return nucleos > 0 ? (int) nucleos : 1;
+}
+
+// Função para escolher a célula com maior chance de conter navio, dados os tiros até agora, usando um
+// contexto reaproveitado entre chamadas (os erros novos são descontados dele aqui).
+// As amostras são distribuídas entre num_threads threads até estourar orcamento_ms ou max_amostras.
+// contagens_saida (opcional) recebe a ocupação acumulada de cada célula.
+ResultadoMira escolherAlvoComContexto(ContextoMira* contexto, const EstadoTiros* tiros, int num_navios,
+                                      int num_threads, double orcamento_ms, long max_amostras, uint64_t semente,
+                                      uint32_t contagens_saida[TOTAL_CELULAS]) {
+    ResultadoMira resultado = {-1, -1, 0.0, 0, 0};
+    uint32_t contagens[TOTAL_CELULAS] = {0};
+    TrabalhoMira trabalho_unico;
+    pthread_t thread_unica;
+    
+    if (num_threads < 1) {
+        num_threads = obterNumeroNucleos();
+    }
+    atualizarContextoMira(contexto, tiros->erros);
+    
+    // Com uma thread só (caso das partidas simuladas) não há nada a alocar
+    TrabalhoMira* trabalhos = &trabalho_unico;
+    pthread_t* threads = &thread_unica;
+    if (num_threads > 1) {
+        trabalhos = alocarMemoria(sizeof(TrabalhoMira) * (size_t) num_threads);
+        threads = alocarMemoria(sizeof(pthread_t) * (size_t) num_threads);
+        if (trabalhos == NULL || threads == NULL) {
+            free(trabalhos);
+            free(threads);
+            return resultado;
+        }
+    }
+    
+    double prazo = segundosMonotonicos() + orcamento_ms / 1000.0;
+    int threads_iniciadas = 0;
+    for (int t = 0; t < num_threads && contexto->num_candidatos > 0; t++) {
+        memset(&trabalhos[t], 0, sizeof(TrabalhoMira));
+        trabalhos[t].contexto = contexto;
+        trabalhos[t].tiros = tiros;
+        trabalhos[t].num_navios = num_navios;
+        trabalhos[t].prazo = prazo;
+        trabalhos[t].max_amostras = max_amostras / num_threads + (t < max_amostras % num_threads);
+        trabalhos[t].semente = semente;
+        trabalhos[t].indice_thread = t;
+        
+        // A thread principal faz a sua parte em vez de ficar só esperando. Para na primeira falha,
+        // para que as threads iniciadas sejam sempre o prefixo 0..threads_iniciadas-1
+        if (t > 0 && pthread_create(&threads[t], NULL, executarTrabalhoMira, &trabalhos[t]) != 0) {
+            break;
+        }
+        threads_iniciadas++;
+    }
+    if (threads_iniciadas > 0) {
+        executarTrabalhoMira(&trabalhos[0]);
+    }
+    
+    // Junta os acumuladores de cada thread
+    for (int t = 0; t < threads_iniciadas; t++) {
+        if (t > 0) {
+            pthread_join(threads[t], NULL);
+        }
+        for (int c = 0; c < TOTAL_CELULAS; c++) {
+            contagens[c] += trabalhos[t].contagens[c];
+        }
+        resultado.amostras += trabalhos[t].amostras;
+        resultado.tentativas += trabalhos[t].tentativas;
+    }
+    
+    // Escolhe a célula ainda não atingida com maior contagem
+    Mascara128 disparados = mascaraOu(tiros->acertos, tiros->erros);
+    uint32_t melhor = 0;
+    for (int c = 0; c < TOTAL_CELULAS; c++) {
+        if (mascaraTestarCelula(disparados, c)) {
+            continue;
+        }
+        if (resultado.linha < 0 || contagens[c] > melhor) {
+            melhor = contagens[c];
+            resultado.linha = c / TAMANHO_TABULEIRO;
+            resultado.coluna = c % TAMANHO_TABULEIRO;
+        }
+    }
+    if (resultado.amostras > 0) {
+        resultado.probabilidade = (double) melhor / resultado.amostras;
+    }
+    
+    if (contagens_saida != NULL) {
+        memcpy(contagens_saida, contagens, sizeof(contagens));
+    }
+    if (num_threads > 1) {
+        free(trabalhos);
+        free(threads);
+    }
+    return resultado;
+}
+
+// Função para escolher o alvo a partir de um contexto novo (consultas avulsas).
+// Quem mira várias vezes na mesma partida deve manter um ContextoMira e usar escolherAlvoComContexto.
+ResultadoMira escolherAlvoMonteCarlo(const EstadoTiros* tiros, int num_navios, int num_threads,
+                                     double orcamento_ms, long max_amostras, uint64_t semente,
+                                     uint32_t contagens_saida[TOTAL_CELULAS]) {
+    ResultadoMira resultado = {-1, -1, 0.0, 0, 0};
+    ContextoMira* contexto = alocarMemoria(sizeof(ContextoMira));
+    if (contexto == NULL) {
+        return resultado;
+    }
+    
+    prepararContextoMira(contexto);
+    resultado = escolherAlvoComContexto(contexto, tiros, num_navios, num_threads, orcamento_ms, max_amostras,
+                                        semente, contagens_saida);
+    free(contexto);
+    return resultado;
+}
+
+// Função para ler tiros no formato "+linha,coluna" (acerto) ou "-linha,coluna" (erro)
+bool lerTiroTexto(const char* texto, EstadoTiros* tiros) {
+    const char* p = texto + 1;
+    int linha, coluna;
+    
+    if ((texto[0] != '+' && texto[0] != '-') || !lerInteiroTexto(&p, &linha) ||
+        !consumirCaractere(&p, ',') || !lerInteiroTexto(&p, &coluna) || *p != '\0' ||
+        !celulaDentroDosLimites(linha, coluna, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return false;
+    }
+    
+    Mascara128 celula = mascaraDaCelula(linha * TAMANHO_TABULEIRO + coluna);
+    if (texto[0] == '+') {
+        tiros->acertos = mascaraOu(tiros->acertos, celula);
+    } else {
+        tiros->erros = mascaraOu(tiros->erros, celula);
+    }
+    return true;
+}
+
+// Função para exibir o mapa de densidade (porcentagem de amostras com navio em cada célula)
+void exibirMapaDensidade(const uint32_t contagens[TOTAL_CELULAS], long amostras, const EstadoTiros* tiros) {
+    printf("   ");
+    for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+        printf("%4d", j);
+    }
+    printf("\n");
+    
+    for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
+        printf("%2d|", i);
+        for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+            int indice = i * TAMANHO_TABULEIRO + j;
+            if (mascaraTestarCelula(tiros->acertos, indice)) {
+                printf("   X");
+            } else if (mascaraTestarCelula(tiros->erros, indice)) {
+                printf("   o");
+            } else {
+                printf("%4.0f", amostras > 0 ? 100.0 * contagens[indice] / amostras : 0.0);
+            }
+        }
+        printf("\n");
+    }
+}
+
+// =====================================================================
+// CONTAGEM EXATA DE CONFIGURAÇÕES DE FROTA
+// =====================================================================
+
+// Conta, sem amostragem, quantas frotas de num_navios navios iguais (conjuntos de posicionamentos
+// legais sem sobreposição) são consistentes com os tiros conhecidos, e em quantas delas cada
+// célula está ocupada.
+//
+// É uma programação dinâmica por perfil: as células são percorridas em ordem de linhas e cada navio
+// é decidido na sua primeira célula (a menor na ordem de linhas, nas quatro orientações). O estado
+// guarda só a ocupação das próximas 23 células, já reservadas por navios anteriores, e quantos
+// navios foram colocados. Estados iguais vindos de caminhos diferentes são somados (memoização dos
+// subtabuleiros), e os que não conseguem mais completar a frota ou cobrir os acertos pendentes são
+// podados por contagem de bits.
+//
+// A passada de ida conta os caminhos até cada estado; a de volta conta os complementos até o fim.
+// A ocupação da célula i é a soma de ida x volta nas transições que ocupam i. Para caber na memória,
+// a ida só guarda uma camada a cada SEGMENTO_CONTAGEM_EXATA e recalcula o trecho na volta.
+// Cada camada é repartida em fatias por hash, uma por thread. Na ida cada thread expande só os
+// estados da sua fatia: destinos da própria fatia vão direto para a tabela, e os das outras fatias
+// passam por caixas de saída, que a thread dona de cada fatia despeja depois. Na volta cada thread
+// calcula os complementos dos estados da sua fatia.
+
+// Janela de células à frente guardada no estado (o maior deslocamento de um navio é 2 * 10 + 2)
+#define JANELA_CONTAGEM_EXATA (2 * TAMANHO_TABULEIRO + TAMANHO_NAVIO)
+#define SEGMENTO_CONTAGEM_EXATA 10
+#define MAX_THREADS_CONTAGEM_EXATA 64
+#define CHAVE_ESTADO_VAZIA UINT64_MAX
+
+typedef unsigned __int128 ContagemExata;
+
+// Tabela de estados (endereçamento aberto, capacidade potência de 2).
+// 'caminhos' é preenchido na ida e 'complementos' na volta.
+typedef struct {
+    uint64_t* chaves;
+    ContagemExata* caminhos;
+    ContagemExata* complementos;
+    size_t capacidade;
+    size_t ocupados;
+} TabelaEstadosFrota;
+
+// Uma camada (os estados antes de decidir uma célula), repartida em fatias
+typedef struct {
+    TabelaEstadosFrota* fatias;
+} CamadaContagem;
+
+// Transição da ida à espera de ser somada na fatia de destino
+typedef struct {
+    ContagemExata caminhos;
+    uint64_t chave;
+} TransicaoPendente;
+
+// Caixa de saída de uma fatia de origem para uma fatia de destino (reaproveitada entre camadas)
+typedef struct {
+    TransicaoPendente* transicoes;
+    size_t tamanho;
+    size_t capacidade;
+} CaixaTransicoes;
+
+// Restrições já preparadas para a programação dinâmica
+typedef struct {
+    uint32_t opcoes[TOTAL_CELULAS][4];            // Máscaras relativas dos navios ancorados em cada célula
+    int num_opcoes[TOTAL_CELULAS];
+    bool acerto[TOTAL_CELULAS];
+    uint32_t acertos_janela[TOTAL_CELULAS];       // Acertos nas células i .. i + JANELA - 1 (relativos a i)
+    int acertos_a_partir[TOTAL_CELULAS + 1];      // Acertos nas células i .. fim
+    int livres_a_partir[TOTAL_CELULAS + 1];       // Células sem erro em i .. fim
+} RestricoesContagem;
+
+// Resultado de uma contagem exata
+typedef struct {
+    ContagemExata total;
+    ContagemExata ocupacao[TOTAL_CELULAS];
+    long estados;        // Estados distintos visitados na ida
+    double segundos;
+} ResultadoContagemExata;
+
+// Função para converter uma contagem exata em texto decimal
+char* formatarContagemExata(ContagemExata valor, char texto[48]) {
+    char invertido[48];
+    int n = 0;
+    do {
+        invertido[n++] = (char) ('0' + (int) (valor % 10));
+        valor /= 10;
+    } while (valor > 0);
+    
+    for (int i = 0; i < n; i++) {
+        texto[i] = invertido[n - 1 - i];
+    }
+    texto[n] = '\0';
+    return texto;
+}
+
+static inline uint64_t espalharChaveEstado(uint64_t chave) {
+    chave ^= chave >> 33;
+    chave *= 0xFF51AFD7ED558CCDULL;
+    chave ^= chave >> 33;
+    chave *= 0xC4CEB9FE1A85EC53ULL;
+    return chave ^ (chave >> 33);
+}
+
+// A fatia vem dos bits altos do hash e a posição na tabela, dos bits baixos
+static inline int fatiaDoEstado(uint64_t chave, int num_fatias) {
+    return (int) ((espalharChaveEstado(chave) >> 40) % (uint64_t) num_fatias);
+}
+
+static bool criarTabelaEstados(TabelaEstadosFrota* tabela, size_t capacidade) {
+    memset(tabela, 0, sizeof(*tabela));
+    tabela->capacidade = capacidade;
+    tabela->chaves = alocarMemoria(capacidade * sizeof(uint64_t));
+    tabela->caminhos = alocarMemoria(capacidade * sizeof(ContagemExata));
+    if (tabela->chaves == NULL || tabela->caminhos == NULL) {
+        return false;
+    }
+    memset(tabela->chaves, 0xFF, capacidade * sizeof(uint64_t));
+    return true;
+}
+
+static void destruirTabelaEstados(TabelaEstadosFrota* tabela) {
+    free(tabela->chaves);
+    free(tabela->caminhos);
+    free(tabela->complementos);
+    memset(tabela, 0, sizeof(*tabela));
+}
+
+static bool somarEstado(TabelaEstadosFrota* tabela, uint64_t chave, ContagemExata valor);
+
+// Função para dobrar a capacidade da tabela, reinserindo os estados
+static bool crescerTabelaEstados(TabelaEstadosFrota* tabela) {
+    TabelaEstadosFrota antiga = *tabela;
+    if (!criarTabelaEstados(tabela, antiga.capacidade * 2)) {
+        destruirTabelaEstados(tabela);
+        *tabela = antiga;
+        return false;
+    }
+    for (size_t i = 0; i < antiga.capacidade; i++) {
+        if (antiga.chaves[i] != CHAVE_ESTADO_VAZIA) {
+            somarEstado(tabela, antiga.chaves[i], antiga.caminhos[i]);
+        }
+    }
+    destruirTabelaEstados(&antiga);
+    return true;
+}
+
+// Função para somar 'valor' aos caminhos do estado 'chave', criando-o se preciso
+static bool somarEstado(TabelaEstadosFrota* tabela, uint64_t chave, ContagemExata valor) {
+    if (2 * (tabela->ocupados + 1) > tabela->capacidade && !crescerTabelaEstados(tabela)) {
+        return false;
+    }
+    
+    size_t mascara = tabela->capacidade - 1;
+    for (size_t i = espalharChaveEstado(chave) & mascara; ; i = (i + 1) & mascara) {
+        if (tabela->chaves[i] == chave) {
+            tabela->caminhos[i] += valor;
+            return true;
+        }
+        if (tabela->chaves[i] == CHAVE_ESTADO_VAZIA) {
+            tabela->chaves[i] = chave;
+            tabela->caminhos[i] = valor;
+            tabela->ocupados++;
+            return true;
+        }
+    }
+}
+
+// Função para localizar um estado (SIZE_MAX se não existe)
+static size_t buscarEstado(const TabelaEstadosFrota* tabela, uint64_t chave) {
+    size_t mascara = tabela->capacidade - 1;
+    for (size_t i = espalharChaveEstado(chave) & mascara; tabela->chaves[i] != CHAVE_ESTADO_VAZIA;
+         i = (i + 1) & mascara) {
+        if (tabela->chaves[i] == chave) {
+            return i;
+        }
+    }
+    return SIZE_MAX;
+}
+
+// Função para guardar uma transição na caixa, dobrando a capacidade quando enche
+static bool anexarTransicao(CaixaTransicoes* caixa, uint64_t chave, ContagemExata caminhos) {
+    if (caixa->tamanho == caixa->capacidade) {
+        size_t capacidade = caixa->capacidade == 0 ? 1 << 10 : caixa->capacidade * 2;
+        TransicaoPendente* transicoes = realocarMemoria(caixa->transicoes, capacidade * sizeof(TransicaoPendente));
+        if (transicoes == NULL) {
+            return false;
+        }
+        caixa->transicoes = transicoes;
+        caixa->capacidade = capacidade;
+    }
+    caixa->transicoes[caixa->tamanho].chave = chave;
+    caixa->transicoes[caixa->tamanho].caminhos = caminhos;
+    caixa->tamanho++;
+    return true;
+}
+
+static bool criarCamadaContagem(CamadaContagem* camada, int num_fatias) {
+    camada->fatias = alocarMemoriaZerada((size_t) num_fatias, sizeof(TabelaEstadosFrota));
+    if (camada->fatias == NULL) {
+        return false;
+    }
+    for (int f = 0; f < num_fatias; f++) {
+        if (!criarTabelaEstados(&camada->fatias[f], 1 << 10)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void destruirCamadaContagem(CamadaContagem* camada, int num_fatias) {
+    if (camada->fatias != NULL) {
+        for (int f = 0; f < num_fatias; f++) {
+            destruirTabelaEstados(&camada->fatias[f]);
+        }
+        free(camada->fatias);
+    }
+    camada->fatias = NULL;
+}
+
+// Função para preparar as restrições a partir dos tiros
+static void prepararRestricoesContagem(RestricoesContagem* restricoes, const EstadoTiros* tiros) {
+    inicializarTabelasBits();
+    memset(restricoes, 0, sizeof(*restricoes));
+    
+    for (int indice = 0; indice < TOTAL_CELULAS; indice++) {
+        restricoes->acerto[indice] = mascaraTestarCelula(tiros->acertos, indice);
+        
+        for (int orientacao = HORIZONTAL; orientacao <= DIAGONAL_SECUNDARIA; orientacao++) {
+            if (!navioCabeBits[orientacao][indice]
+                || mascaraSeCruzam(mascarasNavio[orientacao][indice], tiros->erros)) {
+                continue;
+            }
+            
+            uint32_t relativa = 0;
+            int linha = indice / TAMANHO_TABULEIRO, coluna = indice % TAMANHO_TABULEIRO;
+            for (int i = 0; i < TAMANHO_NAVIO; i++) {
+                int linha_atual, coluna_atual;
+                calcularPosicaoNavio(linha, coluna, orientacao, i, &linha_atual, &coluna_atual);
+                relativa |= 1u << (linha_atual * TAMANHO_TABULEIRO + coluna_atual - indice);
+            }
+            restricoes->opcoes[indice][restricoes->num_opcoes[indice]++] = relativa;
+        }
+    }
+    
+    for (int indice = TOTAL_CELULAS - 1; indice >= 0; indice--) {
+        restricoes->acertos_a_partir[indice] = restricoes->acertos_a_partir[indice + 1] + restricoes->acerto[indice];
+        restricoes->livres_a_partir[indice] = restricoes->livres_a_partir[indice + 1]
+                                              + !mascaraTestarCelula(tiros->erros, indice);
+        for (int j = 0; j < JANELA_CONTAGEM_EXATA && indice + j < TOTAL_CELULAS; j++) {
+            restricoes->acertos_janela[indice] |= (uint32_t) restricoes->acerto[indice + j] << j;
+        }
+    }
+}
+
+// Função para listar as transições de um estado ao decidir a célula 'indice'.
+// Devolve quantas há (0 se o estado foi podado); 'ocupa' diz se a transição ocupa a célula.
+static inline int listarTransicoes(const RestricoesContagem* restricoes, int num_navios, int indice,
+                                   uint64_t chave, uint64_t destinos[5], bool ocupa[5]) {
+    uint32_t reservadas = (uint32_t) chave;
+    int colocados = (int) (chave >> 32);
+    int faltam = num_navios - colocados;
+    int n = 0;
+    
+    // Poda: navios que ainda cabem e acertos pendentes que ainda precisam de navio
+    int livres = restricoes->livres_a_partir[indice] - __builtin_popcount(reservadas);
+    int acertos_pendentes = restricoes->acertos_a_partir[indice]
+                            - __builtin_popcount(restricoes->acertos_janela[indice] & reservadas);
+    if (livres < faltam * TAMANHO_NAVIO || acertos_pendentes > faltam * TAMANHO_NAVIO) {
+        return 0;
+    }
+    
+    // Sem navio ancorado nesta célula (proibido se ela é um acerto ainda livre)
+    if ((reservadas & 1) || !restricoes->acerto[indice]) {
+        destinos[n] = (uint64_t) colocados << 32 | (reservadas >> 1);
+        ocupa[n++] = reservadas & 1;
+    }
+    
+    // Com um navio ancorado nesta célula, em cada orientação possível
+    if (faltam > 0 && !(reservadas & 1)) {
+        for (int o = 0; o < restricoes->num_opcoes[indice]; o++) {
+            uint32_t navio = restricoes->opcoes[indice][o];
+            if (navio & reservadas) {
+                continue;
+            }
+            destinos[n] = (uint64_t) (colocados + 1) << 32 | ((reservadas | navio) >> 1);
+            ocupa[n++] = true;
+        }
+    }
+    return n;
+}
+
+// Tarefa de uma thread em uma camada: avançar (ida) ou retroceder (volta)
+typedef struct {
+    const RestricoesContagem* restricoes;
+    int num_navios;
+    int num_fatias;
+    int indice;                    // Célula decidida entre 'origem' e 'destino'
+    CamadaContagem* origem;
+    CamadaContagem* destino;
+    CaixaTransicoes* caixas;       // Caixas de saída da ida, [fatia de origem * num_fatias + fatia de destino]
+    int fatia;                     // Fatia desta thread
+    bool falhou;
+    ContagemExata ocupacao;        // Contribuição desta fatia para a ocupação da célula (volta)
+} TarefaCamada;
+
+// Ida, primeira fase: expande os estados da fatia desta thread. Destinos da própria fatia são
+// somados direto; os demais vão para a caixa de saída da fatia de destino.
+static void* avancarFatia(void* argumento) {
+    TarefaCamada* tarefa = argumento;
+    const TabelaEstadosFrota* entrada = &tarefa->origem->fatias[tarefa->fatia];
+    TabelaEstadosFrota* saida = &tarefa->destino->fatias[tarefa->fatia];
+    CaixaTransicoes* caixas = &tarefa->caixas[tarefa->fatia * tarefa->num_fatias];
+    uint64_t destinos[5];
+    bool ocupa[5];
+    
+    for (size_t s = 0; s < entrada->capacidade; s++) {
+        if (entrada->chaves[s] == CHAVE_ESTADO_VAZIA) {
+            continue;
+        }
+        int n = listarTransicoes(tarefa->restricoes, tarefa->num_navios, tarefa->indice,
+                                 entrada->chaves[s], destinos, ocupa);
+        for (int t = 0; t < n; t++) {
+            int fatia = fatiaDoEstado(destinos[t], tarefa->num_fatias);
+            bool guardado = fatia == tarefa->fatia ? somarEstado(saida, destinos[t], entrada->caminhos[s])
+                                                   : anexarTransicao(&caixas[fatia], destinos[t], entrada->caminhos[s]);
+            if (!guardado) {
+                tarefa->falhou = true;
+                return NULL;
+            }
+        }
+    }
+    return NULL;
+}
+
+// Ida, segunda fase: soma na fatia desta thread o que as outras threads deixaram para ela
+static void* despejarCaixasFatia(void* argumento) {
+    TarefaCamada* tarefa = argumento;
+    TabelaEstadosFrota* saida = &tarefa->destino->fatias[tarefa->fatia];
+    
+    for (int f = 0; f < tarefa->num_fatias; f++) {
+        CaixaTransicoes* caixa = &tarefa->caixas[f * tarefa->num_fatias + tarefa->fatia];
+        for (size_t i = 0; i < caixa->tamanho; i++) {
+            if (!somarEstado(saida, caixa->transicoes[i].chave, caixa->transicoes[i].caminhos)) {
+                tarefa->falhou = true;
+                return NULL;
+            }
+        }
+        caixa->tamanho = 0;
+    }
+    return NULL;
+}
+
+// Volta: calcula os complementos dos estados da fatia desta thread a partir da camada seguinte
+static void* retrocederFatia(void* argumento) {
+    TarefaCamada* tarefa = argumento;
+    TabelaEstadosFrota* tabela = &tarefa->origem->fatias[tarefa->fatia];
+    uint64_t destinos[5];
+    bool ocupa[5];
+    
+    tabela->complementos = alocarMemoriaZerada(tabela->capacidade, sizeof(ContagemExata));
+    if (tabela->complementos == NULL) {
+        tarefa->falhou = true;
+        return NULL;
+    }
+    
+    for (size_t s = 0; s < tabela->capacidade; s++) {
+        if (tabela->chaves[s] == CHAVE_ESTADO_VAZIA) {
+            continue;
+        }
+        int n = listarTransicoes(tarefa->restricoes, tarefa->num_navios, tarefa->indice, tabela->chaves[s],
+                                 destinos, ocupa);
+        ContagemExata complemento = 0;
+        for (int t = 0; t < n; t++) {
+            const TabelaEstadosFrota* seguinte = &tarefa->destino->fatias[fatiaDoEstado(destinos[t],
+                                                                                       tarefa->num_fatias)];
+            size_t posicao = buscarEstado(seguinte, destinos[t]);
+            if (posicao == SIZE_MAX) {
+                continue;
+            }
+            complemento += seguinte->complementos[posicao];
+            if (ocupa[t]) {
+                tarefa->ocupacao += tabela->caminhos[s] * seguinte->complementos[posicao];
+            }
+        }
+        tabela->complementos[s] = complemento;
+    }
+    return NULL;
+}
+
+// Função para executar uma etapa em todas as fatias (uma thread por fatia); devolve false sem memória
+static bool executarEtapaContagem(void* (*etapa)(void*), TarefaCamada modelo, int num_threads,
+                                  ContagemExata* ocupacao) {
+    TarefaCamada tarefas[MAX_THREADS_CONTAGEM_EXATA];
+    pthread_t threads[MAX_THREADS_CONTAGEM_EXATA];
+    bool criada[MAX_THREADS_CONTAGEM_EXATA] = {false};
+    
+    for (int t = 0; t < num_threads; t++) {
+        tarefas[t] = modelo;
+        tarefas[t].fatia = t;
+        tarefas[t].falhou = false;
+        tarefas[t].ocupacao = 0;
+    }
+    for (int t = 1; t < num_threads; t++) {
+        criada[t] = pthread_create(&threads[t], NULL, etapa, &tarefas[t]) == 0;
+        if (!criada[t]) {
+            etapa(&tarefas[t]);
+        }
+    }
+    etapa(&tarefas[0]);
+    
+    bool sucesso = true;
+    for (int t = 0; t < num_threads; t++) {
+        if (t > 0 && criada[t]) {
+            pthread_join(threads[t], NULL);
+        }
+        sucesso = sucesso && !tarefas[t].falhou;
+        if (ocupacao != NULL) {
+            *ocupacao += tarefas[t].ocupacao;
+        }
+    }
+    return sucesso;
+}
+
+// Função para avançar uma camada inteira: expansão e despejo das caixas, com todas as threads
+// sincronizadas entre as duas fases. Com uma fatia só, as caixas nem chegam a ser usadas.
+static bool avancarCamadaContagem(TarefaCamada modelo, int num_threads) {
+    return executarEtapaContagem(avancarFatia, modelo, num_threads, NULL)
+           && (num_threads == 1 || executarEtapaContagem(despejarCaixasFatia, modelo, num_threads, NULL));
+}
+
+// Função para contar exatamente as frotas consistentes com os tiros e a ocupação de cada célula.
+// Devolve false se faltar memória.
+bool contarFrotasExato(const EstadoTiros* tiros, int num_navios, int num_threads, ResultadoContagemExata* resultado) {
+    double inicio = segundosMonotonicos();
+    CamadaContagem camadas[TOTAL_CELULAS + 1];
+    RestricoesContagem restricoes;
+    bool sucesso = true;
+    
+    memset(resultado, 0, sizeof(*resultado));
+    if (num_navios < 1 || num_navios > MAX_NAVIOS_FROTA) {
+        return false;
+    }
+    if (num_threads < 1) {
+        num_threads = obterNumeroNucleos();
+    }
+    if (num_threads > MAX_THREADS_CONTAGEM_EXATA) {
+        num_threads = MAX_THREADS_CONTAGEM_EXATA;
+    }
+    prepararRestricoesContagem(&restricoes, tiros);
+    memset(camadas, 0, sizeof(camadas));
+    
+    CaixaTransicoes* caixas = alocarMemoriaZerada((size_t) num_threads * (size_t) num_threads, sizeof(CaixaTransicoes));
+    if (caixas == NULL) {
+        return false;
+    }
+    TarefaCamada modelo = {&restricoes, num_navios, num_threads, 0, NULL, NULL, caixas, 0, false, 0};
+    
+    // Ida: só as camadas no início de cada segmento ficam guardadas
+    sucesso = criarCamadaContagem(&camadas[0], num_threads)
+              && somarEstado(&camadas[0].fatias[fatiaDoEstado(0, num_threads)], 0, 1);
+    CamadaContagem anterior = camadas[0];
+    for (int indice = 0; indice < TOTAL_CELULAS && sucesso; indice++) {
+        CamadaContagem proxima = {NULL};
+        sucesso = criarCamadaContagem(&proxima, num_threads);
+        modelo.indice = indice;
+        modelo.origem = &anterior;
+        modelo.destino = &proxima;
+        sucesso = sucesso && avancarCamadaContagem(modelo, num_threads);
+        if (!sucesso) {
+            destruirCamadaContagem(&proxima, num_threads);
+            if (indice % SEGMENTO_CONTAGEM_EXATA != 0) {
+                destruirCamadaContagem(&anterior, num_threads);
+            }
+            break;
+        }
+        
+        for (int f = 0; f < num_threads; f++) {
+            resultado->estados += (long) proxima.fatias[f].ocupados;
+        }
+        if (indice % SEGMENTO_CONTAGEM_EXATA != 0) {
+            destruirCamadaContagem(&anterior, num_threads);
+        }
+        anterior = proxima;
+        if ((indice + 1) % SEGMENTO_CONTAGEM_EXATA == 0 || indice + 1 == TOTAL_CELULAS) {
+            camadas[indice + 1] = proxima;
+        }
+    }
+    
+    // Total: frotas completas ao fim do tabuleiro; a camada final recebe os complementos iniciais
+    if (sucesso) {
+        TabelaEstadosFrota* fatia_final = &camadas[TOTAL_CELULAS].fatias[fatiaDoEstado((uint64_t) num_navios << 32,
+                                                                                      num_threads)];
+        size_t posicao = buscarEstado(fatia_final, (uint64_t) num_navios << 32);
+        resultado->total = posicao == SIZE_MAX ? 0 : fatia_final->caminhos[posicao];
+        
+        for (int f = 0; f < num_threads && sucesso; f++) {
+            TabelaEstadosFrota* tabela = &camadas[TOTAL_CELULAS].fatias[f];
+            tabela->complementos = alocarMemoriaZerada(tabela->capacidade, sizeof(ContagemExata));
+            sucesso = tabela->complementos != NULL;
+        }
+        if (sucesso && posicao != SIZE_MAX) {
+            fatia_final->complementos[posicao] = 1;
+        }
+    }
+    
+    // Volta, segmento por segmento: recalcula as camadas do trecho a partir da guardada e retrocede
+    for (int fim = TOTAL_CELULAS; fim > 0 && sucesso; fim = ((fim - 1) / SEGMENTO_CONTAGEM_EXATA) * SEGMENTO_CONTAGEM_EXATA) {
+        int comeco = ((fim - 1) / SEGMENTO_CONTAGEM_EXATA) * SEGMENTO_CONTAGEM_EXATA;
+        
+        for (int indice = comeco; indice < fim - 1 && sucesso; indice++) {
+            sucesso = criarCamadaContagem(&camadas[indice + 1], num_threads);
+            modelo.indice = indice;
+            modelo.origem = &camadas[indice];
+            modelo.destino = &camadas[indice + 1];
+            sucesso = sucesso && avancarCamadaContagem(modelo, num_threads);
+        }
+        
+        for (int indice = fim - 1; indice >= comeco && sucesso; indice--) {
+            modelo.indice = indice;
+            modelo.origem = &camadas[indice];
+            modelo.destino = &camadas[indice + 1];
+            sucesso = executarEtapaContagem(retrocederFatia, modelo, num_threads, &resultado->ocupacao[indice]);
+            destruirCamadaContagem(&camadas[indice + 1], num_threads);
+        }
+    }
+    
+    for (int indice = 0; indice <= TOTAL_CELULAS; indice++) {
+        destruirCamadaContagem(&camadas[indice], num_threads);
+    }
+    for (int c = 0; c < num_threads * num_threads; c++) {
+        free(caixas[c].transicoes);
+    }
+    free(caixas);
+    resultado->segundos = segundosMonotonicos() - inicio;
+    return sucesso;
+}
+
+// =====================================================================
+// PARTIDAS SIMULADAS E ESTRATÉGIAS DE TIRO
+// =====================================================================
+
+#define NAVIOS_PADRAO_PARTIDA 4
+#define AMOSTRAS_ESTRATEGIA_DENSIDADE 500
+
+// Estratégias de tiro disponíveis para as partidas simuladas
+typedef enum {
+    ESTRATEGIA_ALEATORIA,
+    ESTRATEGIA_CACA_ALVO,
+    ESTRATEGIA_DENSIDADE,
+    NUM_ESTRATEGIAS
+} EstrategiaTiro;
+
+// Estado de um jogador atirando contra o tabuleiro adversário
+typedef struct {
+    EstrategiaTiro estrategia;
+    EstadoTiros tiros;
+    GeradorAleatorio gerador;
+    int num_navios;
+    unsigned char livres[TOTAL_CELULAS];   // Células ainda não sorteadas na fase de caça
+    int num_livres;
+    unsigned char alvos[TOTAL_CELULAS];    // Vizinhos de acertos aguardando tiro
+    int num_alvos;
+    Mascara128 enfileirados;
+    ContextoMira mira;                     // Só usado pela estratégia de densidade
+} Atirador;
+
+// Resultado de uma partida simulada
+typedef struct {
+    int vencedor;          // 0 ou 1; -1 se alguma frota não pôde ser posicionada
+    int tiros_vencedor;
+} ResultadoPartida;
+
+// Função para obter o nome de uma estratégia
+const char* obterNomeEstrategia(EstrategiaTiro estrategia) {
+    switch (estrategia) {
+        case ESTRATEGIA_ALEATORIA: return "aleatoria";
+        case ESTRATEGIA_CACA_ALVO: return "caca-alvo";
+        case ESTRATEGIA_DENSIDADE: return "densidade";
+        default: return "?";
+    }
+}
+
+// Função para converter o nome de uma estratégia (-1 se desconhecida)
+int lerNomeEstrategia(const char* nome) {
+    for (int e = 0; e < NUM_ESTRATEGIAS; e++) {
+        if (strcmp(nome, obterNomeEstrategia(e)) == 0) {
+            return e;
+        }
+    }
+    return -1;
+}
+
+// Função para preparar um atirador para uma nova partida
+void inicializarAtirador(Atirador* atirador, EstrategiaTiro estrategia, int num_navios, uint64_t semente) {
+    atirador->estrategia = estrategia;
+    atirador->num_navios = num_navios;
+    inicializarEstadoTiros(&atirador->tiros);
+    semearGerador(&atirador->gerador, semente, 0);
+    
+    for (int c = 0; c < TOTAL_CELULAS; c++) {
+        atirador->livres[c] = (unsigned char) c;
+    }
+    atirador->num_livres = TOTAL_CELULAS;
+    atirador->num_alvos = 0;
+    atirador->enfileirados = mascaraVazia();
+    
+    // Os candidatos da mira são montados uma vez por partida e só encolhem a cada erro
+    if (estrategia == ESTRATEGIA_DENSIDADE) {
+        prepararContextoMira(&atirador->mira);
+    }
+}
+
+// Função para sortear uma célula ainda não atingida
+static int sortearCelulaLivre(Atirador* atirador) {
+    Mascara128 disparados = mascaraOu(atirador->tiros.acertos, atirador->tiros.erros);
+    
+    while (atirador->num_livres > 0) {
+        int posicao = (int) aleatorioAte(&atirador->gerador, (uint32_t) atirador->num_livres);
+        int celula = atirador->livres[posicao];
+        atirador->livres[posicao] = atirador->livres[--atirador->num_livres];
+        
+        // Células já atingidas pela fase de alvo são descartadas aqui, sem custo extra
+        if (!mascaraTestarCelula(disparados, celula)) {
+            return celula;
+        }
+    }
+    return -1;
+}
+
+// Função para retirar o próximo vizinho pendente (fase de alvo)
+static int retirarAlvoPendente(Atirador* atirador) {
+    Mascara128 disparados = mascaraOu(atirador->tiros.acertos, atirador->tiros.erros);
+    
+    while (atirador->num_alvos > 0) {
+        int celula = atirador->alvos[--atirador->num_alvos];
+        if (!mascaraTestarCelula(disparados, celula)) {
+            return celula;
+        }
+    }
+    return -1;
+}
+
+// Função para escolher a próxima célula a atingir, conforme a estratégia
+int escolherTiro(Atirador* atirador) {
+    int celula = -1;
+    
+    switch (atirador->estrategia) {
+        case ESTRATEGIA_ALEATORIA:
+            break;
+            
+        case ESTRATEGIA_CACA_ALVO:
+            celula = retirarAlvoPendente(atirador);
+            break;
+            
+        case ESTRATEGIA_DENSIDADE: {
+            ResultadoMira mira = escolherAlvoComContexto(&atirador->mira, &atirador->tiros, atirador->num_navios, 1,
+                                                         1e9, AMOSTRAS_ESTRATEGIA_DENSIDADE,
+                                                         proximoAleatorio(&atirador->gerador), NULL);
+            // Sem amostras consistentes, recorre à caça e alvo
+            celula = mira.amostras > 0 ? mira.linha * TAMANHO_TABULEIRO + mira.coluna
+                                       : retirarAlvoPendente(atirador);
+            break;
+        }
+            
+        default:
+            break;
+    }
+    return celula >= 0 ? celula : sortearCelulaLivre(atirador);
+}
+
+// Função para registrar o resultado de um tiro; em acertos, enfileira os 8 vizinhos (navios podem ser diagonais)
+void registrarTiro(Atirador* atirador, int celula, bool acerto) {
+    Mascara128 mascara_celula = mascaraDaCelula(celula);
+    
+    if (!acerto) {
+        atirador->tiros.erros = mascaraOu(atirador->tiros.erros, mascara_celula);
+        return;
+    }
+    atirador->tiros.acertos = mascaraOu(atirador->tiros.acertos, mascara_celula);
+    
+    int linha = celula / TAMANHO_TABULEIRO;
+    int coluna = celula % TAMANHO_TABULEIRO;
+    for (int dl = -1; dl <= 1; dl++) {
+        for (int dc = -1; dc <= 1; dc++) {
+            int vizinho = (linha + dl) * TAMANHO_TABULEIRO + coluna + dc;
+            if ((dl == 0 && dc == 0) ||
+                !celulaDentroDosLimites(linha + dl, coluna + dc, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO) ||
+                mascaraTestarCelula(atirador->enfileirados, vizinho)) {
+                continue;
+            }
+            atirador->enfileirados = mascaraOu(atirador->enfileirados, mascaraDaCelula(vizinho));
+            atirador->alvos[atirador->num_alvos++] = (unsigned char) vizinho;
+        }
+    }
+}
+
+// Função para jogar uma partida completa entre duas estratégias.
+// A partida é totalmente determinada por (semente, fluxo), independente da thread que a executa.
+ResultadoPartida jogarPartida(EstrategiaTiro estrategia_a, EstrategiaTiro estrategia_b, int num_navios,
+                              uint64_t semente, uint64_t fluxo) {
+    GeradorAleatorio gerador;
+    TabuleiroBits tabuleiros[2];
+    Navio navios[MAX_NAVIOS_FROTA];
+    Atirador atiradores[2];
+    int tiros[2] = {0, 0};
+    
+    semearGerador(&gerador, semente, fluxo);
+    if (gerarFrotaAleatoria(&gerador, num_navios, navios, &tabuleiros[0]) == 0 ||
+        gerarFrotaAleatoria(&gerador, num_navios, navios, &tabuleiros[1]) == 0) {
+        ResultadoPartida resultado = {-1, 0};
+        return resultado;
+    }
+    inicializarAtirador(&atiradores[0], estrategia_a, num_navios, proximoAleatorio(&gerador));
+    inicializarAtirador(&atiradores[1], estrategia_b, num_navios, proximoAleatorio(&gerador));
+    
+    int celulas_navio = num_navios * TAMANHO_NAVIO;
+    int vez = (int) (fluxo & 1);    // Alterna quem começa para não favorecer nenhum lado
+    
+    while (true) {
+        Atirador* atirador = &atiradores[vez];
+        const TabuleiroBits* alvo = &tabuleiros[1 - vez];
+        
+        int celula = escolherTiro(atirador);
+        bool acerto = mascaraTestarCelula(alvo->navios, celula);
+        registrarTiro(atirador, celula, acerto);
+        tiros[vez]++;
+        
+        if (mascaraContar(atirador->tiros.acertos) == celulas_navio) {
+            ResultadoPartida resultado = {vez, tiros[vez]};
+            return resultado;
+        }
+        vez = 1 - vez;
+    }
+}
+
+// =====================================================================
+// ESTADOS DE JOGO EM ARENA (SIMULAÇÕES EM MASSA)
+// =====================================================================
+
+// Um estado de jogo reúne tabuleiro, frota, habilidades e tiros recebidos num bloco de tamanho fixo,
+// sem ponteiros próprios: clonar é um memcpy e descartar é só esquecer. Cada thread tem sua arena,
+// que entrega estados em sequência e é esvaziada de uma vez ao fim de cada lote de partidas.
+
+#define MAX_HABILIDADES_ESTADO 8
+#define LOTE_ARENA_ESTADOS 256
+
+// Navio ou habilidade guardado em 3 bytes (orientação ou tipo, linha, coluna)
+typedef struct {
+    uint8_t codigo;
+    uint8_t linha;
+    uint8_t coluna;
+} ItemEstado;
+
+typedef struct {
+    TabuleiroBits tabuleiro;
+    EstadoTiros tiros;              // Tiros recebidos
+    uint8_t num_navios;
+    uint8_t num_habilidades;
+    ItemEstado navios[MAX_NAVIOS_FROTA];
+    ItemEstado habilidades[MAX_HABILIDADES_ESTADO];
+} __attribute__((aligned(64))) EstadoJogo;
+
+typedef struct {
+    EstadoJogo* estados;
+    int capacidade;
+    int usados;
+} ArenaEstados;
+
+// Mesmo cenário do nível Mestre
+static const Navio naviosNivelMestre[4] = {
+    {1, 1, HORIZONTAL, "Fragata (Horizontal)"},
+    {6, 8, VERTICAL, "Destroyer (Vertical)"},
+    {0, 5, DIAGONAL_PRINCIPAL, "Cruzador (Diagonal \\)"},
+    {8, 4, DIAGONAL_SECUNDARIA, "Submarino (Diagonal /)"}
+};
+static const ItemEstado habilidadesNivelMestre[3] = {
+    {CONE, 2, 5},
+    {CRUZ, 7, 2},
+    {OCTAEDRO, 4, 7}
+};
+
+// Função para preparar um estado vazio (só água, sem tiros)
+void inicializarEstadoJogo(EstadoJogo* estado) {
+    inicializarTabuleiroBits(&estado->tabuleiro);
+    inicializarEstadoTiros(&estado->tiros);
+    estado->num_navios = 0;
+    estado->num_habilidades = 0;
+}
+
+// Função para posicionar um navio no estado e registrá-lo na frota
+ResultadoPosicionamento adicionarNavioEstado(EstadoJogo* estado, int linha, int coluna, OrientacaoNavio orientacao) {
+    if (estado->num_navios == MAX_NAVIOS_FROTA) {
+        return POSICIONAMENTO_INVALIDO;
+    }
+    
+    ResultadoPosicionamento resultado = tentarPosicionarNavioBits(&estado->tabuleiro, linha, coluna, orientacao);
+    if (resultado == POSICIONAMENTO_OK) {
+        ItemEstado item = {(uint8_t) orientacao, (uint8_t) linha, (uint8_t) coluna};
+        estado->navios[estado->num_navios++] = item;
+    }
+    return resultado;
+}
+
+// Função para aplicar uma habilidade ao estado e registrá-la (false se a lista está cheia)
+bool adicionarHabilidadeEstado(EstadoJogo* estado, TipoHabilidade tipo, int linha_origem, int coluna_origem) {
+    if (estado->num_habilidades == MAX_HABILIDADES_ESTADO ||
+        !celulaDentroDosLimites(linha_origem, coluna_origem, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return false;
+    }
+    
+    aplicarHabilidadeTipoBits(&estado->tabuleiro, tipo, linha_origem, coluna_origem);
+    ItemEstado item = {(uint8_t) tipo, (uint8_t) linha_origem, (uint8_t) coluna_origem};
+    estado->habilidades[estado->num_habilidades++] = item;
+    return true;
+}
+
+// Função para registrar um tiro recebido; devolve true em acerto
+static inline bool atirarEstadoJogo(EstadoJogo* estado, int celula) {
+    Mascara128 mascara_celula = mascaraDaCelula(celula);
+    bool acerto = mascaraTestarCelula(estado->tabuleiro.navios, celula);
+    
+    if (acerto) {
+        estado->tiros.acertos = mascaraOu(estado->tiros.acertos, mascara_celula);
+    } else {
+        estado->tiros.erros = mascaraOu(estado->tiros.erros, mascara_celula);
+    }
+    return acerto;
+}
+
+// Função para saber se todos os navios do estado já foram atingidos
+static inline bool frotaAfundadaEstado(const EstadoJogo* estado) {
+    return mascaraEhVazia(mascaraENao(estado->tabuleiro.navios, estado->tiros.acertos));
+}
+
+// Função para montar o estado do cenário do nível Mestre (4 navios e 3 habilidades)
+void montarEstadoNivelMestre(EstadoJogo* estado) {
+    inicializarEstadoJogo(estado);
+    for (int i = 0; i < 4; i++) {
+        adicionarNavioEstado(estado, naviosNivelMestre[i].linha, naviosNivelMestre[i].coluna,
+                             naviosNivelMestre[i].orientacao);
+    }
+    for (int i = 0; i < 3; i++) {
+        adicionarHabilidadeEstado(estado, habilidadesNivelMestre[i].codigo, habilidadesNivelMestre[i].linha,
+                                  habilidadesNivelMestre[i].coluna);
+    }
+}
+
+// Função para criar uma arena com espaço para 'capacidade' estados
+bool criarArenaEstados(ArenaEstados* arena, int capacidade) {
+    arena->estados = alocarMemoriaAlinhada(64, sizeof(EstadoJogo) * (size_t) capacidade);
+    arena->capacidade = arena->estados != NULL ? capacidade : 0;
+    arena->usados = 0;
+    return arena->estados != NULL;
+}
+
+void destruirArenaEstados(ArenaEstados* arena) {
+    free(arena->estados);
+    arena->estados = NULL;
+    arena->capacidade = 0;
+    arena->usados = 0;
+}
+
+// Função para entregar o próximo estado livre da arena, sem inicializá-lo (NULL se a arena encheu)
+static inline EstadoJogo* alocarEstadoArena(ArenaEstados* arena) {
+    if (arena->usados == arena->capacidade) {
+        return NULL;
+    }
+    return &arena->estados[arena->usados++];
+}
+
+// Função para obter da arena uma cópia de um estado modelo (NULL se a arena encheu)
+static inline EstadoJogo* clonarEstadoArena(ArenaEstados* arena, const EstadoJogo* modelo) {
+    EstadoJogo* estado = alocarEstadoArena(arena);
+    if (estado != NULL) {
+        memcpy(estado, modelo, sizeof(EstadoJogo));
+    }
+    return estado;
+}
+
+// Função para devolver todos os estados da arena de uma vez
+static inline void reiniciarArenaEstados(ArenaEstados* arena) {
+    arena->usados = 0;
+}
+
+// Dados de cada thread da simulação sobre um modelo
+typedef struct {
+    const EstadoJogo* modelo;
+    EstrategiaTiro estrategia;
+    long partidas;
+    uint64_t semente;
+    int indice;
+    bool sucesso;
+    long soma_tiros;
+    int min_tiros;
+    int max_tiros;
+} TrabalhoSimulacaoModelo;
+
+// Cada thread clona o modelo em lotes para sua arena, joga as partidas do lote e esvazia a arena
+static void* executarSimulacaoModelo(void* argumento) {
+    TrabalhoSimulacaoModelo* trabalho = argumento;
+    ArenaEstados arena;
+    Atirador atirador;
+    GeradorAleatorio gerador;
+    
+    trabalho->min_tiros = TOTAL_CELULAS;
+    trabalho->max_tiros = 0;
+    trabalho->sucesso = criarArenaEstados(&arena, LOTE_ARENA_ESTADOS);
+    if (!trabalho->sucesso) {
+        return NULL;
+    }
+    semearGerador(&gerador, trabalho->semente, (uint64_t) trabalho->indice);
+    
+    for (long feitas = 0; feitas < trabalho->partidas; ) {
+        long lote = trabalho->partidas - feitas < LOTE_ARENA_ESTADOS ? trabalho->partidas - feitas : LOTE_ARENA_ESTADOS;
+        
+        reiniciarArenaEstados(&arena);
+        for (long i = 0; i < lote; i++) {
+            clonarEstadoArena(&arena, trabalho->modelo);
+        }
+        
+        for (int i = 0; i < arena.usados; i++) {
+            EstadoJogo* estado = &arena.estados[i];
+            int num_tiros = 0;
+            
+            inicializarAtirador(&atirador, trabalho->estrategia, estado->num_navios, proximoAleatorio(&gerador));
+            while (!frotaAfundadaEstado(estado)) {
+                int celula = escolherTiro(&atirador);
+                registrarTiro(&atirador, celula, atirarEstadoJogo(estado, celula));
+                num_tiros++;
+            }
+            
+            trabalho->soma_tiros += num_tiros;
+            trabalho->min_tiros = num_tiros < trabalho->min_tiros ? num_tiros : trabalho->min_tiros;
+            trabalho->max_tiros = num_tiros > trabalho->max_tiros ? num_tiros : trabalho->max_tiros;
+        }
+        feitas += lote;
+    }
+    
+    destruirArenaEstados(&arena);
+    return NULL;
+}
+
+// Função para jogar 'partidas' partidas de uma estratégia contra cópias do mesmo modelo
+bool simularSobreModelo(const EstadoJogo* modelo, EstrategiaTiro estrategia, long partidas, int num_threads,
+                        uint64_t semente, double* media_tiros, int* min_tiros, int* max_tiros) {
+    if (num_threads < 1) {
+        num_threads = 1;
+    }
+    inicializarPosicionamentosLegais();
+    inicializarEstenceis();
+    
+    TrabalhoSimulacaoModelo* trabalhos = alocarMemoriaZerada((size_t) num_threads, sizeof(TrabalhoSimulacaoModelo));
+    pthread_t* threads = alocarMemoria(sizeof(pthread_t) * (size_t) num_threads);
+    if (trabalhos == NULL || threads == NULL) {
+        free(trabalhos);
+        free(threads);
+        return false;
+    }
+    
+    int iniciadas = 0;
+    for (int t = 0; t < num_threads; t++) {
+        trabalhos[t].modelo = modelo;
+        trabalhos[t].estrategia = estrategia;
+        trabalhos[t].partidas = partidas / num_threads + (t < partidas % num_threads);
+        trabalhos[t].semente = semente;
+        trabalhos[t].indice = t;
+        if (pthread_create(&threads[t], NULL, executarSimulacaoModelo, &trabalhos[t]) != 0) {
+            break;
+        }
+        iniciadas++;
+    }
+    
+    bool sucesso = iniciadas == num_threads;
+    long soma_tiros = 0;
+    *min_tiros = TOTAL_CELULAS;
+    *max_tiros = 0;
+    for (int t = 0; t < iniciadas; t++) {
+        pthread_join(threads[t], NULL);
+        sucesso = sucesso && trabalhos[t].sucesso;
+        soma_tiros += trabalhos[t].soma_tiros;
+        *min_tiros = trabalhos[t].min_tiros < *min_tiros ? trabalhos[t].min_tiros : *min_tiros;
+        *max_tiros = trabalhos[t].max_tiros > *max_tiros ? trabalhos[t].max_tiros : *max_tiros;
+    }
+    *media_tiros = partidas > 0 ? (double) soma_tiros / (double) partidas : 0.0;
+    
+    free(trabalhos);
+    free(threads);
+    return sucesso;
+}
+
+// =====================================================================
+// TORNEIO EM PARALELO (POOL DE THREADS COM ROUBO DE TRABALHO)
+// =====================================================================
+
+// Partidas executadas de uma vez por tarefa; faixas maiores são divididas ao meio
+#define GRAO_TORNEIO 64
+
+// Tarefa do torneio: uma faixa de partidas de um confronto
+typedef struct {
+    int confronto;
+    long inicio;
+    long fim;
+} TarefaTorneio;
+
+// Fila dupla de tarefas de cada thread: a dona usa o topo, os ladrões retiram pela base
+typedef struct {
+    pthread_mutex_t trava;
+    TarefaTorneio* itens;
+    int base;
+    int topo;
+    int capacidade;
+} DequeTarefas;
+
+// Estatísticas acumuladas de um confronto (por thread, e depois mescladas)
+typedef struct {
+    long partidas;
+    long vitorias[2];
+    double soma_tiros[2];
+    double soma_quadrados_tiros[2];
+} EstatisticasConfronto;
+
+typedef struct Torneio Torneio;
+
+typedef struct {
+    Torneio* torneio;
+    int indice;
+    GeradorAleatorio gerador;   // Só para escolher vítimas de roubo
+    EstatisticasConfronto* estatisticas;
+} TrabalhadorTorneio;
+
+struct Torneio {
+    int num_confrontos;
+    EstrategiaTiro (*confrontos)[2];
+    int num_navios;
+    uint64_t semente;
+    int num_threads;
+    DequeTarefas* deques;
+    TrabalhadorTorneio* trabalhadores;
+    _Atomic long partidas_restantes;
+    atomic_bool frota_invalida;     // Alguma partida não conseguiu posicionar a frota
+};
+
+// Função para empilhar uma tarefa no topo da fila da thread
+static bool empilharTarefa(DequeTarefas* deque, TarefaTorneio tarefa) {
+    pthread_mutex_lock(&deque->trava);
+    if (deque->topo == deque->capacidade) {
+        // Reaproveita o espaço já liberado pela base antes de crescer
+        int ocupados = deque->topo - deque->base;
+        if (deque->base > 0) {
+            memmove(deque->itens, deque->itens + deque->base, sizeof(TarefaTorneio) * (size_t) ocupados);
+        }
+        deque->base = 0;
+        deque->topo = ocupados;
+        
+        if (deque->topo == deque->capacidade) {
+            int nova_capacidade = deque->capacidade > 0 ? deque->capacidade * 2 : 64;
+            TarefaTorneio* itens = realocarMemoria(deque->itens, sizeof(TarefaTorneio) * (size_t) nova_capacidade);
+            if (itens == NULL) {
+                pthread_mutex_unlock(&deque->trava);
+                return false;
+            }
+            deque->itens = itens;
+            deque->capacidade = nova_capacidade;
+        }
+    }
+    deque->itens[deque->topo++] = tarefa;
+    pthread_mutex_unlock(&deque->trava);
+    return true;
+}
+
+// Função para retirar uma tarefa: pelo topo (dona) ou pela base (roubo)
+static bool retirarTarefa(DequeTarefas* deque, TarefaTorneio* tarefa, bool roubo) {
+    bool sucesso = false;
+    
+    pthread_mutex_lock(&deque->trava);
+    if (deque->topo > deque->base) {
+        *tarefa = roubo ? deque->itens[deque->base++] : deque->itens[--deque->topo];
+        sucesso = true;
+    }
+    pthread_mutex_unlock(&deque->trava);
+    return sucesso;
+}
+
+// Função para executar uma faixa de partidas, oferecendo metades às outras threads
+static void executarTarefaTorneio(TrabalhadorTorneio* trabalhador, TarefaTorneio tarefa) {
+    Torneio* torneio = trabalhador->torneio;
+    DequeTarefas* deque = &torneio->deques[trabalhador->indice];
+    
+    while (tarefa.fim - tarefa.inicio > GRAO_TORNEIO) {
+        long meio = tarefa.inicio + (tarefa.fim - tarefa.inicio) / 2;
+        TarefaTorneio metade = {tarefa.confronto, meio, tarefa.fim};
+        if (!empilharTarefa(deque, metade)) {
+            break;
+        }
+        tarefa.fim = meio;
+    }
+    
+    EstrategiaTiro* confronto = torneio->confrontos[tarefa.confronto];
+    EstatisticasConfronto* estatisticas = &trabalhador->estatisticas[tarefa.confronto];
+    for (long partida = tarefa.inicio; partida < tarefa.fim; partida++) {
+        uint64_t fluxo = ((uint64_t) tarefa.confronto << 40) | (uint64_t) partida;
+        ResultadoPartida resultado = jogarPartida(confronto[0], confronto[1], torneio->num_navios,
+                                                  torneio->semente, fluxo);
+        if (resultado.vencedor < 0) {
+            torneio->frota_invalida = true;
+            continue;
+        }
+        
+        estatisticas->partidas++;
+        estatisticas->vitorias[resultado.vencedor]++;
+        estatisticas->soma_tiros[resultado.vencedor] += resultado.tiros_vencedor;
+        estatisticas->soma_quadrados_tiros[resultado.vencedor] +=
+            (double) resultado.tiros_vencedor * resultado.tiros_vencedor;
+    }
+    torneio->partidas_restantes -= tarefa.fim - tarefa.inicio;
+}
+
+// Função principal de cada thread do torneio
+static void* executarTrabalhadorTorneio(void* argumento) {
+    TrabalhadorTorneio* trabalhador = argumento;
+    Torneio* torneio = trabalhador->torneio;
+    TarefaTorneio tarefa;
+    
+    while (torneio->partidas_restantes > 0) {
+        if (retirarTarefa(&torneio->deques[trabalhador->indice], &tarefa, false)) {
+            executarTarefaTorneio(trabalhador, tarefa);
+            continue;
+        }
+        
+        // Fila própria vazia: tenta roubar de uma vítima aleatória
+        int vitima = (int) aleatorioAte(&trabalhador->gerador, (uint32_t) torneio->num_threads);
+        if (vitima != trabalhador->indice && retirarTarefa(&torneio->deques[vitima], &tarefa, true)) {
+            executarTarefaTorneio(trabalhador, tarefa);
+        } else {
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+// Função para jogar partidas_por_confronto partidas em cada confronto, usando num_threads threads.
+// estatisticas_saida recebe os totais de cada confronto. Retorna false se faltou memória ou se
+// alguma frota não pôde ser posicionada.
+bool executarTorneio(EstrategiaTiro confrontos[][2], int num_confrontos, long partidas_por_confronto,
+                     int num_navios, int num_threads, uint64_t semente,
+                     EstatisticasConfronto estatisticas_saida[]) {
+    Torneio torneio;
+    memset(&torneio, 0, sizeof(torneio));
+    
+    if (num_threads < 1) {
+        num_threads = obterNumeroNucleos();
+    }
+    inicializarPosicionamentosLegais();
+    inicializarEstenceis();
+    
+    torneio.num_confrontos = num_confrontos;
+    torneio.confrontos = confrontos;
+    torneio.num_navios = num_navios;
+    torneio.semente = semente;
+    torneio.num_threads = num_threads;
+    torneio.partidas_restantes = partidas_por_confronto * num_confrontos;
+    torneio.deques = alocarMemoriaZerada((size_t) num_threads, sizeof(DequeTarefas));
+    torneio.trabalhadores = alocarMemoriaZerada((size_t) num_threads, sizeof(TrabalhadorTorneio));
+    pthread_t* threads = alocarMemoriaZerada((size_t) num_threads, sizeof(pthread_t));
+    EstatisticasConfronto* estatisticas = alocarMemoriaZerada((size_t) num_threads * (size_t) num_confrontos,
+                                                 sizeof(EstatisticasConfronto));
+    bool sucesso = torneio.deques != NULL && torneio.trabalhadores != NULL && threads != NULL && estatisticas != NULL;
+    
+    for (int t = 0; sucesso && t < num_threads; t++) {
+        pthread_mutex_init(&torneio.deques[t].trava, NULL);
+        torneio.trabalhadores[t].torneio = &torneio;
+        torneio.trabalhadores[t].indice = t;
+        torneio.trabalhadores[t].estatisticas = &estatisticas[(size_t) t * (size_t) num_confrontos];
+        semearGerador(&torneio.trabalhadores[t].gerador, semente, (uint64_t) t);
+    }
+    
+    // Distribui cada confronto como uma faixa única; o roubo de trabalho equilibra o resto
+    for (int c = 0; sucesso && c < num_confrontos; c++) {
+        TarefaTorneio tarefa = {c, 0, partidas_por_confronto};
+        sucesso = empilharTarefa(&torneio.deques[c % num_threads], tarefa);
+    }
+    
+    int threads_iniciadas = 1;
+    if (sucesso) {
+        for (int t = 1; t < num_threads; t++) {
+            if (pthread_create(&threads[t], NULL, executarTrabalhadorTorneio, &torneio.trabalhadores[t]) != 0) {
+                break;
+            }
+            threads_iniciadas++;
+        }
+        // Threads que não puderam ser criadas têm suas filas esvaziadas por roubo
+        executarTrabalhadorTorneio(&torneio.trabalhadores[0]);
+        for (int t = 1; t < threads_iniciadas; t++) {
+            pthread_join(threads[t], NULL);
+        }
+        
+        memset(estatisticas_saida, 0, sizeof(EstatisticasConfronto) * (size_t) num_confrontos);
+        for (int t = 0; t < num_threads; t++) {
+            for (int c = 0; c < num_confrontos; c++) {
+                EstatisticasConfronto* origem = &estatisticas[(size_t) t * (size_t) num_confrontos + (size_t) c];
+                estatisticas_saida[c].partidas += origem->partidas;
+                for (int lado = 0; lado < 2; lado++) {
+                    estatisticas_saida[c].vitorias[lado] += origem->vitorias[lado];
+                    estatisticas_saida[c].soma_tiros[lado] += origem->soma_tiros[lado];
+                    estatisticas_saida[c].soma_quadrados_tiros[lado] += origem->soma_quadrados_tiros[lado];
+                }
+            }
+        }
+    }
+    
+    for (int t = 0; torneio.deques != NULL && t < num_threads; t++) {
+        pthread_mutex_destroy(&torneio.deques[t].trava);
+        free(torneio.deques[t].itens);
+    }
+    free(torneio.deques);
+    free(torneio.trabalhadores);
+    free(threads);
+    free(estatisticas);
+    return sucesso && !torneio.frota_invalida;
+}
+
+// Função para calcular o intervalo de confiança de 95% (Wilson) de uma proporção
+void intervaloWilson(long sucessos, long total, double* inferior, double* superior) {
+    if (total == 0) {
+        *inferior = 0.0;
+        *superior = 0.0;
+        return;
+    }
+    
+    const double z = 1.96;
+    double p = (double) sucessos / total;
+    double denominador = 1.0 + z * z / total;
+    double centro = (p + z * z / (2.0 * total)) / denominador;
+    double margem = z * sqrt(p * (1.0 - p) / total + z * z / (4.0 * total * total)) / denominador;
+    *inferior = centro - margem;
+    *superior = centro + margem;
+}
+
+// Função para exibir o relatório do torneio, por estratégia, em CSV
+void exibirRelatorioTorneio(EstrategiaTiro confrontos[][2], int num_confrontos,
+                            const EstatisticasConfronto estatisticas[]) {
+    printf("estrategia,partidas,vitorias,taxa_vitoria,ic95_inferior,ic95_superior,media_tiros_vitoria,ic95_tiros\n");
+    
+    for (int e = 0; e < NUM_ESTRATEGIAS; e++) {
+        long partidas = 0, vitorias = 0;
+        double soma = 0.0, soma_quadrados = 0.0;
+        
+        for (int c = 0; c < num_confrontos; c++) {
+            for (int lado = 0; lado < 2; lado++) {
+                // Um confronto de uma estratégia contra ela mesma conta uma vez por partida
+                if (confrontos[c][lado] != (EstrategiaTiro) e || (lado == 1 && confrontos[c][0] == confrontos[c][1])) {
+                    continue;
+                }
+                partidas += estatisticas[c].partidas;
+                int lados = confrontos[c][0] == confrontos[c][1] ? 2 : 1;
+                for (int l = lado; l < lado + lados; l++) {
+                    vitorias += estatisticas[c].vitorias[l];
+                    soma += estatisticas[c].soma_tiros[l];
+                    soma_quadrados += estatisticas[c].soma_quadrados_tiros[l];
+                }
+            }
+        }
+        if (partidas == 0) {
+            continue;
+        }
+        
+        double inferior, superior;
+        intervaloWilson(vitorias, partidas, &inferior, &superior);
+        double media = vitorias > 0 ? soma / vitorias : 0.0;
+        double variancia = vitorias > 1 ? (soma_quadrados - soma * media) / (vitorias - 1) : 0.0;
+        double margem = vitorias > 1 ? 1.96 * sqrt(variancia / vitorias) : 0.0;
+        
+        printf("%s,%ld,%ld,%.4f,%.4f,%.4f,%.2f,%.2f\n", obterNomeEstrategia(e), partidas, vitorias,
+               (double) vitorias / partidas, inferior, superior, media, margem);
+    }
+}
+
+// =====================================================================
+// RENDERIZADOR DE TERMINAL POR DIFERENÇAS
+// =====================================================================
+
+// Geometria do quadro: título, legenda e cabeçalho ocupam as primeiras linhas da tela
+#define LINHA_INICIAL_RENDERIZACAO 5
+#define COLUNA_INICIAL_RENDERIZACAO 5
+#define LARGURA_CELULA_RENDERIZACAO 3
+
+// Renderizador que guarda o último quadro exibido e só redesenha as células que mudaram
+typedef struct {
+    int linhas;
+    int colunas;
+    char* quadro_anterior;
+    bool quadro_completo_pendente;
+    BufferSaida buffer;
+} RenderizadorTerminal;
+
+// Função para criar um renderizador para quadros de linhas x colunas caracteres
+bool criarRenderizador(RenderizadorTerminal* renderizador, int linhas, int colunas) {
+    memset(renderizador, 0, sizeof(*renderizador));
+    renderizador->linhas = linhas;
+    renderizador->colunas = colunas;
+    renderizador->quadro_anterior = alocarMemoria((size_t) linhas * (size_t) colunas);
+    renderizador->quadro_completo_pendente = true;
+    return renderizador->quadro_anterior != NULL;
+}
+
+// Função para liberar o renderizador
+void destruirRenderizador(RenderizadorTerminal* renderizador) {
+    free(renderizador->quadro_anterior);
+    liberarBufferSaida(&renderizador->buffer);
+    memset(renderizador, 0, sizeof(*renderizador));
+}
+
+// Função para posicionar o cursor (linha e coluna começam em 1, como no ANSI)
+static void moverCursorBuffer(BufferSaida* buffer, int linha, int coluna) {
+    formatarBufferSaida(buffer, "\x1b[%d;%dH", linha, coluna);
+}
+
+// Função para renderizar um quadro (um caractere por célula, em ordem de linhas).
+// O primeiro quadro é desenhado por inteiro; os seguintes só reescrevem as células alteradas.
+// O rodapé (opcional) é reescrito a cada quadro logo abaixo do tabuleiro.
+void renderizarQuadro(RenderizadorTerminal* renderizador, const char* titulo, const char* quadro,
+                      const char* rodape) {
+    BufferSaida* buffer = &renderizador->buffer;
+    int linhas = renderizador->linhas;
+    int colunas = renderizador->colunas;
+    
+    if (renderizador->quadro_completo_pendente) {
+        anexarBufferSaida(buffer, "\x1b[H\x1b[2J", 7);
+        formatarBufferSaida(buffer, "=== %s ===\n", titulo);
+        formatarBufferSaida(buffer, "Legenda: ~ = Água, # = Navio, X = Acerto, o = Erro\n\n");
+        anexarBufferSaida(buffer, "    ", 4);
+        for (int j = 0; j < colunas; j++) {
+            formatarBufferSaida(buffer, "%2d ", j % 100);
+        }
+        anexarBufferSaida(buffer, "\n", 1);
+        
+        for (int i = 0; i < linhas; i++) {
+            formatarBufferSaida(buffer, "%3d|", i % 1000);
+            for (int j = 0; j < colunas; j++) {
+                char celula[3] = {' ', quadro[i * colunas + j], ' '};
+                anexarBufferSaida(buffer, celula, sizeof(celula));
+            }
+            anexarBufferSaida(buffer, "\n", 1);
+        }
+        renderizador->quadro_completo_pendente = false;
+    } else {
+        for (int i = 0; i < linhas; i++) {
+            int ultima_coluna_escrita = -2;
+            for (int j = 0; j < colunas; j++) {
+                int indice = i * colunas + j;
+                if (quadro[indice] == renderizador->quadro_anterior[indice]) {
+                    continue;
+                }
+                
+                // Células vizinhas na mesma linha aproveitam a posição atual do cursor
+                if (j != ultima_coluna_escrita + 1) {
+                    moverCursorBuffer(buffer, LINHA_INICIAL_RENDERIZACAO + i,
+                                      COLUNA_INICIAL_RENDERIZACAO + j * LARGURA_CELULA_RENDERIZACAO + 1);
+                    anexarBufferSaida(buffer, &quadro[indice], 1);
+                } else {
+                    char celula[3] = {' ', ' ', quadro[indice]};
+                    anexarBufferSaida(buffer, celula, sizeof(celula));
+                }
+                ultima_coluna_escrita = j;
+            }
+        }
+    }
+    
+    if (rodape != NULL) {
+        moverCursorBuffer(buffer, LINHA_INICIAL_RENDERIZACAO + linhas + 1, 1);
+        formatarBufferSaida(buffer, "\x1b[2K%s", rodape);
+    }
+    moverCursorBuffer(buffer, LINHA_INICIAL_RENDERIZACAO + linhas + 2, 1);
+    
+    memcpy(renderizador->quadro_anterior, quadro, (size_t) linhas * (size_t) colunas);
+    descarregarBufferSaida(buffer);
+}
+
+// Função para montar o quadro de uma partida vista pelo atirador (navios revelados, tiros marcados)
+void montarQuadroPartida(const TabuleiroBits* tabuleiro, const EstadoTiros* tiros, char quadro[TOTAL_CELULAS]) {
+    for (int c = 0; c < TOTAL_CELULAS; c++) {
+        if (mascaraTestarCelula(tiros->acertos, c)) {
+            quadro[c] = 'X';
+        } else if (mascaraTestarCelula(tiros->erros, c)) {
+            quadro[c] = 'o';
+        } else {
+            quadro[c] = obterCaractereVisual(mascaraTestarCelula(tabuleiro->navios, c) ? NAVIO : AGUA);
+        }
+    }
+}
+
+// Função para assistir, ao vivo, uma estratégia atacando uma frota aleatória (false se a frota não pôde ser posicionada)
+bool assistirPartida(EstrategiaTiro estrategia, uint64_t semente, int atraso_ms) {
+    GeradorAleatorio gerador;
+    TabuleiroBits tabuleiro;
+    Navio navios[MAX_NAVIOS_FROTA];
+    Atirador atirador;
+    RenderizadorTerminal renderizador;
+    char quadro[TOTAL_CELULAS];
+    char rodape[128];
+    
+    semearGerador(&gerador, semente, 0);
+    if (gerarFrotaAleatoria(&gerador, NAVIOS_PADRAO_PARTIDA, navios, &tabuleiro) == 0) {
+        fprintf(stderr, "ERRO: não foi possível posicionar %d navios\n", NAVIOS_PADRAO_PARTIDA);
+        return false;
+    }
+    if (!criarRenderizador(&renderizador, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return false;
+    }
+    inicializarAtirador(&atirador, estrategia, NAVIOS_PADRAO_PARTIDA, proximoAleatorio(&gerador));
+    
+    int celulas_navio = contarNaviosBits(&tabuleiro);
+    int tiros = 0;
+    struct timespec espera = {atraso_ms / 1000, (atraso_ms % 1000) * 1000000L};
+    
+    montarQuadroPartida(&tabuleiro, &atirador.tiros, quadro);
+    renderizarQuadro(&renderizador, obterNomeEstrategia(estrategia), quadro, "Tiros: 0");
+    
+    while (mascaraContar(atirador.tiros.acertos) < celulas_navio) {
+        int celula = escolherTiro(&atirador);
+        registrarTiro(&atirador, celula, mascaraTestarCelula(tabuleiro.navios, celula));
+        tiros++;
+        
+        snprintf(rodape, sizeof(rodape), "Tiros: %d  Acertos: %d/%d", tiros,
+                 mascaraContar(atirador.tiros.acertos), celulas_navio);
+        montarQuadroPartida(&tabuleiro, &atirador.tiros, quadro);
+        renderizarQuadro(&renderizador, obterNomeEstrategia(estrategia), quadro, rodape);
+        
+        if (atraso_ms > 0) {
+            nanosleep(&espera, NULL);
+        }
+    }
+    destruirRenderizador(&renderizador);
+    return true;
+}
+
+// =====================================================================
+// TRANSMISSÃO COM NEBLINA DE GUERRA (MEMÓRIA COMPARTILHADA E VISÕES)
+// =====================================================================
+
+// A partida é publicada uma única vez, num arquivo mapeado em memória compartilhada, protegida por
+// um seqlock: o jogo nunca espera pelos espectadores, que releem se pegarem uma escrita pela metade.
+// Sem nada novo, o espectador dorme num futex na própria sequência, e cada publicação o acorda.
+// Cada espectador (ou jogador) tem só uma visão fina por cima desse estado comum: o papel, que decide
+// o que a neblina esconde, e anotações próprias em blocos 5x5 com cópia na escrita. Visões clonadas
+// compartilham os blocos até que uma delas anote; sem anotações, todas apontam para o bloco vazio.
+
+#define MAGICA_TRANSMISSAO "BNTV"
+#define ESPERA_MAXIMA_ESPECTADOR_MS 50
+#define VERSAO_TRANSMISSAO 1
+#define PALAVRAS_TRANSMISSAO 13
+#define LADO_BLOCO_ANOTACAO 5
+#define BLOCOS_ANOTACAO (TAMANHO_TABULEIRO / LADO_BLOCO_ANOTACAO * (TAMANHO_TABULEIRO / LADO_BLOCO_ANOTACAO))
+
+_Static_assert(TAMANHO_TABULEIRO % LADO_BLOCO_ANOTACAO == 0, "os blocos de anotação devem cobrir o tabuleiro");
+
+// Quem olha a partida: cada jogador vê o próprio tabuleiro inteiro; o espectador só o que foi revelado
+typedef enum {
+    PAPEL_JOGADOR_A,
+    PAPEL_JOGADOR_B,
+    PAPEL_ESPECTADOR,
+    PAPEL_ARBITRO,
+    NUM_PAPEIS
+} PapelVisao;
+
+// Estado comum da partida: o tabuleiro b pertence ao jogador b
+typedef struct {
+    Mascara128 navios[2];
+    EstadoTiros tiros[2];       // Tiros recebidos por cada tabuleiro
+    uint32_t lance;             // Tiros disparados até agora
+    int32_t vencedor;           // -1 enquanto a partida não acabou
+} EstadoPartidaPublicado;
+
+// Região compartilhada. Os dados são palavras atômicas lidas e escritas sem trava; a sequência é
+// ímpar durante uma publicação e muda a cada uma.
+typedef struct {
+    char magica[4];
+    uint32_t versao;
+    _Atomic uint32_t sequencia;
+    uint32_t reservado;
+    _Atomic uint64_t palavras[PALAVRAS_TRANSMISSAO];
+} TransmissaoPartida;
+
+typedef struct {
+    atomic_int referencias;     // 0 no bloco vazio compartilhado, que nunca é liberado
+    char celulas[LADO_BLOCO_ANOTACAO][LADO_BLOCO_ANOTACAO];
+} BlocoAnotacao;
+
+typedef struct {
+    PapelVisao papel;
+    BlocoAnotacao* blocos[2][BLOCOS_ANOTACAO];
+} VisaoPartida;
+
+static BlocoAnotacao blocoAnotacaoVazio;
+
+// Função para obter o nome de um papel
+const char* obterNomePapel(PapelVisao papel) {
+    switch (papel) {
+        case PAPEL_JOGADOR_A: return "jogador-a";
+        case PAPEL_JOGADOR_B: return "jogador-b";
+        case PAPEL_ESPECTADOR: return "espectador";
+        case PAPEL_ARBITRO: return "arbitro";
+        default: return "?";
+    }
+}
+
+// Função para converter o nome de um papel (-1 se desconhecido)
+int lerNomePapel(const char* nome) {
+    for (int p = 0; p < NUM_PAPEIS; p++) {
+        if (strcmp(nome, obterNomePapel(p)) == 0) {
+            return p;
+        }
+    }
+    return -1;
+}
+
+// Função para mapear uma transmissão; criar = true prepara um arquivo novo para escrita
+static TransmissaoPartida* mapearTransmissao(const char* caminho, bool criar) {
+    int descritor = criar ? open(caminho, O_RDWR | O_CREAT | O_TRUNC, 0644) : open(caminho, O_RDONLY);
+    if (descritor < 0) {
+        return NULL;
+    }
+    
+    struct stat informacoes;
+    if (criar ? ftruncate(descritor, sizeof(TransmissaoPartida)) != 0
+              : fstat(descritor, &informacoes) != 0 || (size_t) informacoes.st_size < sizeof(TransmissaoPartida)) {
+        close(descritor);
+        return NULL;
+    }
+    
+    void* mapa = mmap(NULL, sizeof(TransmissaoPartida), criar ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED,
+                      descritor, 0);
+    close(descritor);
+    if (mapa == MAP_FAILED) {
+        return NULL;
+    }
+    
+    TransmissaoPartida* transmissao = mapa;
+    if (criar) {
+        // O arquivo recém-truncado já está zerado: sequência 0 e nenhum navio
+        memcpy(transmissao->magica, MAGICA_TRANSMISSAO, 4);
+        transmissao->versao = VERSAO_TRANSMISSAO;
+    } else if (memcmp(transmissao->magica, MAGICA_TRANSMISSAO, 4) != 0 || transmissao->versao != VERSAO_TRANSMISSAO) {
+        munmap(mapa, sizeof(TransmissaoPartida));
+        return NULL;
+    }
+    return transmissao;
+}
+
+TransmissaoPartida* criarTransmissao(const char* caminho) {
+    return mapearTransmissao(caminho, true);
+}
+
+TransmissaoPartida* abrirTransmissao(const char* caminho) {
+    return mapearTransmissao(caminho, false);
+}
+
+void fecharTransmissao(TransmissaoPartida* transmissao) {
+    munmap(transmissao, sizeof(TransmissaoPartida));
+}
+
+// Função para acordar todos os que esperam uma nova publicação (não bloqueia).
+// O futex não é privado: a sequência vive num arquivo mapeado e pode ser esperada por outros processos.
+static void acordarEspectadores(TransmissaoPartida* transmissao) {
+    syscall(SYS_futex, (void*) &transmissao->sequencia, FUTEX_WAKE, INT_MAX, NULL, NULL, 0);
+}
+
+// Função para dormir enquanto a sequência ainda for 'vista', por no máximo 'milissegundos'
+static void esperarPublicacao(const TransmissaoPartida* transmissao, uint32_t vista, int milissegundos) {
+    struct timespec prazo = {milissegundos / 1000, (milissegundos % 1000) * 1000000L};
+    syscall(SYS_futex, (void*) &transmissao->sequencia, FUTEX_WAIT, vista, &prazo, NULL, 0);
+}
+
+// Função para publicar o estado (um único escritor); nunca bloqueia
+void publicarEstadoPartida(TransmissaoPartida* transmissao, const EstadoPartidaPublicado* estado) {
+    uint64_t palavras[PALAVRAS_TRANSMISSAO] = {
+        estado->navios[0].baixo, estado->navios[0].alto, estado->navios[1].baixo, estado->navios[1].alto,
+        estado->tiros[0].acertos.baixo, estado->tiros[0].acertos.alto,
+        estado->tiros[0].erros.baixo, estado->tiros[0].erros.alto,
+        estado->tiros[1].acertos.baixo, estado->tiros[1].acertos.alto,
+        estado->tiros[1].erros.baixo, estado->tiros[1].erros.alto,
+        (uint64_t) estado->lance | (uint64_t) (uint32_t) (estado->vencedor + 1) << 32
+    };
+    
+    uint32_t sequencia = atomic_load_explicit(&transmissao->sequencia, memory_order_relaxed);
+    atomic_store_explicit(&transmissao->sequencia, sequencia + 1, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    for (int p = 0; p < PALAVRAS_TRANSMISSAO; p++) {
+        atomic_store_explicit(&transmissao->palavras[p], palavras[p], memory_order_relaxed);
+    }
+    atomic_store_explicit(&transmissao->sequencia, sequencia + 2, memory_order_release);
+    acordarEspectadores(transmissao);
+}
+
+// Função para ler um retrato consistente do estado; devolve a sequência lida (sempre par).
+// releituras (pode ser NULL) acumula quantas vezes foi preciso reler por causa de uma publicação.
+uint32_t lerEstadoPartida(const TransmissaoPartida* transmissao, EstadoPartidaPublicado* estado, long* releituras) {
+    uint64_t palavras[PALAVRAS_TRANSMISSAO];
+    uint32_t inicio, fim;
+    
+    while (true) {
+        inicio = atomic_load_explicit(&transmissao->sequencia, memory_order_acquire);
+        if ((inicio & 1) == 0) {
+            for (int p = 0; p < PALAVRAS_TRANSMISSAO; p++) {
+                palavras[p] = atomic_load_explicit(&transmissao->palavras[p], memory_order_relaxed);
+            }
+            atomic_thread_fence(memory_order_acquire);
+            fim = atomic_load_explicit(&transmissao->sequencia, memory_order_relaxed);
+            if (fim == inicio) {
+                break;
+            }
+        }
+        if (releituras != NULL) {
+            (*releituras)++;
+        }
+        sched_yield();
+    }
+    
+    for (int b = 0; b < 2; b++) {
+        estado->navios[b].baixo = palavras[2 * b];
+        estado->navios[b].alto = palavras[2 * b + 1];
+        estado->tiros[b].acertos.baixo = palavras[4 + 4 * b];
+        estado->tiros[b].acertos.alto = palavras[5 + 4 * b];
+        estado->tiros[b].erros.baixo = palavras[6 + 4 * b];
+        estado->tiros[b].erros.alto = palavras[7 + 4 * b];
+    }
+    estado->lance = (uint32_t) palavras[12];
+    estado->vencedor = (int32_t) (palavras[12] >> 32) - 1;
+    return inicio;
+}
+
+// Função para criar uma visão sem anotações (todos os blocos apontam para o bloco vazio)
+void inicializarVisao(VisaoPartida* visao, PapelVisao papel) {
+    visao->papel = papel;
+    for (int b = 0; b < 2; b++) {
+        for (int k = 0; k < BLOCOS_ANOTACAO; k++) {
+            visao->blocos[b][k] = &blocoAnotacaoVazio;
+        }
+    }
+}
+
+// Função para criar uma visão que compartilha as anotações de outra (cópia só na escrita)
+void clonarVisao(VisaoPartida* destino, const VisaoPartida* origem, PapelVisao papel) {
+    destino->papel = papel;
+    for (int b = 0; b < 2; b++) {
+        for (int k = 0; k < BLOCOS_ANOTACAO; k++) {
+            destino->blocos[b][k] = origem->blocos[b][k];
+            if (destino->blocos[b][k] != &blocoAnotacaoVazio) {
+                atomic_fetch_add_explicit(&destino->blocos[b][k]->referencias, 1, memory_order_relaxed);
+            }
+        }
+    }
+}
+
+void liberarVisao(VisaoPartida* visao) {
+    for (int b = 0; b < 2; b++) {
+        for (int k = 0; k < BLOCOS_ANOTACAO; k++) {
+            BlocoAnotacao* bloco = visao->blocos[b][k];
+            if (bloco != &blocoAnotacaoVazio &&
+                atomic_fetch_sub_explicit(&bloco->referencias, 1, memory_order_acq_rel) == 1) {
+                free(bloco);
+            }
+            visao->blocos[b][k] = &blocoAnotacaoVazio;
+        }
+    }
+}
+
+// Função para anotar uma marca (0 apaga) numa célula da visão; copia o bloco se ele é compartilhado.
+// Um bloco compartilhado nunca é alterado, então visões clonadas podem anotar em threads diferentes.
+bool anotarVisao(VisaoPartida* visao, int tabuleiro, int linha, int coluna, char marca) {
+    if (tabuleiro < 0 || tabuleiro > 1 ||
+        !celulaDentroDosLimites(linha, coluna, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        return false;
+    }
+    
+    int k = (linha / LADO_BLOCO_ANOTACAO) * (TAMANHO_TABULEIRO / LADO_BLOCO_ANOTACAO) + coluna / LADO_BLOCO_ANOTACAO;
+    BlocoAnotacao* bloco = visao->blocos[tabuleiro][k];
+    if (bloco == &blocoAnotacaoVazio || atomic_load_explicit(&bloco->referencias, memory_order_acquire) > 1) {
+        BlocoAnotacao* copia = alocarMemoria(sizeof(BlocoAnotacao));
+        if (copia == NULL) {
+            return false;
+        }
+        memcpy(copia->celulas, bloco->celulas, sizeof(copia->celulas));
+        atomic_init(&copia->referencias, 1);
+        if (bloco != &blocoAnotacaoVazio &&
+            atomic_fetch_sub_explicit(&bloco->referencias, 1, memory_order_acq_rel) == 1) {
+            free(bloco);    // As outras visões soltaram o bloco enquanto ele era copiado
+        }
+        visao->blocos[tabuleiro][k] = bloco = copia;
+    }
+    bloco->celulas[linha % LADO_BLOCO_ANOTACAO][coluna % LADO_BLOCO_ANOTACAO] = marca;
+    return true;
+}
+
+// Função para estimar a memória própria de uma visão (blocos compartilhados contam em fração)
+double memoriaVisao(const VisaoPartida* visao) {
+    double bytes = sizeof(VisaoPartida);
+    for (int b = 0; b < 2; b++) {
+        for (int k = 0; k < BLOCOS_ANOTACAO; k++) {
+            if (visao->blocos[b][k] != &blocoAnotacaoVazio) {
+                bytes += (double) sizeof(BlocoAnotacao) /
+                         atomic_load_explicit(&visao->blocos[b][k]->referencias, memory_order_relaxed);
+            }
+        }
+    }
+    return bytes;
+}
+
+// Função para montar os dois tabuleiros como a visão os enxerga:
+// X acerto, o água atingida, # navio visível, ~ água visível, ? neblina (ou a anotação da visão)
+void montarQuadroVisao(const EstadoPartidaPublicado* estado, const VisaoPartida* visao,
+                       char quadro[2][TOTAL_CELULAS]) {
+    for (int b = 0; b < 2; b++) {
+        bool tudo_visivel = visao->papel == PAPEL_ARBITRO || (int) visao->papel == b;
+        for (int c = 0; c < TOTAL_CELULAS; c++) {
+            int linha = c / TAMANHO_TABULEIRO;
+            int coluna = c % TAMANHO_TABULEIRO;
+            const BlocoAnotacao* bloco = visao->blocos[b][(linha / LADO_BLOCO_ANOTACAO) * (TAMANHO_TABULEIRO / LADO_BLOCO_ANOTACAO)
+                                                          + coluna / LADO_BLOCO_ANOTACAO];
+            char anotacao = bloco->celulas[linha % LADO_BLOCO_ANOTACAO][coluna % LADO_BLOCO_ANOTACAO];
+            
+            if (mascaraTestarCelula(estado->tiros[b].acertos, c)) {
+                quadro[b][c] = 'X';
+            } else if (mascaraTestarCelula(estado->tiros[b].erros, c)) {
+                quadro[b][c] = 'o';
+            } else if (tudo_visivel) {
+                quadro[b][c] = mascaraTestarCelula(estado->navios[b], c) ? '#' : '~';
+            } else {
+                quadro[b][c] = anotacao != 0 ? anotacao : '?';
+            }
+        }
+    }
+}
+
+// Função para exibir os dois tabuleiros de uma visão lado a lado
+void exibirQuadroVisao(const char quadro[2][TOTAL_CELULAS], FILE* saida) {
+    for (int linha = 0; linha < TAMANHO_TABULEIRO; linha++) {
+        for (int b = 0; b < 2; b++) {
+            fprintf(saida, b == 0 ? "%2d " : "    %2d ", linha);
+            for (int coluna = 0; coluna < TAMANHO_TABULEIRO; coluna++) {
+                fprintf(saida, "%c ", quadro[b][linha * TAMANHO_TABULEIRO + coluna]);
+            }
+        }
+        fputc('\n', saida);
+    }
+}
+
+// Função para conferir as invariantes de um retrato: tiros coerentes com as frotas e com o lance
+bool estadoPartidaConsistente(const EstadoPartidaPublicado* estado) {
+    int disparados = 0;
+    
+    for (int b = 0; b < 2; b++) {
+        if (!mascaraEhVazia(mascaraENao(estado->tiros[b].acertos, estado->navios[b])) ||
+            mascaraSeCruzam(estado->tiros[b].erros, estado->navios[b])) {
+            return false;
+        }
+        disparados += mascaraContar(estado->tiros[b].acertos) + mascaraContar(estado->tiros[b].erros);
+    }
+    if (disparados != (int) estado->lance) {
+        return false;
+    }
+    
+    // O vencedor afundou todos os navios do tabuleiro adversário
+    return estado->vencedor < 0 ||
+           (estado->vencedor <= 1 &&
+            mascaraContar(estado->tiros[1 - estado->vencedor].acertos) == mascaraContar(estado->navios[1 - estado->vencedor]));
+}
+
+// Dados de cada thread espectadora
+typedef struct {
+    const TransmissaoPartida* transmissao;
+    const atomic_bool* encerrada;   // A partida acabou ou foi abandonada: não haverá novos quadros
+    VisaoPartida visao;
+    bool anotar;                // Marca palpites na neblina (exercita a cópia na escrita)
+    uint64_t semente;
+    long quadros;
+    long releituras;
+    long inconsistencias;
+} TrabalhoEspectador;
+
+// Cada espectador acompanha a transmissão até o fim, sem nunca bloquear o jogo,
+// e confere cada retrato lido e o que a neblina deixa passar para o seu papel
+static void* executarEspectador(void* argumento) {
+    TrabalhoEspectador* trabalho = argumento;
+    EstadoPartidaPublicado estado;
+    GeradorAleatorio gerador;
+    char quadro[2][TOTAL_CELULAS];
+    uint32_t ultima = 0;    // Sequência 0: nada publicado ainda
+    
+    semearGerador(&gerador, trabalho->semente, 0);
+    
+    while (true) {
+        // Lê o aviso antes do retrato: se já estava encerrada, o último quadro publicado está visível
+        bool encerrada = atomic_load(trabalho->encerrada);
+        uint32_t sequencia = lerEstadoPartida(trabalho->transmissao, &estado, &trabalho->releituras);
+        if (sequencia == ultima) {
+            if (encerrada) {
+                return NULL;
+            }
+            // O prazo cobre o aviso de encerramento, que não passa pela sequência
+            esperarPublicacao(trabalho->transmissao, sequencia, ESPERA_MAXIMA_ESPECTADOR_MS);
+            continue;
+        }
+        ultima = sequencia;
+        trabalho->quadros++;
+        
+        montarQuadroVisao(&estado, &trabalho->visao, quadro);
+        bool consistente = estadoPartidaConsistente(&estado);
+        for (int b = 0; b < 2 && consistente; b++) {
+            bool tudo_visivel = trabalho->visao.papel == PAPEL_ARBITRO || (int) trabalho->visao.papel == b;
+            for (int c = 0; c < TOTAL_CELULAS; c++) {
+                // Navio intacto do adversário nunca aparece através da neblina
+                if (!tudo_visivel && quadro[b][c] == '#') {
+                    consistente = false;
+                }
+            }
+        }
+        if (!consistente) {
+            trabalho->inconsistencias++;
+        }
+        
+        // Palpite numa célula ainda encoberta do tabuleiro de um dos jogadores
+        if (trabalho->anotar && trabalho->visao.papel != PAPEL_ARBITRO) {
+            int b = trabalho->visao.papel == PAPEL_JOGADOR_A ? 1
+                  : trabalho->visao.papel == PAPEL_JOGADOR_B ? 0
+                  : (int) aleatorioAte(&gerador, 2);
+            int c = (int) aleatorioAte(&gerador, TOTAL_CELULAS);
+            if (quadro[b][c] == '?') {
+                anotarVisao(&trabalho->visao, b, c / TAMANHO_TABULEIRO, c % TAMANHO_TABULEIRO, '*');
+            }
+        }
+        
+        if (estado.vencedor >= 0) {
+            return NULL;
+        }
+    }
+}
+
+// Função para jogar uma partida caça-alvo contra caça-alvo publicando o estado a cada tiro.
+// Retorna vencedor -1, sem publicar nada, se alguma frota não pôde ser posicionada.
+ResultadoPartida transmitirPartida(TransmissaoPartida* transmissao, uint64_t semente, int atraso_ms) {
+    GeradorAleatorio gerador;
+    TabuleiroBits tabuleiros[2];
+    Navio navios[MAX_NAVIOS_FROTA];
+    Atirador atiradores[2];
+    EstadoPartidaPublicado estado;
+    int tiros[2] = {0, 0};
+    struct timespec espera = {atraso_ms / 1000, (atraso_ms % 1000) * 1000000L};
+    
+    semearGerador(&gerador, semente, 0);
+    for (int b = 0; b < 2; b++) {
+        if (gerarFrotaAleatoria(&gerador, NAVIOS_PADRAO_PARTIDA, navios, &tabuleiros[b]) == 0) {
+            ResultadoPartida resultado = {-1, 0};
+            return resultado;
+        }
+        inicializarAtirador(&atiradores[b], ESTRATEGIA_CACA_ALVO, NAVIOS_PADRAO_PARTIDA, proximoAleatorio(&gerador));
+        estado.navios[b] = tabuleiros[b].navios;
+        inicializarEstadoTiros(&estado.tiros[b]);
+    }
+    estado.lance = 0;
+    estado.vencedor = -1;
+    publicarEstadoPartida(transmissao, &estado);
+    
+    int vez = 0;
+    while (true) {
+        Atirador* atirador = &atiradores[vez];
+        int celula = escolherTiro(atirador);
+        registrarTiro(atirador, celula, mascaraTestarCelula(tabuleiros[1 - vez].navios, celula));
+        tiros[vez]++;
+        
+        // Os tiros de um jogador são os tiros recebidos pelo tabuleiro do outro
+        estado.tiros[1 - vez] = atirador->tiros;
+        estado.lance++;
+        bool venceu = mascaraContar(atirador->tiros.acertos) == mascaraContar(tabuleiros[1 - vez].navios);
+        if (venceu) {
+            estado.vencedor = vez;
+        }
+        publicarEstadoPartida(transmissao, &estado);
+        
+        if (venceu) {
+            ResultadoPartida resultado = {vez, tiros[vez]};
+            return resultado;
+        }
+        if (atraso_ms > 0) {
+            nanosleep(&espera, NULL);
+        }
+        vez = 1 - vez;
+    }
+}
+
+// Função para transmitir uma partida a várias threads espectadoras, cada uma com sua visão, e
+// relatar por papel os quadros vistos, as releituras do seqlock e a memória gasta pelas visões
+bool executarTransmissao(const char* caminho, int num_espectadores, uint64_t semente, int atraso_ms) {
+    if (num_espectadores < 1) {
+        num_espectadores = 1;
+    }
+    TransmissaoPartida* transmissao = criarTransmissao(caminho);
+    if (transmissao == NULL) {
+        return false;
+    }
+    TrabalhoEspectador* trabalhos = alocarMemoriaZerada((size_t) num_espectadores, sizeof(TrabalhoEspectador));
+    pthread_t* threads = alocarMemoria(sizeof(pthread_t) * (size_t) num_espectadores);
+    if (trabalhos == NULL || threads == NULL) {
+        free(trabalhos);
+        free(threads);
+        fecharTransmissao(transmissao);
+        return false;
+    }
+    
+    // Os primeiros espectadores de cada papel partem do zero; os demais clonam a visão do primeiro
+    // do mesmo papel, e metade deles anota palpites (só esses pagam por blocos próprios)
+    atomic_bool encerrada = false;
+    int iniciadas = 0;
+    for (int t = 0; t < num_espectadores; t++) {
+        trabalhos[t].transmissao = transmissao;
+        trabalhos[t].encerrada = &encerrada;
+        trabalhos[t].anotar = t / NUM_PAPEIS % 2 == 1;
+        trabalhos[t].semente = semente + (uint64_t) t;
+        if (t < NUM_PAPEIS) {
+            inicializarVisao(&trabalhos[t].visao, (PapelVisao) t);
+        } else {
+            clonarVisao(&trabalhos[t].visao, &trabalhos[t % NUM_PAPEIS].visao, (PapelVisao) (t % NUM_PAPEIS));
+        }
+    }
+    for (int t = 0; t < num_espectadores; t++) {
+        if (pthread_create(&threads[t], NULL, executarEspectador, &trabalhos[t]) != 0) {
+            break;
+        }
+        iniciadas++;
+    }
+    
+    double inicio = segundosMonotonicos();
+    ResultadoPartida resultado = transmitirPartida(transmissao, semente, atraso_ms);
+    double duracao = segundosMonotonicos() - inicio;
+    atomic_store(&encerrada, true);
+    acordarEspectadores(transmissao);
+    
+    long quadros[NUM_PAPEIS] = {0}, releituras[NUM_PAPEIS] = {0}, inconsistencias[NUM_PAPEIS] = {0};
+    int visoes[NUM_PAPEIS] = {0};
+    double memoria[NUM_PAPEIS] = {0};
+    for (int t = 0; t < iniciadas; t++) {
+        pthread_join(threads[t], NULL);
+    }
+    for (int t = 0; t < num_espectadores; t++) {
+        int papel = trabalhos[t].visao.papel;
+        visoes[papel]++;
+        quadros[papel] += trabalhos[t].quadros;
+        releituras[papel] += trabalhos[t].releituras;
+        inconsistencias[papel] += trabalhos[t].inconsistencias;
+        memoria[papel] += memoriaVisao(&trabalhos[t].visao);
+    }
+    
+    printf("papel,visoes,quadros,releituras,inconsistencias,bytes_por_visao\n");
+    double memoria_total = 0;
+    for (int p = 0; p < NUM_PAPEIS; p++) {
+        if (visoes[p] > 0) {
+            printf("%s,%d,%ld,%ld,%ld,%.1f\n", obterNomePapel(p), visoes[p], quadros[p], releituras[p],
+                   inconsistencias[p], memoria[p] / visoes[p]);
+            memoria_total += memoria[p];
+        }
+    }
+    if (resultado.vencedor >= 0) {
+        fprintf(stderr, "Vencedor: jogador %c em %d tiros (%.3f s, %d espectadores)\n", 'a' + resultado.vencedor,
+                resultado.tiros_vencedor, duracao, iniciadas);
+    } else {
+        fprintf(stderr, "ERRO: não foi possível posicionar %d navios\n", NAVIOS_PADRAO_PARTIDA);
+    }
+    fprintf(stderr, "Memória das visões: %.0f bytes (cópias completas dos dois tabuleiros: %zu bytes)\n",
+            memoria_total, (size_t) num_espectadores * 2 * TOTAL_CELULAS * sizeof(int));
+    
+    bool sucesso = iniciadas == num_espectadores && resultado.vencedor >= 0;
+    for (int t = 0; t < num_espectadores; t++) {
+        sucesso = sucesso && trabalhos[t].inconsistencias == 0;
+        liberarVisao(&trabalhos[t].visao);
+    }
+    free(trabalhos);
+    free(threads);
+    fecharTransmissao(transmissao);
+    return sucesso;
+}
+
+// Função para exibir, de outro processo, o estado atual de uma transmissão como um papel o enxerga
+bool espiarTransmissao(const char* caminho, PapelVisao papel) {
+    TransmissaoPartida* transmissao = abrirTransmissao(caminho);
+    if (transmissao == NULL) {
+        return false;
+    }
+    EstadoPartidaPublicado estado;
+    VisaoPartida visao;
+    char quadro[2][TOTAL_CELULAS];
+    
+    uint32_t sequencia = lerEstadoPartida(transmissao, &estado, NULL);
+    fecharTransmissao(transmissao);
+    
+    inicializarVisao(&visao, papel);
+    montarQuadroVisao(&estado, &visao, quadro);
+    printf("Visão: %s  Lance: %u  Publicação: %u", obterNomePapel(papel), estado.lance, sequencia / 2);
+    if (estado.vencedor >= 0) {
+        printf("  Vencedor: jogador %c", 'a' + estado.vencedor);
+    }
+    printf("\n\n   Tabuleiro A              Tabuleiro B\n");
+    exibirQuadroVisao(quadro, stdout);
+    return true;
+}
+
+// =====================================================================
+// INSTANTÂNEOS BINÁRIOS (GRAVAÇÃO COMPACTA E LEITURA COM MMAP)
+// =====================================================================
+
+// Formato (versão 1, inteiros na ordem de bytes da máquina, little-endian nas plataformas alvo):
+//   cabeçalho de 40 bytes
+//   num_navios registros de 12 bytes (linha, coluna, orientação)
+//   num_habilidades registros de 12 bytes (linha de origem, coluna de origem, tipo)
+//   células com 2 bits cada, 4 por byte, em ordem de linhas (0 = água, 1 = navio, 2 = efeito)
+// Todas as seções ficam alinhadas a 4 bytes, então um arquivo mapeado pode ser lido no lugar,
+// sem cópia. O CRC-32 cobre tudo o que vem depois do cabeçalho.
+
+#define MAGICA_INSTANTANEO "BNAV"
+#define VERSAO_INSTANTANEO 1
+#define BITS_POR_CELULA_INSTANTANEO 2
+
+typedef struct {
+    char magica[4];
+    uint16_t versao;
+    uint16_t bits_por_celula;
+    uint32_t linhas;
+    uint32_t colunas;
+    uint32_t num_navios;
+    uint32_t num_habilidades;
+    uint32_t checksum;
+    uint32_t reservado;
+    uint64_t tamanho_total;    // Bytes do instantâneo inteiro, incluindo o cabeçalho
+} CabecalhoInstantaneo;
+
+// Registro de navio ou de habilidade ('tipo' guarda a orientação ou o tipo da habilidade)
+typedef struct {
+    int32_t linha;
+    int32_t coluna;
+    uint8_t tipo;
+    uint8_t reservado[3];
+} RegistroInstantaneo;
+
+_Static_assert(sizeof(CabecalhoInstantaneo) == 40, "cabeçalho do instantâneo deve ter 40 bytes");
+_Static_assert(sizeof(RegistroInstantaneo) == 12, "registro do instantâneo deve ter 12 bytes");
+
+// Resultado da leitura de um instantâneo
+typedef enum {
+    INSTANTANEO_OK,
+    INSTANTANEO_ERRO_ARQUIVO,
+    INSTANTANEO_FORMATO_INVALIDO,
+    INSTANTANEO_VERSAO_INCOMPATIVEL,
+    INSTANTANEO_CHECKSUM_INVALIDO
+} StatusInstantaneo;
+
+// Vista somente leitura sobre um instantâneo: os ponteiros apontam direto para os bytes lidos
+typedef struct {
+    const CabecalhoInstantaneo* cabecalho;
+    const RegistroInstantaneo* navios;
+    const RegistroInstantaneo* habilidades;
+    const uint8_t* celulas;
+    void* mapeamento;          // Região do mmap (NULL quando a vista aponta para memória do chamador)
+    size_t tamanho_mapeamento;
+} VistaInstantaneo;
+
+// Função para obter a descrição de um status de leitura
+const char* obterDescricaoStatusInstantaneo(StatusInstantaneo status) {
+    switch (status) {
+        case INSTANTANEO_OK: return "ok";
+        case INSTANTANEO_ERRO_ARQUIVO: return "erro ao abrir ou mapear o arquivo";
+        case INSTANTANEO_FORMATO_INVALIDO: return "formato inválido";
+        case INSTANTANEO_VERSAO_INCOMPATIVEL: return "versão incompatível";
+        case INSTANTANEO_CHECKSUM_INVALIDO: return "checksum inválido";
+        default: return "desconhecido";
+    }
+}
+
+// Tabela do CRC-32 (polinômio refletido 0xEDB88320), gerada na primeira utilização
+static uint32_t tabelaCrc32[256];
+static pthread_once_t tabelaCrc32Unica = PTHREAD_ONCE_INIT;
+
+// Função para montar a tabela do CRC-32
+static void montarTabelaCrc32(void) {
+    for (uint32_t i = 0; i < 256; i++) {
+        uint32_t valor = i;
+        for (int bit = 0; bit < 8; bit++) {
+            valor = (valor >> 1) ^ (0xEDB88320u & (0u - (valor & 1u)));
+        }
+        tabelaCrc32[i] = valor;
+    }
+}
+
+// Função para calcular o CRC-32 de uma área de memória
+uint32_t calcularCrc32(const void* dados, size_t tamanho) {
+    pthread_once(&tabelaCrc32Unica, montarTabelaCrc32);
+    
+    const uint8_t* bytes = dados;
+    uint32_t crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < tamanho; i++) {
+        crc = (crc >> 8) ^ tabelaCrc32[(crc ^ bytes[i]) & 0xFF];
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
+
+// Funções de conversão entre valores de célula e códigos de 2 bits
+static inline int codigoCelulaInstantaneo(int valor) {
+    return valor == NAVIO ? 1 : valor == AREA_EFEITO ? 2 : 0;
+}
+
+static inline int valorCodigoInstantaneo(int codigo) {
+    return codigo == 1 ? NAVIO : codigo == 2 ? AREA_EFEITO : AGUA;
+}
+
+// Função para calcular o tamanho em bytes de um instantâneo
+size_t tamanhoInstantaneo(int linhas, int colunas, int num_navios, int num_habilidades) {
+    size_t bytes_celulas = ((size_t) linhas * colunas + 3) / 4;
+    return sizeof(CabecalhoInstantaneo) + ((size_t) num_navios + num_habilidades) * sizeof(RegistroInstantaneo)
+           + bytes_celulas;
+}
+
+// Função para escrever cabeçalho e registros; devolve a área das células, já zerada (toda água)
+static uint8_t* prepararInstantaneo(void* destino, int linhas, int colunas, const Navio navios[], int num_navios,
+                                    const HabilidadeEspecial habilidades[], int num_habilidades) {
+    size_t tamanho = tamanhoInstantaneo(linhas, colunas, num_navios, num_habilidades);
+    CabecalhoInstantaneo* cabecalho = destino;
+    
+    memset(destino, 0, tamanho);
+    memcpy(cabecalho->magica, MAGICA_INSTANTANEO, 4);
+    cabecalho->versao = VERSAO_INSTANTANEO;
+    cabecalho->bits_por_celula = BITS_POR_CELULA_INSTANTANEO;
+    cabecalho->linhas = (uint32_t) linhas;
+    cabecalho->colunas = (uint32_t) colunas;
+    cabecalho->num_navios = (uint32_t) num_navios;
+    cabecalho->num_habilidades = (uint32_t) num_habilidades;
+    cabecalho->tamanho_total = tamanho;
+    
+    RegistroInstantaneo* registro = (RegistroInstantaneo*) (cabecalho + 1);
+    for (int i = 0; i < num_navios; i++, registro++) {
+        registro->linha = navios[i].linha;
+        registro->coluna = navios[i].coluna;
+        registro->tipo = (uint8_t) navios[i].orientacao;
+    }
+    for (int i = 0; i < num_habilidades; i++, registro++) {
+        registro->linha = habilidades[i].linha_origem;
+        registro->coluna = habilidades[i].coluna_origem;
+        registro->tipo = (uint8_t) habilidades[i].tipo;
+    }
+    return (uint8_t*) registro;
+}
+
+// Função para fechar o instantâneo calculando o checksum do conteúdo
+static void finalizarInstantaneo(void* destino) {
+    CabecalhoInstantaneo* cabecalho = destino;
+    cabecalho->checksum = calcularCrc32(cabecalho + 1, cabecalho->tamanho_total - sizeof(CabecalhoInstantaneo));
+}
+
+// Função para gravar uma célula compactada (a área começa zerada, então só os bits 1 são escritos)
+static inline void marcarCelulaInstantaneo(uint8_t* celulas, size_t indice, int valor) {
+    celulas[indice >> 2] |= (uint8_t) (codigoCelulaInstantaneo(valor) << ((indice & 3) * 2));
+}
+
+// Função para serializar o tabuleiro 10x10 em 'destino' (com tamanhoInstantaneo bytes); devolve o tamanho
+size_t serializarInstantaneoMatriz(void* destino, int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO],
+                                   const Navio navios[], int num_navios,
+                                   const HabilidadeEspecial habilidades[], int num_habilidades) {
+    uint8_t* celulas = prepararInstantaneo(destino, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO, navios, num_navios,
+                                           habilidades, num_habilidades);
+    for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
+        for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+            marcarCelulaInstantaneo(celulas, (size_t) i * TAMANHO_TABULEIRO + j, tabuleiro[i][j]);
+        }
+    }
+    finalizarInstantaneo(destino);
+    return ((CabecalhoInstantaneo*) destino)->tamanho_total;
+}
+
+// Função para serializar um tabuleiro grande; só os blocos alocados são percorridos
+size_t serializarInstantaneoGrande(void* destino, const TabuleiroGrande* tabuleiro,
+                                   const Navio navios[], int num_navios,
+                                   const HabilidadeEspecial habilidades[], int num_habilidades) {
+    uint8_t* celulas = prepararInstantaneo(destino, tabuleiro->linhas, tabuleiro->colunas, navios, num_navios,
+                                           habilidades, num_habilidades);
+    for (int bloco_linha = 0; bloco_linha < tabuleiro->linhas_blocos; bloco_linha++) {
+        if (tabuleiro->diretorio[bloco_linha] == NULL) {
+            continue;
+        }
+        for (int bloco_coluna = 0; bloco_coluna < tabuleiro->colunas_blocos; bloco_coluna++) {
+            const BlocoTabuleiro* bloco = tabuleiro->diretorio[bloco_linha][bloco_coluna];
+            if (bloco == NULL) {
+                continue;
+            }
+            
+            for (int i = 0; i < LADO_BLOCO; i++) {
+                int linha = (bloco_linha << BITS_LADO_BLOCO) + i;
+                for (int j = 0; j < LADO_BLOCO; j++) {
+                    int coluna = (bloco_coluna << BITS_LADO_BLOCO) + j;
+                    if (linha < tabuleiro->linhas && coluna < tabuleiro->colunas && bloco->celulas[i][j] != AGUA) {
+                        marcarCelulaInstantaneo(celulas, (size_t) linha * tabuleiro->colunas + coluna,
+                                                bloco->celulas[i][j]);
+                    }
+                }
+            }
+        }
+    }
+    finalizarInstantaneo(destino);
+    return ((CabecalhoInstantaneo*) destino)->tamanho_total;
+}
+
+// Função para gravar um instantâneo já serializado em arquivo
+bool gravarInstantaneoArquivo(const char* caminho, const void* dados, size_t tamanho) {
+    int descritor = open(caminho, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (descritor < 0) {
+        return false;
+    }
+    
+    bool sucesso = escreverTudo(descritor, dados, tamanho);
+    return close(descritor) == 0 && sucesso;
+}
+
+// Função para validar um instantâneo em memória e montar a vista sobre ele (sem copiar)
+StatusInstantaneo interpretarInstantaneo(const void* dados, size_t tamanho, VistaInstantaneo* vista) {
+    const CabecalhoInstantaneo* cabecalho = dados;
+    
+    memset(vista, 0, sizeof(*vista));
+    if (tamanho < sizeof(CabecalhoInstantaneo) || memcmp(cabecalho->magica, MAGICA_INSTANTANEO, 4) != 0) {
+        return INSTANTANEO_FORMATO_INVALIDO;
+    }
+    if (cabecalho->versao != VERSAO_INSTANTANEO || cabecalho->bits_por_celula != BITS_POR_CELULA_INSTANTANEO) {
+        return INSTANTANEO_VERSAO_INCOMPATIVEL;
+    }
+    if (cabecalho->linhas == 0 || cabecalho->colunas == 0 || cabecalho->linhas > INT_MAX
+        || cabecalho->colunas > INT_MAX || cabecalho->num_navios > INT_MAX || cabecalho->num_habilidades > INT_MAX
+        || cabecalho->tamanho_total > tamanho
+        || cabecalho->tamanho_total != tamanhoInstantaneo((int) cabecalho->linhas, (int) cabecalho->colunas,
+                                                          (int) cabecalho->num_navios,
+                                                          (int) cabecalho->num_habilidades)) {
+        return INSTANTANEO_FORMATO_INVALIDO;
+    }
+    if (calcularCrc32(cabecalho + 1, cabecalho->tamanho_total - sizeof(CabecalhoInstantaneo)) != cabecalho->checksum) {
+        return INSTANTANEO_CHECKSUM_INVALIDO;
+    }
+    
+    // O checksum só garante a integridade: os tipos dos registros ainda precisam estar no intervalo válido
+    const RegistroInstantaneo* navios = (const RegistroInstantaneo*) (cabecalho + 1);
+    const RegistroInstantaneo* habilidades = navios + cabecalho->num_navios;
+    for (uint32_t i = 0; i < cabecalho->num_navios; i++) {
+        if (navios[i].tipo > DIAGONAL_SECUNDARIA) {
+            return INSTANTANEO_FORMATO_INVALIDO;
+        }
+    }
+    for (uint32_t i = 0; i < cabecalho->num_habilidades; i++) {
+        if (habilidades[i].tipo > OCTAEDRO) {
+            return INSTANTANEO_FORMATO_INVALIDO;
+        }
+    }
+    
+    vista->cabecalho = cabecalho;
+    vista->navios = navios;
+    vista->habilidades = habilidades;
+    vista->celulas = (const uint8_t*) (vista->habilidades + cabecalho->num_habilidades);
+    return INSTANTANEO_OK;
+}
+
+// Função para abrir um instantâneo gravado em arquivo, mapeando-o na memória
+StatusInstantaneo abrirInstantaneo(const char* caminho, VistaInstantaneo* vista) {
+    memset(vista, 0, sizeof(*vista));
+    
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0) {
+        return INSTANTANEO_ERRO_ARQUIVO;
+    }
+    
+    struct stat informacoes;
+    if (fstat(descritor, &informacoes) != 0) {
+        close(descritor);
+        return INSTANTANEO_ERRO_ARQUIVO;
+    }
+    if ((size_t) informacoes.st_size < sizeof(CabecalhoInstantaneo)) {
+        close(descritor);
+        return INSTANTANEO_FORMATO_INVALIDO;
+    }
+    
+    size_t tamanho = (size_t) informacoes.st_size;
+    void* mapeamento = mmap(NULL, tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+    close(descritor);
+    if (mapeamento == MAP_FAILED) {
+        return INSTANTANEO_ERRO_ARQUIVO;
+    }
+    
+    StatusInstantaneo status = interpretarInstantaneo(mapeamento, tamanho, vista);
+    if (status != INSTANTANEO_OK) {
+        munmap(mapeamento, tamanho);
+        return status;
+    }
+    vista->mapeamento = mapeamento;
+    vista->tamanho_mapeamento = tamanho;
+    return INSTANTANEO_OK;
+}
+
+// Função para desfazer o mapeamento de um instantâneo aberto com abrirInstantaneo
+void fecharInstantaneo(VistaInstantaneo* vista) {
+    if (vista->mapeamento != NULL) {
+        munmap(vista->mapeamento, vista->tamanho_mapeamento);
+    }
+    memset(vista, 0, sizeof(*vista));
+}
+
+// Função para ler uma célula diretamente dos bytes compactados
+int obterCelulaInstantaneo(const VistaInstantaneo* vista, int linha, int coluna) {
+    size_t indice = (size_t) linha * vista->cabecalho->colunas + coluna;
+    return valorCodigoInstantaneo((vista->celulas[indice >> 2] >> ((indice & 3) * 2)) & 3);
+}
+
+// Função para reconstruir um Navio a partir do registro (o nome não é persistido)
+Navio obterNavioInstantaneo(const VistaInstantaneo* vista, int indice) {
+    const RegistroInstantaneo* registro = &vista->navios[indice];
+    Navio navio = {registro->linha, registro->coluna, (OrientacaoNavio) registro->tipo, "Navio"};
+    return navio;
+}
+
+// Função para reconstruir uma habilidade (com a matriz) a partir do registro
+void obterHabilidadeInstantaneo(const VistaInstantaneo* vista, int indice, HabilidadeEspecial* habilidade) {
+    const RegistroInstantaneo* registro = &vista->habilidades[indice];
+    habilidade->linha_origem = registro->linha;
+    habilidade->coluna_origem = registro->coluna;
+    habilidade->tipo = (TipoHabilidade) registro->tipo;
+    habilidade->nome = habilidade->tipo == CONE ? "CONE" : habilidade->tipo == CRUZ ? "CRUZ" : "OCTAEDRO";
+    criarHabilidadePorTipo(habilidade, habilidade->tipo);
+}
+
+// Função para carregar as células de um instantâneo em um tabuleiro grande novo
+bool carregarInstantaneoGrande(const VistaInstantaneo* vista, TabuleiroGrande* tabuleiro) {
+    int linhas = (int) vista->cabecalho->linhas;
+    int colunas = (int) vista->cabecalho->colunas;
+    
+    if (!criarTabuleiroGrande(tabuleiro, linhas, colunas)) {
+        destruirTabuleiroGrande(tabuleiro);
+        return false;
+    }
+    
+    size_t total = (size_t) linhas * colunas;
+    for (size_t indice = 0; indice < total; indice += 4) {
+        uint8_t byte = vista->celulas[indice >> 2];
+        if (byte == 0) {
+            continue;  // Quatro células de água: nada a escrever
+        }
+        for (size_t k = 0; k < 4 && indice + k < total; k++) {
+            int codigo = (byte >> (k * 2)) & 3;
+            if (codigo != 0 && !definirCelulaGrande(tabuleiro, (int) ((indice + k) / colunas),
+                                                    (int) ((indice + k) % colunas), valorCodigoInstantaneo(codigo))) {
+                destruirTabuleiroGrande(tabuleiro);
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+// =====================================================================
+// MAPAS DE CALOR DE PARTIDAS SIMULADAS (ACUMULADORES POR THREAD)
+// =====================================================================
+
+// Cada thread joga uma faixa contígua das partidas e soma tudo no seu próprio mapa, sem nenhuma
+// sincronização. No fim, os mapas são somados numa árvore binomial: a thread t incorpora as
+// threads t+1, t+2, t+4, ... enquanto t for múltiplo do dobro do passo, então as somas de cada
+// nível correm em paralelo e a thread 0 termina com o total em log2(threads) etapas.
+// A partida i é sempre jogada com a mesma semente, então o resultado não depende das threads.
+
+#define MAGICA_MAPA_CALOR "BNMC"
+#define VERSAO_MAPA_CALOR 1
+
+// Camadas do mapa: ocupação por orientação, tiros disparados e primeiro acerto de cada atirador
+typedef enum {
+    CAMADA_NAVIO_HORIZONTAL,
+    CAMADA_NAVIO_VERTICAL,
+    CAMADA_NAVIO_DIAGONAL_PRINCIPAL,
+    CAMADA_NAVIO_DIAGONAL_SECUNDARIA,
+    CAMADA_TIROS,
+    CAMADA_PRIMEIRO_ACERTO,
+    NUM_CAMADAS_MAPA
+} CamadaMapaCalor;
+
+// Alinhado à linha de cache para que os mapas de threads vizinhas não dividam linhas
+typedef struct {
+    uint64_t partidas;
+    uint64_t contagens[NUM_CAMADAS_MAPA][TOTAL_CELULAS];
+} __attribute__((aligned(64))) MapaCalor;
+
+typedef struct {
+    char magica[4];
+    uint16_t versao;
+    uint16_t num_camadas;
+    uint32_t linhas;
+    uint32_t colunas;
+    uint64_t partidas;
+    uint32_t checksum;          // CRC-32 das contagens
+    uint32_t reservado;
+} CabecalhoMapaCalor;
+
+typedef struct TrabalhoMapaCalor TrabalhoMapaCalor;
+
+typedef struct {
+    MapaCalor* mapas;           // Um por thread; o da thread 0 recebe o total
+    TrabalhoMapaCalor* trabalhos;
+    pthread_t* threads;
+    bool* criada;               // Escrito e lido só pela mãe de cada thread na árvore
+    int num_threads;
+    EstrategiaTiro estrategia;
+    long partidas;
+    uint64_t semente;
+} AnaliseMapaCalor;
+
+struct TrabalhoMapaCalor {
+    AnaliseMapaCalor* analise;
+    int indice;
+};
+
+// Função para obter o nome de uma camada (cabeçalho do CSV)
+const char* obterNomeCamadaMapa(CamadaMapaCalor camada) {
+    switch (camada) {
+        case CAMADA_NAVIO_HORIZONTAL: return "navio_horizontal";
+        case CAMADA_NAVIO_VERTICAL: return "navio_vertical";
+        case CAMADA_NAVIO_DIAGONAL_PRINCIPAL: return "navio_diagonal_principal";
+        case CAMADA_NAVIO_DIAGONAL_SECUNDARIA: return "navio_diagonal_secundaria";
+        case CAMADA_TIROS: return "tiros";
+        case CAMADA_PRIMEIRO_ACERTO: return "primeiro_acerto";
+        default: return "?";
+    }
+}
+
+// Função para jogar uma partida (mesma estratégia dos dois lados) e somá-la ao mapa.
+// Retorna false, sem tocar no mapa, se alguma frota não pôde ser posicionada.
+bool acumularPartidaMapa(MapaCalor* mapa, EstrategiaTiro estrategia, uint64_t semente, uint64_t fluxo) {
+    GeradorAleatorio gerador;
+    TabuleiroBits tabuleiros[2];
+    Navio navios[2][MAX_NAVIOS_FROTA];
+    Atirador atiradores[2];
+    bool acertou[2] = {false, false};
+    
+    semearGerador(&gerador, semente, fluxo);
+    for (int lado = 0; lado < 2; lado++) {
+        if (gerarFrotaAleatoria(&gerador, NAVIOS_PADRAO_PARTIDA, navios[lado], &tabuleiros[lado]) == 0) {
+            return false;
+        }
+    }
+    for (int lado = 0; lado < 2; lado++) {
+        for (int n = 0; n < NAVIOS_PADRAO_PARTIDA; n++) {
+            const Navio* navio = &navios[lado][n];
+            for (int i = 0; i < TAMANHO_NAVIO; i++) {
+                int linha, coluna;
+                calcularPosicaoNavio(navio->linha, navio->coluna, navio->orientacao, i, &linha, &coluna);
+                mapa->contagens[CAMADA_NAVIO_HORIZONTAL + navio->orientacao][linha * TAMANHO_TABULEIRO + coluna]++;
+            }
+        }
+    }
+    for (int lado = 0; lado < 2; lado++) {
+        inicializarAtirador(&atiradores[lado], estrategia, NAVIOS_PADRAO_PARTIDA, proximoAleatorio(&gerador));
+    }
+    
+    int celulas_navio = NAVIOS_PADRAO_PARTIDA * TAMANHO_NAVIO;
+    int vez = (int) (fluxo & 1);    // Alterna quem começa, como em jogarPartida
+    while (true) {
+        Atirador* atirador = &atiradores[vez];
+        int celula = escolherTiro(atirador);
+        bool acerto = mascaraTestarCelula(tabuleiros[1 - vez].navios, celula);
+        registrarTiro(atirador, celula, acerto);
+        
+        mapa->contagens[CAMADA_TIROS][celula]++;
+        if (acerto && !acertou[vez]) {
+            acertou[vez] = true;
+            mapa->contagens[CAMADA_PRIMEIRO_ACERTO][celula]++;
+        }
+        if (mascaraContar(atirador->tiros.acertos) == celulas_navio) {
+            break;
+        }
+        vez = 1 - vez;
+    }
+    mapa->partidas++;
+    return true;
+}
+
+// Função para somar o mapa 'origem' ao mapa 'destino'
+void mesclarMapasCalor(MapaCalor* destino, const MapaCalor* origem) {
+    destino->partidas += origem->partidas;
+    for (int camada = 0; camada < NUM_CAMADAS_MAPA; camada++) {
+        for (int c = 0; c < TOTAL_CELULAS; c++) {
+            destino->contagens[camada][c] += origem->contagens[camada][c];
+        }
+    }
+}
+
+// Cada thread cria as suas filhas na árvore de redução, joga a sua faixa e depois as incorpora.
+// Uma filha que não pôde ser criada como thread é executada ali mesmo, pela mãe; como só a mãe
+// cria, espera e consulta cada filha, nenhuma outra thread toca em criada[] ou threads[] dela.
+static void* executarTrabalhoMapaCalor(void* argumento) {
+    TrabalhoMapaCalor* trabalho = argumento;
+    AnaliseMapaCalor* analise = trabalho->analise;
+    int t = trabalho->indice;
+    int n = analise->num_threads;
+    MapaCalor* mapa = &analise->mapas[t];
+    
+    for (int passo = 1; t % (2 * passo) == 0 && t + passo < n; passo *= 2) {
+        int filha = t + passo;
+        analise->criada[filha] = pthread_create(&analise->threads[filha], NULL, executarTrabalhoMapaCalor,
+                                                &analise->trabalhos[filha]) == 0;
+    }
+    
+    long inicio = analise->partidas * t / n;
+    long fim = analise->partidas * (t + 1) / n;
+    for (long partida = inicio; partida < fim; partida++) {
+        acumularPartidaMapa(mapa, analise->estrategia, analise->semente, (uint64_t) partida);
+    }
+    
+    for (int passo = 1; t % (2 * passo) == 0 && t + passo < n; passo *= 2) {
+        int filha = t + passo;
+        if (analise->criada[filha]) {
+            pthread_join(analise->threads[filha], NULL);
+        } else {
+            executarTrabalhoMapaCalor(&analise->trabalhos[filha]);
+        }
+        mesclarMapasCalor(mapa, &analise->mapas[filha]);
+    }
+    return NULL;
+}
+
+// Função para gerar o mapa de calor de 'partidas' partidas usando num_threads threads.
+// Retorna false se faltou memória ou se alguma partida não conseguiu posicionar as frotas.
+bool gerarMapaCalor(MapaCalor* resultado, EstrategiaTiro estrategia, long partidas, int num_threads, uint64_t semente) {
+    AnaliseMapaCalor analise;
+    
+    if (num_threads < 1) {
+        num_threads = obterNumeroNucleos();
+    }
+    inicializarPosicionamentosLegais();
+    inicializarEstenceis();
+    
+    analise.num_threads = num_threads;
+    analise.estrategia = estrategia;
+    analise.partidas = partidas;
+    analise.semente = semente;
+    analise.mapas = alocarMemoriaAlinhada(64, sizeof(MapaCalor) * (size_t) num_threads);
+    analise.threads = alocarMemoria(sizeof(pthread_t) * (size_t) num_threads);
+    analise.criada = alocarMemoriaZerada((size_t) num_threads, sizeof(bool));
+    analise.trabalhos = alocarMemoria(sizeof(TrabalhoMapaCalor) * (size_t) num_threads);
+    bool sucesso = analise.mapas != NULL && analise.threads != NULL && analise.criada != NULL &&
+                   analise.trabalhos != NULL;
+    
+    if (sucesso) {
+        memset(analise.mapas, 0, sizeof(MapaCalor) * (size_t) num_threads);
+        for (int t = 0; t < num_threads; t++) {
+            analise.trabalhos[t].analise = &analise;
+            analise.trabalhos[t].indice = t;
+        }
+        // A thread 0 é a raiz da árvore: só retorna depois de esperar por todas as outras
+        executarTrabalhoMapaCalor(&analise.trabalhos[0]);
+        *resultado = analise.mapas[0];
+        sucesso = resultado->partidas == (uint64_t) partidas;    // Partidas sem frota válida ficam de fora
+    }
+    
+    free(analise.mapas);
+    free(analise.threads);
+    free(analise.criada);
+    free(analise.trabalhos);
+    return sucesso;
+}
+
+// Função para exportar o mapa em CSV: uma linha por célula, uma coluna por camada
+void exportarMapaCalorCsv(const MapaCalor* mapa, FILE* saida) {
+    fprintf(saida, "linha,coluna");
+    for (int camada = 0; camada < NUM_CAMADAS_MAPA; camada++) {
+        fprintf(saida, ",%s", obterNomeCamadaMapa(camada));
+    }
+    fputc('\n', saida);
+    
+    for (int c = 0; c < TOTAL_CELULAS; c++) {
+        fprintf(saida, "%d,%d", c / TAMANHO_TABULEIRO, c % TAMANHO_TABULEIRO);
+        for (int camada = 0; camada < NUM_CAMADAS_MAPA; camada++) {
+            fprintf(saida, ",%llu", (unsigned long long) mapa->contagens[camada][c]);
+        }
+        fputc('\n', saida);
+    }
+}
+
+// Função para exportar o mapa em binário: cabeçalho de 32 bytes seguido das contagens
+// (uint64 por célula, camada após camada, na ordem de bytes da máquina)
+bool exportarMapaCalorBinario(const MapaCalor* mapa, const char* caminho) {
+    struct {
+        CabecalhoMapaCalor cabecalho;
+        uint64_t contagens[NUM_CAMADAS_MAPA][TOTAL_CELULAS];
+    } arquivo;
+    
+    memset(&arquivo.cabecalho, 0, sizeof(arquivo.cabecalho));
+    memcpy(arquivo.cabecalho.magica, MAGICA_MAPA_CALOR, 4);
+    arquivo.cabecalho.versao = VERSAO_MAPA_CALOR;
+    arquivo.cabecalho.num_camadas = NUM_CAMADAS_MAPA;
+    arquivo.cabecalho.linhas = TAMANHO_TABULEIRO;
+    arquivo.cabecalho.colunas = TAMANHO_TABULEIRO;
+    arquivo.cabecalho.partidas = mapa->partidas;
+    memcpy(arquivo.contagens, mapa->contagens, sizeof(arquivo.contagens));
+    arquivo.cabecalho.checksum = calcularCrc32(arquivo.contagens, sizeof(arquivo.contagens));
+    
+    return gravarInstantaneoArquivo(caminho, &arquivo, sizeof(arquivo));
+}
+
+// =====================================================================
+// REGISTRO DE EVENTOS (SOMENTE ANEXAÇÃO) E REPRODUÇÃO
+// =====================================================================
+
+// Formato do registro (versão 1):
+//   cabeçalho de 16 bytes: "BNEV", versão, reservado, linhas, colunas
+//   sequência de eventos; cada um começa por um byte com o tipo (bits 0-1) e o subtipo (bits 2-3),
+//   seguido das coordenadas como diferenças em relação ao evento anterior, em varint zigzag.
+//   Um evento típico ocupa 3 bytes.
+// A cada 'intervalo' eventos é anexado um ponto de controle com o estado completo do tabuleiro
+// (um instantâneo do formato binário acima), e a base das diferenças volta a (0, 0). Assim a
+// reprodução pode começar do ponto de controle mais próximo em vez do início do arquivo.
+// Um final truncado (queda no meio de uma escrita) é ignorado na leitura.
+
+#define MAGICA_EVENTOS "BNEV"
+#define VERSAO_EVENTOS 1
+#define INTERVALO_PONTO_CONTROLE_PADRAO 65536
+#define LIMITE_BUFFER_EVENTOS (1 << 16)
+
+typedef enum {
+    EVENTO_NAVIO,
+    EVENTO_HABILIDADE,
+    EVENTO_TIRO,
+    EVENTO_PONTO_CONTROLE
+} TipoEvento;
+
+typedef struct {
+    char magica[4];
+    uint16_t versao;
+    uint16_t reservado;
+    uint32_t linhas;
+    uint32_t colunas;
+} CabecalhoEventos;
+
+_Static_assert(sizeof(CabecalhoEventos) == 16, "cabeçalho do registro de eventos deve ter 16 bytes");
+
+// Escritor do registro. Mantém uma cópia do tabuleiro para validar os eventos e gerar os pontos de controle.
+typedef struct {
+    int descritor;
+    BufferSaida buffer;
+    TabuleiroGrande espelho;
+    long num_eventos;
+    long tiros;
+    long acertos;
+    int intervalo;
+    int ultima_linha;
+    int ultima_coluna;
+    size_t gravados;            // Bytes já escritos no arquivo (posição do início do buffer)
+    bool falhou;
+} RegistroEventos;
+
+// Ponto de controle encontrado na leitura: número do evento e posição do instantâneo no arquivo
+typedef struct {
+    long evento;
+    long tiros;
+    long acertos;
+    size_t posicao;
+    size_t tamanho;
+} PontoControle;
+
+// Reprodutor: lê o registro mapeado e reconstrói o tabuleiro em qualquer evento
+typedef struct {
+    const uint8_t* dados;
+    size_t tamanho;
+    int linhas;
+    int colunas;
+    PontoControle* pontos;
+    int num_pontos;
+    long total_eventos;
+    TabuleiroGrande tabuleiro;
+    long evento_atual;
+    long tiros;
+    long acertos;
+    size_t posicao;
+    int ultima_linha;
+    int ultima_coluna;
+} ReprodutorEventos;
+
+// Funções de codificação de inteiros em varint (7 bits por byte) com zigzag para valores com sinal
+static inline size_t escreverVarint(uint8_t* destino, uint64_t valor) {
+    size_t n = 0;
+    while (valor >= 0x80) {
+        destino[n++] = (uint8_t) (valor | 0x80);
+        valor >>= 7;
+    }
+    destino[n++] = (uint8_t) valor;
+    return n;
+}
+
+// Função para escrever um varint ocupando exatamente 'largura' bytes (de 1 a 10, não menos que o mínimo):
+// os bytes a mais são continuações com valor zero, que qualquer leitor de varint aceita
+static inline size_t escreverVarintLargura(uint8_t* destino, uint64_t valor, size_t largura) {
+    for (size_t n = 0; n + 1 < largura; n++) {
+        destino[n] = (uint8_t) (valor | 0x80);
+        valor >>= 7;
+    }
+    destino[largura - 1] = (uint8_t) valor;
+    return largura;
+}
+
+static inline size_t tamanhoVarint(uint64_t valor) {
+    size_t n = 1;
+    while (valor >= 0x80) {
+        valor >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static inline bool lerVarint(const uint8_t* dados, size_t tamanho, size_t* posicao, uint64_t* valor) {
+    uint64_t resultado = 0;
+    for (int deslocamento = 0; deslocamento < 64 && *posicao < tamanho; deslocamento += 7) {
+        uint8_t byte = dados[(*posicao)++];
+        resultado |= (uint64_t) (byte & 0x7F) << deslocamento;
+        if ((byte & 0x80) == 0) {
+            *valor = resultado;
+            return true;
+        }
+    }
+    return false;
+}
+
+static inline uint64_t codificarZigzag(int64_t valor) {
+    return ((uint64_t) valor << 1) ^ (uint64_t) (valor >> 63);
+}
+
+static inline int64_t decodificarZigzag(uint64_t valor) {
+    return (int64_t) (valor >> 1) ^ -(int64_t) (valor & 1);
+}
+
+// Função para escrever o conteúdo do buffer no arquivo
+static void descarregarRegistroEventos(RegistroEventos* registro) {
+    if (registro->buffer.tamanho > 0 && !registro->falhou) {
+        registro->falhou = !escreverTudo(registro->descritor, registro->buffer.dados, registro->buffer.tamanho);
+        registro->gravados += registro->buffer.tamanho;
+    }
+    registro->buffer.tamanho = 0;
+}
+
+// Função para anexar um ponto de controle com o estado atual do espelho.
+// O instantâneo começa alinhado a 8 bytes no arquivo, para ser lido no lugar depois do mmap;
+// a folga é absorvida alargando os varints do prefixo, sem mudar o formato.
+static void anexarPontoControle(RegistroEventos* registro) {
+    uint8_t prefixo[1 + 4 * 10];
+    size_t n = 0;
+    size_t tamanho = tamanhoInstantaneo(registro->espelho.linhas, registro->espelho.colunas, 0, 0);
+    uint64_t campos[4] = {(uint64_t) registro->num_eventos, (uint64_t) registro->tiros,
+                          (uint64_t) registro->acertos, tamanho};
+    size_t larguras[4];
+    size_t inicio = 1;
+    
+    for (int k = 0; k < 4; k++) {
+        larguras[k] = tamanhoVarint(campos[k]);
+        inicio += larguras[k];
+    }
+    size_t folga = (8 - (registro->gravados + registro->buffer.tamanho + inicio) % 8) % 8;
+    for (int k = 0; k < 4 && folga > 0; k++) {
+        size_t extra = 10 - larguras[k] < folga ? 10 - larguras[k] : folga;
+        larguras[k] += extra;
+        folga -= extra;
+    }
+    
+    prefixo[n++] = EVENTO_PONTO_CONTROLE;
+    for (int k = 0; k < 4; k++) {
+        n += escreverVarintLargura(prefixo + n, campos[k], larguras[k]);
+    }
+    
+    if (!reservarBufferSaida(&registro->buffer, n + tamanho)) {
+        registro->falhou = true;
+        return;
+    }
+    memcpy(registro->buffer.dados + registro->buffer.tamanho, prefixo, n);
+    serializarInstantaneoGrande(registro->buffer.dados + registro->buffer.tamanho + n, &registro->espelho,
+                                NULL, 0, NULL, 0);
+    registro->buffer.tamanho += n + tamanho;
+    registro->ultima_linha = 0;
+    registro->ultima_coluna = 0;
+    descarregarRegistroEventos(registro);
+}
+
+// Função para anexar um evento já aplicado ao espelho
+static void anexarEvento(RegistroEventos* registro, TipoEvento tipo, int subtipo, int linha, int coluna) {
+    if (!reservarBufferSaida(&registro->buffer, 1 + 2 * 10)) {
+        registro->falhou = true;
+        return;
+    }
+    
+    uint8_t* destino = (uint8_t*) registro->buffer.dados + registro->buffer.tamanho;
+    size_t n = 0;
+    destino[n++] = (uint8_t) (tipo | (subtipo << 2));
+    n += escreverVarint(destino + n, codificarZigzag((int64_t) linha - registro->ultima_linha));
+    n += escreverVarint(destino + n, codificarZigzag((int64_t) coluna - registro->ultima_coluna));
+    registro->buffer.tamanho += n;
+    registro->ultima_linha = linha;
+    registro->ultima_coluna = coluna;
+    
+    registro->num_eventos++;
+    if (registro->num_eventos % registro->intervalo == 0) {
+        anexarPontoControle(registro);
+    } else if (registro->buffer.tamanho >= LIMITE_BUFFER_EVENTOS) {
+        descarregarRegistroEventos(registro);
+    }
+}
+
+// Função para criar um registro de eventos novo para um tabuleiro linhas x colunas
+bool criarRegistroEventos(RegistroEventos* registro, const char* caminho, int linhas, int colunas, int intervalo) {
+    memset(registro, 0, sizeof(*registro));
+    registro->intervalo = intervalo > 0 ? intervalo : INTERVALO_PONTO_CONTROLE_PADRAO;
+    
+    if (!criarTabuleiroGrande(&registro->espelho, linhas, colunas)) {
+        destruirTabuleiroGrande(&registro->espelho);
+        return false;
+    }
+    
+    registro->descritor = open(caminho, O_WRONLY | O_CREAT | O_TRUNC | O_APPEND, 0644);
+    if (registro->descritor < 0) {
+        destruirTabuleiroGrande(&registro->espelho);
+        return false;
+    }
+    
+    CabecalhoEventos cabecalho = {{'B', 'N', 'E', 'V'}, VERSAO_EVENTOS, 0, (uint32_t) linhas, (uint32_t) colunas};
+    anexarBufferSaida(&registro->buffer, (const char*) &cabecalho, sizeof(cabecalho));
+    return true;
+}
+
+// Funções para registrar eventos; devolvem false quando o evento é inválido e não foi registrado
+bool registrarEventoNavio(RegistroEventos* registro, Navio navio) {
+    if (!posicionarNavioGrande(&registro->espelho, navio)) {
+        return false;
+    }
+    anexarEvento(registro, EVENTO_NAVIO, navio.orientacao, navio.linha, navio.coluna);
+    return true;
+}
+
+bool registrarEventoHabilidade(RegistroEventos* registro, const HabilidadeEspecial* habilidade) {
+    if (!origemAlcancaTabuleiro(habilidade->linha_origem, habilidade->coluna_origem, TAMANHO_HABILIDADE / 2,
+                                registro->espelho.linhas, registro->espelho.colunas)) {
+        return false;
+    }
+    aplicarHabilidadeGrande(&registro->espelho, habilidade);
+    anexarEvento(registro, EVENTO_HABILIDADE, habilidade->tipo, habilidade->linha_origem, habilidade->coluna_origem);
+    return true;
+}
+
+bool registrarEventoTiro(RegistroEventos* registro, int linha, int coluna) {
+    if (!celulaDentroDosLimites(linha, coluna, registro->espelho.linhas, registro->espelho.colunas)) {
+        return false;
+    }
+    registro->tiros++;
+    registro->acertos += obterCelulaGrande(&registro->espelho, linha, coluna) == NAVIO;
+    anexarEvento(registro, EVENTO_TIRO, 0, linha, coluna);
+    return true;
+}
+
+// Função para gravar o que falta e fechar o registro; devolve false se alguma escrita falhou
+bool fecharRegistroEventos(RegistroEventos* registro) {
+    descarregarRegistroEventos(registro);
+    bool sucesso = !registro->falhou && close(registro->descritor) == 0;
+    liberarBufferSaida(&registro->buffer);
+    destruirTabuleiroGrande(&registro->espelho);
+    return sucesso;
+}
+
+// Função para decodificar o próximo registro a partir de 'posicao'; devolve false no fim dos dados
+static bool lerProximoEvento(const uint8_t* dados, size_t tamanho, size_t* posicao, int* tipo, int* subtipo,
+                             int64_t* delta_linha, int64_t* delta_coluna) {
+    uint64_t a, b;
+    if (*posicao >= tamanho) {
+        return false;
+    }
+    
+    uint8_t cabecalho = dados[(*posicao)++];
+    *tipo = cabecalho & 3;
+    *subtipo = (cabecalho >> 2) & 3;
+    if (*tipo == EVENTO_PONTO_CONTROLE) {
+        return true;
+    }
+    if (*tipo == EVENTO_HABILIDADE && *subtipo > OCTAEDRO) {
+        return false;    // Só existem três estênceis: um registro assim está corrompido
+    }
+    if (!lerVarint(dados, tamanho, posicao, &a) || !lerVarint(dados, tamanho, posicao, &b)) {
+        return false;
+    }
+    *delta_linha = decodificarZigzag(a);
+    *delta_coluna = decodificarZigzag(b);
+    return true;
+}
+
+// Função para somar as diferenças de um evento à posição anterior (entrada e saída em linha, coluna).
+// Devolve false se o resultado não poderia ter sido gravado: fora do int, ou fora do tabuleiro
+// (navios e tiros) ou longe demais dele (habilidades). Um registro assim está corrompido.
+static bool decodificarPosicaoEvento(int tipo, int64_t delta_linha, int64_t delta_coluna, int linhas, int colunas,
+                                     int* linha, int* coluna) {
+    const int64_t limite = (int64_t) INT_MAX - INT_MIN;
+    if (delta_linha < -limite || delta_linha > limite || delta_coluna < -limite || delta_coluna > limite) {
+        return false;
+    }
+    int64_t nova_linha = *linha + delta_linha;
+    int64_t nova_coluna = *coluna + delta_coluna;
+    if (nova_linha < INT_MIN || nova_linha > INT_MAX || nova_coluna < INT_MIN || nova_coluna > INT_MAX) {
+        return false;
+    }
+    
+    bool valida = tipo == EVENTO_HABILIDADE
+        ? origemAlcancaTabuleiro((int) nova_linha, (int) nova_coluna, TAMANHO_HABILIDADE / 2, linhas, colunas)
+        : celulaDentroDosLimites((int) nova_linha, (int) nova_coluna, linhas, colunas);
+    if (!valida) {
+        return false;
+    }
+    *linha = (int) nova_linha;
+    *coluna = (int) nova_coluna;
+    return true;
+}
+
+// Função para ler o cabeçalho de um ponto de controle (a posição fica no início do instantâneo)
+static bool lerPontoControle(const uint8_t* dados, size_t tamanho, size_t* posicao, PontoControle* ponto) {
+    uint64_t evento, tiros, acertos, bytes;
+    if (!lerVarint(dados, tamanho, posicao, &evento) || !lerVarint(dados, tamanho, posicao, &tiros)
+        || !lerVarint(dados, tamanho, posicao, &acertos) || !lerVarint(dados, tamanho, posicao, &bytes)
+        || bytes > tamanho - *posicao) {
+        return false;
+    }
+    ponto->evento = (long) evento;
+    ponto->tiros = (long) tiros;
+    ponto->acertos = (long) acertos;
+    ponto->posicao = *posicao;
+    ponto->tamanho = (size_t) bytes;
+    *posicao += bytes;
+    return true;
+}
+
+// Função para voltar o reprodutor ao estado inicial (tabuleiro vazio, antes do primeiro evento)
+static bool reiniciarReprodutor(ReprodutorEventos* reprodutor) {
+    destruirTabuleiroGrande(&reprodutor->tabuleiro);
+    reprodutor->evento_atual = 0;
+    reprodutor->tiros = 0;
+    reprodutor->acertos = 0;
+    reprodutor->posicao = sizeof(CabecalhoEventos);
+    reprodutor->ultima_linha = 0;
+    reprodutor->ultima_coluna = 0;
+    return criarTabuleiroGrande(&reprodutor->tabuleiro, reprodutor->linhas, reprodutor->colunas);
+}
+
+// Função para abrir um registro de eventos, mapeando-o e indexando seus pontos de controle
+bool abrirReprodutor(ReprodutorEventos* reprodutor, const char* caminho) {
+    memset(reprodutor, 0, sizeof(*reprodutor));
+    
+    int descritor = open(caminho, O_RDONLY);
+    if (descritor < 0) {
+        return false;
+    }
+    struct stat informacoes;
+    if (fstat(descritor, &informacoes) != 0 || (size_t) informacoes.st_size < sizeof(CabecalhoEventos)) {
+        close(descritor);
+        return false;
+    }
+    
+    reprodutor->tamanho = (size_t) informacoes.st_size;
+    void* mapeamento = mmap(NULL, reprodutor->tamanho, PROT_READ, MAP_PRIVATE, descritor, 0);
+    close(descritor);
+    if (mapeamento == MAP_FAILED) {
+        return false;
+    }
+    reprodutor->dados = mapeamento;
+    
+    const CabecalhoEventos* cabecalho = mapeamento;
+    if (memcmp(cabecalho->magica, MAGICA_EVENTOS, 4) != 0 || cabecalho->versao != VERSAO_EVENTOS
+        || cabecalho->linhas == 0 || cabecalho->colunas == 0
+        || cabecalho->linhas > INT_MAX || cabecalho->colunas > INT_MAX) {
+        munmap(mapeamento, reprodutor->tamanho);
+        return false;
+    }
+    reprodutor->linhas = (int) cabecalho->linhas;
+    reprodutor->colunas = (int) cabecalho->colunas;
+    
+    // Varredura rápida: conta os eventos completos e válidos e anota cada ponto de controle
+    size_t posicao = sizeof(CabecalhoEventos);
+    int capacidade = 0;
+    int linha = 0, coluna = 0;
+    for (;;) {
+        size_t inicio = posicao;
+        int tipo, subtipo;
+        int64_t delta_linha, delta_coluna;
+        if (!lerProximoEvento(reprodutor->dados, reprodutor->tamanho, &posicao, &tipo, &subtipo,
+                              &delta_linha, &delta_coluna)) {
+            break;
+        }
+        if (tipo != EVENTO_PONTO_CONTROLE) {
+            if (!decodificarPosicaoEvento(tipo, delta_linha, delta_coluna, reprodutor->linhas, reprodutor->colunas,
+                                          &linha, &coluna)) {
+                break;
+            }
+            reprodutor->total_eventos++;
+            continue;
+        }
+        linha = 0;
+        coluna = 0;
+        
+        PontoControle ponto;
+        if (!lerPontoControle(reprodutor->dados, reprodutor->tamanho, &posicao, &ponto)) {
+            posicao = inicio;
+            break;
+        }
+        if (reprodutor->num_pontos == capacidade) {
+            capacidade = capacidade == 0 ? 16 : capacidade * 2;
+            PontoControle* novos = realocarMemoria(reprodutor->pontos, (size_t) capacidade * sizeof(PontoControle));
+            if (novos == NULL) {
+                break;
+            }
+            reprodutor->pontos = novos;
+        }
+        reprodutor->pontos[reprodutor->num_pontos++] = ponto;
+    }
+    
+    return reiniciarReprodutor(reprodutor);
+}
+
+// Função para liberar o reprodutor
+void fecharReprodutor(ReprodutorEventos* reprodutor) {
+    destruirTabuleiroGrande(&reprodutor->tabuleiro);
+    free(reprodutor->pontos);
+    if (reprodutor->dados != NULL) {
+        munmap((void*) reprodutor->dados, reprodutor->tamanho);
+    }
+    memset(reprodutor, 0, sizeof(*reprodutor));
+}
+
+// Função para reconstruir o tabuleiro logo após o evento 'alvo' (0 = antes do primeiro).
+// Salta para o ponto de controle mais próximo quando isso evita reproduzir eventos.
+// Devolve o número do evento alcançado (menor que 'alvo' se o registro terminar antes).
+long reproduzirAte(ReprodutorEventos* reprodutor, long alvo) {
+    // Último ponto de controle que não passa do alvo (busca binária)
+    int esquerda = 0, direita = reprodutor->num_pontos - 1, escolhido = -1;
+    while (esquerda <= direita) {
+        int meio = (esquerda + direita) / 2;
+        if (reprodutor->pontos[meio].evento <= alvo) {
+            escolhido = meio;
+            esquerda = meio + 1;
+        } else {
+            direita = meio - 1;
+        }
+    }
+    
+    bool voltar = alvo < reprodutor->evento_atual;
+    bool saltar = escolhido >= 0 && reprodutor->pontos[escolhido].evento > reprodutor->evento_atual;
+    if (voltar || saltar) {
+        if (!reiniciarReprodutor(reprodutor)) {
+            return -1;
+        }
+        if (escolhido >= 0) {
+            const PontoControle* ponto = &reprodutor->pontos[escolhido];
+            const uint8_t* instantaneo = reprodutor->dados + ponto->posicao;
+            VistaInstantaneo vista;
+            
+            // Registros gravados antes do alinhamento dos pontos de controle: lê de uma cópia alinhada
+            uint8_t* copia = NULL;
+            if ((uintptr_t) instantaneo % _Alignof(CabecalhoInstantaneo) != 0) {
+                copia = alocarMemoria(ponto->tamanho);
+                if (copia == NULL) {
+                    reiniciarReprodutor(reprodutor);
+                    return -1;
+                }
+                memcpy(copia, instantaneo, ponto->tamanho);
+                instantaneo = copia;
+            }
+            
+            destruirTabuleiroGrande(&reprodutor->tabuleiro);
+            bool carregado = interpretarInstantaneo(instantaneo, ponto->tamanho, &vista) == INSTANTANEO_OK
+                             && carregarInstantaneoGrande(&vista, &reprodutor->tabuleiro);
+            free(copia);
+            if (!carregado) {
+                reiniciarReprodutor(reprodutor);
+                return -1;
+            }
+            reprodutor->evento_atual = ponto->evento;
+            reprodutor->tiros = ponto->tiros;
+            reprodutor->acertos = ponto->acertos;
+            reprodutor->posicao = ponto->posicao + ponto->tamanho;
+        }
+    }
+    
+    while (reprodutor->evento_atual < alvo) {
+        int tipo, subtipo;
+        int64_t delta_linha, delta_coluna;
+        size_t inicio = reprodutor->posicao;
+        if (!lerProximoEvento(reprodutor->dados, reprodutor->tamanho, &reprodutor->posicao, &tipo, &subtipo,
+                              &delta_linha, &delta_coluna)) {
+            reprodutor->posicao = inicio;
+            break;
+        }
+        
+        if (tipo == EVENTO_PONTO_CONTROLE) {
+            // Já estamos no estado certo: só pula o instantâneo e zera a base das diferenças
+            PontoControle ponto;
+            if (!lerPontoControle(reprodutor->dados, reprodutor->tamanho, &reprodutor->posicao, &ponto)) {
+                reprodutor->posicao = inicio;
+                break;
+            }
+            reprodutor->ultima_linha = 0;
+            reprodutor->ultima_coluna = 0;
+            continue;
+        }
+        
+        int linha = reprodutor->ultima_linha, coluna = reprodutor->ultima_coluna;
+        if (!decodificarPosicaoEvento(tipo, delta_linha, delta_coluna, reprodutor->linhas, reprodutor->colunas,
+                                      &linha, &coluna)) {
+            reprodutor->posicao = inicio;
+            break;
+        }
+        reprodutor->ultima_linha = linha;
+        reprodutor->ultima_coluna = coluna;
+        
+        if (tipo == EVENTO_NAVIO) {
+            Navio navio = {linha, coluna, (OrientacaoNavio) subtipo, "Navio"};
+            posicionarNavioGrande(&reprodutor->tabuleiro, navio);
+        } else if (tipo == EVENTO_HABILIDADE) {
+            HabilidadeEspecial habilidade;
+            habilidade.tipo = (TipoHabilidade) subtipo;
+            habilidade.linha_origem = linha;
+            habilidade.coluna_origem = coluna;
+            aplicarHabilidadeGrande(&reprodutor->tabuleiro, &habilidade);
+        } else {
+            reprodutor->tiros++;
+            reprodutor->acertos += obterCelulaGrande(&reprodutor->tabuleiro, linha, coluna) == NAVIO;
+        }
+        reprodutor->evento_atual++;
+    }
+    return reprodutor->evento_atual;
+}
+
+// =====================================================================
+// SERVIDOR DE PARTIDAS (EPOLL SOBRE TCP OU SOQUETE UNIX)
+// =====================================================================
+
+// Um único processo, uma única thread: o laço de eventos do epoll atende todas as conexões.
+// O protocolo usa quadros binários fixos de 8 bytes nos dois sentidos. Cada pedido recebe
+// exatamente uma resposta, na mesma ordem, então o cliente pode enviar vários pedidos seguidos.
+// Os jogos são tabuleiros 10x10 em bits, identificados por um número, e qualquer conexão pode
+// atirar em qualquer jogo (dois robôs jogam um contra o tabuleiro do outro), mas só a conexão que
+// criou o jogo pode posicionar navios nele ou encerrá-lo. Os jogos criados por uma conexão são
+// encerrados quando ela fecha.
+//
+// Endereços: "unix:/caminho/do/soquete", "tcp:porta" ou "tcp:ip:porta".
+
+typedef enum {
+    COMANDO_CRIAR_JOGO,
+    COMANDO_POSICIONAR_NAVIO,   // parametro = orientação
+    COMANDO_ATIRAR,
+    COMANDO_APLICAR_HABILIDADE, // parametro = tipo de habilidade
+    COMANDO_CONSULTAR,
+    COMANDO_ENCERRAR_JOGO
+} ComandoServidor;
+
+typedef enum {
+    RESPOSTA_OK,
+    RESPOSTA_POSICAO_INVALIDA,
+    RESPOSTA_SOBREPOSTO,
+    RESPOSTA_JOGO_INEXISTENTE,
+    RESPOSTA_COMANDO_INVALIDO,
+    RESPOSTA_SEM_MEMORIA,
+    RESPOSTA_NAO_AUTORIZADO     // O jogo pertence a outra conexão
+} StatusResposta;
+
+// Pedido: comando, parâmetro, coordenadas e jogo
+typedef struct {
+    uint8_t comando;
+    uint8_t parametro;
+    uint8_t linha;
+    uint8_t coluna;
+    uint32_t jogo;
+} PedidoServidor;
+
+// Resposta: status, valor (ResultadoTiro no tiro, navios alcançados pela habilidade, navios na
+// consulta), extra (células de navio ainda não atingidas, ou células afetadas pela habilidade) e o jogo
+typedef struct {
+    uint8_t status;
+    uint8_t valor;
+    uint16_t extra;
+    uint32_t jogo;
+} RespostaServidor;
+
+_Static_assert(sizeof(PedidoServidor) == 8, "pedido do servidor deve ter 8 bytes");
+_Static_assert(sizeof(RespostaServidor) == 8, "resposta do servidor deve ter 8 bytes");
+
+// O identificador de um jogo junta a posição no vetor de jogos (20 bits) e uma geração (12 bits),
+// para que um identificador antigo não alcance um jogo novo na mesma posição
+#define BITS_INDICE_JOGO 20
+#define MAX_JOGOS_SERVIDOR (1 << BITS_INDICE_JOGO)
+#define MAX_EVENTOS_EPOLL 256
+#define LIMITE_SAIDA_CONEXAO (1 << 20)
+
+typedef struct {
+    TabuleiroBits tabuleiro;
+    CamadaNavios navios;         // Identidade dos navios e tiros recebidos
+    uint32_t geracao;
+    int dono;                    // Descritor da conexão que criou o jogo (-1 se livre)
+    int proximo_livre;
+    int anterior_do_dono;        // Vizinhos na lista de jogos da conexão dona (-1 nas pontas)
+    int proximo_do_dono;
+} JogoServidor;
+
+typedef struct {
+    int descritor;
+    uint8_t entrada[4096];
+    size_t tamanho_entrada;
+    BufferSaida saida;
+    size_t enviado;              // Bytes da saída já escritos no soquete
+    uint32_t interesse;          // Eventos registrados no epoll para esta conexão
+    int primeiro_jogo;           // Início da lista de jogos criados por esta conexão (-1 se vazia)
+} ConexaoServidor;
+
+typedef struct {
+    int epoll;
+    int escuta;
+    JogoServidor* jogos;
+    int capacidade_jogos;
+    int primeiro_livre;
+    long jogos_ativos;
+    long conexoes;
+    long pedidos;
+} ServidorPartidas;
+
+static volatile sig_atomic_t servidorDeveParar = 0;
+
+static void tratarSinalParada(int sinal) {
+    (void) sinal;
+    servidorDeveParar = 1;
+}
+
+// Função para converter um endereço em texto para sockaddr; devolve a família (AF_UNIX/AF_INET) ou -1
+static int interpretarEndereco(const char* texto, struct sockaddr_storage* endereco, socklen_t* tamanho) {
+    memset(endereco, 0, sizeof(*endereco));
+    
+    if (strncmp(texto, "unix:", 5) == 0) {
+        struct sockaddr_un* local = (struct sockaddr_un*) endereco;
+        if (strlen(texto + 5) >= sizeof(local->sun_path)) {
+            return -1;
+        }
+        local->sun_family = AF_UNIX;
+        strcpy(local->sun_path, texto + 5);
+        *tamanho = sizeof(*local);
+        return AF_UNIX;
+    }
+    
+    if (strncmp(texto, "tcp:", 4) == 0) {
+        struct sockaddr_in* rede = (struct sockaddr_in*) endereco;
+        const char* porta = strrchr(texto + 4, ':');
+        char ip[64] = "127.0.0.1";
+        if (porta != NULL) {
+            size_t tamanho_ip = (size_t) (porta - (texto + 4));
+            if (tamanho_ip >= sizeof(ip)) {
+                return -1;
+            }
+            memcpy(ip, texto + 4, tamanho_ip);
+            ip[tamanho_ip] = '\0';
+            porta++;
+        } else {
+            porta = texto + 4;
+        }
+        rede->sin_family = AF_INET;
+        rede->sin_port = htons((uint16_t) atoi(porta));
+        if (inet_pton(AF_INET, ip, &rede->sin_addr) != 1) {
+            return -1;
+        }
+        *tamanho = sizeof(*rede);
+        return AF_INET;
+    }
+    return -1;
+}
+
+// Função para criar o soquete de escuta não bloqueante
+static int criarSoqueteEscuta(const char* texto) {
+    struct sockaddr_storage endereco;
+    socklen_t tamanho;
+    int familia = interpretarEndereco(texto, &endereco, &tamanho);
+    if (familia < 0) {
+        return -1;
+    }
+    
+    int descritor = socket(familia, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (descritor < 0) {
+        return -1;
+    }
+    if (familia == AF_UNIX) {
+        unlink(((struct sockaddr_un*) &endereco)->sun_path);
+    } else {
+        int sim = 1;
+        setsockopt(descritor, SOL_SOCKET, SO_REUSEADDR, &sim, sizeof(sim));
+    }
+    if (bind(descritor, (struct sockaddr*) &endereco, tamanho) != 0 || listen(descritor, SOMAXCONN) != 0) {
+        close(descritor);
+        return -1;
+    }
+    return descritor;
+}
+
+// Função para conectar a um servidor (soquete bloqueante, usado pelo cliente de teste)
+int conectarServidor(const char* texto) {
+    struct sockaddr_storage endereco;
+    socklen_t tamanho;
+    int familia = interpretarEndereco(texto, &endereco, &tamanho);
+    if (familia < 0) {
+        return -1;
+    }
+    
+    int descritor = socket(familia, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (descritor < 0) {
+        return -1;
+    }
+    if (connect(descritor, (struct sockaddr*) &endereco, tamanho) != 0) {
+        close(descritor);
+        return -1;
+    }
+    if (familia == AF_INET) {
+        int sim = 1;
+        setsockopt(descritor, IPPROTO_TCP, TCP_NODELAY, &sim, sizeof(sim));
+    }
+    return descritor;
+}
+
+// Função para obter um jogo ativo pelo identificador (NULL se não existe)
+static JogoServidor* obterJogoServidor(ServidorPartidas* servidor, uint32_t identificador) {
+    uint32_t indice = identificador & (MAX_JOGOS_SERVIDOR - 1);
+    if (indice >= (uint32_t) servidor->capacidade_jogos) {
+        return NULL;
+    }
+    JogoServidor* jogo = &servidor->jogos[indice];
+    if (jogo->dono < 0 || jogo->geracao != identificador >> BITS_INDICE_JOGO) {
+        return NULL;
+    }
+    return jogo;
+}
+
+// Função para criar um jogo vazio na lista do dono; devolve o identificador ou UINT32_MAX sem memória
+static uint32_t criarJogoServidor(ServidorPartidas* servidor, ConexaoServidor* dono) {
+    if (servidor->primeiro_livre < 0) {
+        int capacidade = servidor->capacidade_jogos == 0 ? 1024 : servidor->capacidade_jogos * 2;
+        if (capacidade > MAX_JOGOS_SERVIDOR) {
+            return UINT32_MAX;
+        }
+        JogoServidor* jogos = realocarMemoria(servidor->jogos, (size_t) capacidade * sizeof(JogoServidor));
+        if (jogos == NULL) {
+            return UINT32_MAX;
+        }
+        for (int i = capacidade - 1; i >= servidor->capacidade_jogos; i--) {
+            jogos[i].dono = -1;
+            jogos[i].geracao = 0;
+            jogos[i].proximo_livre = servidor->primeiro_livre;
+            servidor->primeiro_livre = i;
+        }
+        servidor->jogos = jogos;
+        servidor->capacidade_jogos = capacidade;
+    }
+    
+    int indice = servidor->primeiro_livre;
+    JogoServidor* jogo = &servidor->jogos[indice];
+    servidor->primeiro_livre = jogo->proximo_livre;
+    inicializarTabuleiroBits(&jogo->tabuleiro);
+    inicializarCamadaNavios(&jogo->navios);
+    jogo->dono = dono->descritor;
+    jogo->anterior_do_dono = -1;
+    jogo->proximo_do_dono = dono->primeiro_jogo;
+    if (dono->primeiro_jogo >= 0) {
+        servidor->jogos[dono->primeiro_jogo].anterior_do_dono = indice;
+    }
+    dono->primeiro_jogo = indice;
+    servidor->jogos_ativos++;
+    return jogo->geracao << BITS_INDICE_JOGO | (uint32_t) indice;
+}
+
+// Função para encerrar um jogo e tirá-lo da lista da conexão dona
+static void encerrarJogoServidor(ServidorPartidas* servidor, ConexaoServidor* dono, JogoServidor* jogo) {
+    if (jogo->anterior_do_dono >= 0) {
+        servidor->jogos[jogo->anterior_do_dono].proximo_do_dono = jogo->proximo_do_dono;
+    } else {
+        dono->primeiro_jogo = jogo->proximo_do_dono;
+    }
+    if (jogo->proximo_do_dono >= 0) {
+        servidor->jogos[jogo->proximo_do_dono].anterior_do_dono = jogo->anterior_do_dono;
+    }
+    
+    jogo->dono = -1;
+    jogo->geracao = (jogo->geracao + 1) & ((1u << (32 - BITS_INDICE_JOGO)) - 1);
+    jogo->proximo_livre = servidor->primeiro_livre;
+    servidor->primeiro_livre = (int) (jogo - servidor->jogos);
+    servidor->jogos_ativos--;
+}
+
+// Função para executar um pedido e montar a resposta
+static RespostaServidor atenderPedido(ServidorPartidas* servidor, ConexaoServidor* conexao, const PedidoServidor* pedido) {
+    RespostaServidor resposta = {RESPOSTA_OK, 0, 0, pedido->jogo};
+    
+    if (pedido->comando == COMANDO_CRIAR_JOGO) {
+        resposta.jogo = criarJogoServidor(servidor, conexao);
+        resposta.status = resposta.jogo == UINT32_MAX ? RESPOSTA_SEM_MEMORIA : RESPOSTA_OK;
+        return resposta;
+    }
+    
+    JogoServidor* jogo = obterJogoServidor(servidor, pedido->jogo);
+    if (jogo == NULL) {
+        resposta.status = RESPOSTA_JOGO_INEXISTENTE;
+        return resposta;
+    }
+    if (pedido->comando != COMANDO_CONSULTAR && pedido->comando != COMANDO_ENCERRAR_JOGO
+        && !celulaDentroDosLimites(pedido->linha, pedido->coluna, TAMANHO_TABULEIRO, TAMANHO_TABULEIRO)) {
+        resposta.status = RESPOSTA_POSICAO_INVALIDA;
+        return resposta;
+    }
+    if ((pedido->comando == COMANDO_POSICIONAR_NAVIO || pedido->comando == COMANDO_ENCERRAR_JOGO)
+        && jogo->dono != conexao->descritor) {
+        resposta.status = RESPOSTA_NAO_AUTORIZADO;
+        return resposta;
+    }
+    
+    switch (pedido->comando) {
+        case COMANDO_POSICIONAR_NAVIO: {
+            if (pedido->parametro > DIAGONAL_SECUNDARIA) {
+                resposta.status = RESPOSTA_COMANDO_INVALIDO;
+                break;
+            }
+            ResultadoPosicionamento resultado = tentarPosicionarNavioBits(&jogo->tabuleiro, pedido->linha,
+                                                                          pedido->coluna, pedido->parametro);
+            resposta.status = resultado == POSICIONAMENTO_OK ? RESPOSTA_OK
+                            : resultado == POSICIONAMENTO_SOBREPOSTO ? RESPOSTA_SOBREPOSTO : RESPOSTA_POSICAO_INVALIDA;
+            if (resultado == POSICIONAMENTO_OK) {
+                Navio navio = {pedido->linha, pedido->coluna, pedido->parametro, NULL};
+                registrarNavioCamada(&jogo->navios, navio);
+            }
+            break;
+        }
+        case COMANDO_ATIRAR:
+            resposta.valor = (uint8_t) atirarCamadaNavios(&jogo->navios, pedido->linha, pedido->coluna, NULL);
+            resposta.extra = (uint16_t) mascaraContar(mascaraENao(jogo->tabuleiro.navios, jogo->navios.atingidas));
+            break;
+        case COMANDO_APLICAR_HABILIDADE: {
+            if (pedido->parametro > OCTAEDRO) {
+                resposta.status = RESPOSTA_COMANDO_INVALIDO;
+                break;
+            }
+            int antes = contarEfeitoBits(&jogo->tabuleiro);
+            Mascara128 area = obterMascaraHabilidade(pedido->parametro, pedido->linha, pedido->coluna);
+            aplicarHabilidadeTipoBits(&jogo->tabuleiro, pedido->parametro, pedido->linha, pedido->coluna);
+            resposta.valor = (uint8_t) __builtin_popcountll(naviosTocadosMascara(&jogo->navios, area));
+            resposta.extra = (uint16_t) (contarEfeitoBits(&jogo->tabuleiro) - antes);
+            break;
+        }
+        case COMANDO_CONSULTAR:
+            resposta.valor = (uint8_t) jogo->navios.num_navios;
+            resposta.extra = (uint16_t) mascaraContar(mascaraENao(jogo->tabuleiro.navios, jogo->navios.atingidas));
+            break;
+        case COMANDO_ENCERRAR_JOGO:
+            encerrarJogoServidor(servidor, conexao, jogo);
+            break;
+        default:
+            resposta.status = RESPOSTA_COMANDO_INVALIDO;
+            break;
+    }
+    return resposta;
+}
+
+// Função para ajustar os eventos de interesse da conexão: escrita quando há pendências, e leitura
+// só enquanto a saída acumulada está abaixo do limite. Sob contrapressão o EPOLLIN sai do conjunto;
+// senão o epoll (por nível) acordaria o laço sem parar enquanto o cliente não lê as respostas.
+static void atualizarInteresseConexao(ServidorPartidas* servidor, ConexaoServidor* conexao) {
+    size_t pendente = conexao->saida.tamanho - conexao->enviado;
+    uint32_t interesse = (pendente < LIMITE_SAIDA_CONEXAO ? EPOLLIN : 0) | (pendente > 0 ? EPOLLOUT : 0);
+    if (interesse == conexao->interesse) {
+        return;
+    }
+    
+    struct epoll_event evento;
+    evento.events = interesse;
+    evento.data.ptr = conexao;
+    epoll_ctl(servidor->epoll, EPOLL_CTL_MOD, conexao->descritor, &evento);
+    conexao->interesse = interesse;
+}
+
+// Função para escrever o que der da saída sem bloquear; devolve false se a conexão caiu
+static bool enviarSaidaConexao(ConexaoServidor* conexao) {
+    while (conexao->enviado < conexao->saida.tamanho) {
+        ssize_t escrito = send(conexao->descritor, conexao->saida.dados + conexao->enviado,
+                               conexao->saida.tamanho - conexao->enviado, MSG_NOSIGNAL);
+        if (escrito < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conexao->enviado += (size_t) escrito;
+    }
+    conexao->saida.tamanho = 0;
+    conexao->enviado = 0;
+    return true;
+}
+
+static void fecharConexaoServidor(ServidorPartidas* servidor, ConexaoServidor* conexao) {
+    while (conexao->primeiro_jogo >= 0) {
+        encerrarJogoServidor(servidor, conexao, &servidor->jogos[conexao->primeiro_jogo]);
+    }
+    epoll_ctl(servidor->epoll, EPOLL_CTL_DEL, conexao->descritor, NULL);
+    close(conexao->descritor);
+    liberarBufferSaida(&conexao->saida);
+    free(conexao);
+}
+
+// Função para ler tudo o que chegou, atender os quadros completos e responder; false se a conexão caiu
+static bool processarEntradaConexao(ServidorPartidas* servidor, ConexaoServidor* conexao) {
+    for (;;) {
+        // Com muita resposta acumulada, para de ler até o cliente consumir (contrapressão)
+        if (conexao->saida.tamanho - conexao->enviado >= LIMITE_SAIDA_CONEXAO) {
+            return true;
+        }
+        
+        ssize_t lido = recv(conexao->descritor, conexao->entrada + conexao->tamanho_entrada,
+                            sizeof(conexao->entrada) - conexao->tamanho_entrada, 0);
+        if (lido == 0) {
+            return false;
+        }
+        if (lido < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return errno == EAGAIN || errno == EWOULDBLOCK;
+        }
+        conexao->tamanho_entrada += (size_t) lido;
+        
+        size_t completos = conexao->tamanho_entrada / sizeof(PedidoServidor);
+        for (size_t i = 0; i < completos; i++) {
+            PedidoServidor pedido;
+            memcpy(&pedido, conexao->entrada + i * sizeof(PedidoServidor), sizeof(pedido));
+            RespostaServidor resposta = atenderPedido(servidor, conexao, &pedido);
+            anexarBufferSaida(&conexao->saida, (const char*) &resposta, sizeof(resposta));
+        }
+        servidor->pedidos += (long) completos;
+        
+        // Guarda o pedaço de quadro que ficou incompleto
+        size_t consumidos = completos * sizeof(PedidoServidor);
+        memmove(conexao->entrada, conexao->entrada + consumidos, conexao->tamanho_entrada - consumidos);
+        conexao->tamanho_entrada -= consumidos;
+        
+        if (!enviarSaidaConexao(conexao)) {
+            return false;
+        }
+    }
+}
+
+// Função para aceitar todas as conexões pendentes
+static void aceitarConexoes(ServidorPartidas* servidor) {
+    for (;;) {
+        int descritor = accept4(servidor->escuta, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (descritor < 0) {
+            return;
+        }
+        
+        ConexaoServidor* conexao = alocarMemoriaZerada(1, sizeof(ConexaoServidor));
+        if (conexao == NULL) {
+            close(descritor);
+            continue;
+        }
+        conexao->descritor = descritor;
+        conexao->interesse = EPOLLIN;
+        conexao->primeiro_jogo = -1;
+        int sim = 1;
+        setsockopt(descritor, IPPROTO_TCP, TCP_NODELAY, &sim, sizeof(sim));
+        
+        struct epoll_event evento;
+        evento.events = EPOLLIN;
+        evento.data.ptr = conexao;
+        if (epoll_ctl(servidor->epoll, EPOLL_CTL_ADD, descritor, &evento) != 0) {
+            close(descritor);
+            free(conexao);
+            continue;
+        }
+        servidor->conexoes++;
+    }
+}
+
+// Função para executar o servidor até receber SIGINT ou SIGTERM
+bool executarServidor(const char* endereco) {
+    ServidorPartidas servidor;
+    memset(&servidor, 0, sizeof(servidor));
+    servidor.primeiro_livre = -1;
+    
+    inicializarTabelasBits();
+    servidor.escuta = criarSoqueteEscuta(endereco);
+    if (servidor.escuta < 0) {
+        fprintf(stderr, "ERRO: não foi possível escutar em %s: %s\n", endereco, strerror(errno));
+        return false;
+    }
+    servidor.epoll = epoll_create1(EPOLL_CLOEXEC);
+    struct epoll_event evento;
+    evento.events = EPOLLIN;
+    evento.data.ptr = NULL;    // NULL identifica o soquete de escuta
+    epoll_ctl(servidor.epoll, EPOLL_CTL_ADD, servidor.escuta, &evento);
+    
+    struct sigaction acao;
+    memset(&acao, 0, sizeof(acao));
+    acao.sa_handler = tratarSinalParada;
+    sigemptyset(&acao.sa_mask);
+    sigaction(SIGINT, &acao, NULL);
+    sigaction(SIGTERM, &acao, NULL);
+    signal(SIGPIPE, SIG_IGN);
+    
+    fprintf(stderr, "Servidor escutando em %s\n", endereco);
+    struct epoll_event eventos[MAX_EVENTOS_EPOLL];
+    while (!servidorDeveParar) {
+        int prontos = epoll_wait(servidor.epoll, eventos, MAX_EVENTOS_EPOLL, -1);
+        for (int i = 0; i < prontos; i++) {
+            ConexaoServidor* conexao = eventos[i].data.ptr;
+            if (conexao == NULL) {
+                aceitarConexoes(&servidor);
+                continue;
+            }
+            
+            bool viva = !(eventos[i].events & (EPOLLERR | EPOLLHUP)) || (eventos[i].events & EPOLLIN);
+            if (viva && (eventos[i].events & EPOLLOUT)) {
+                viva = enviarSaidaConexao(conexao);
+            }
+            if (viva && (eventos[i].events & EPOLLIN)) {
+                viva = processarEntradaConexao(&servidor, conexao);
+            }
+            if (!viva) {
+                fecharConexaoServidor(&servidor, conexao);
+                continue;
+            }
+            atualizarInteresseConexao(&servidor, conexao);
+        }
+    }
+    
+    fprintf(stderr, "Servidor encerrado: %ld conexões, %ld pedidos, %ld jogos ainda ativos\n",
+            servidor.conexoes, servidor.pedidos, servidor.jogos_ativos);
+    close(servidor.epoll);
+    close(servidor.escuta);
+    free(servidor.jogos);
+    if (strncmp(endereco, "unix:", 5) == 0) {
+        unlink(endereco + 5);
+    }
+    return true;
+}
+
+// =====================================================================
+// CLIENTE DE TESTE DO SERVIDOR
+// =====================================================================
+
+// Latências registradas em faixas de 1 microssegundo (a última faixa acumula o que passar)
+#define FAIXAS_LATENCIA 10000
+
+typedef struct {
+    const char* endereco;
+    long partidas;
+    uint64_t semente;
+    int indice;
+    long pedidos;
+    long falhas;
+    uint32_t latencias[FAIXAS_LATENCIA];
+} TrabalhoCliente;
+
+// Função para enviar um pedido e esperar a resposta, medindo a latência
+static bool trocarQuadros(int descritor, TrabalhoCliente* trabalho, PedidoServidor pedido, RespostaServidor* resposta) {
+    double inicio = segundosMonotonicos();
+    if (!escreverTudo(descritor, (const char*) &pedido, sizeof(pedido))) {
+        return false;
+    }
+    
+    size_t recebido = 0;
+    while (recebido < sizeof(*resposta)) {
+        ssize_t lido = recv(descritor, (char*) resposta + recebido, sizeof(*resposta) - recebido, 0);
+        if (lido <= 0) {
+            if (lido < 0 && errno == EINTR) {
+                continue;
+            }
+            return false;
+        }
+        recebido += (size_t) lido;
+    }
+    
+    long microssegundos = (long) ((segundosMonotonicos() - inicio) * 1e6);
+    trabalho->latencias[microssegundos < FAIXAS_LATENCIA ? microssegundos : FAIXAS_LATENCIA - 1]++;
+    trabalho->pedidos++;
+    return true;
+}
+
+// Cada thread do cliente usa sua própria conexão e joga partidas completas entre dois robôs aleatórios
+static void* executarThreadCliente(void* argumento) {
+    TrabalhoCliente* trabalho = argumento;
+    GeradorAleatorio gerador;
+    int descritor = conectarServidor(trabalho->endereco);
+    if (descritor < 0) {
+        trabalho->falhas++;
+        return NULL;
+    }
+    semearGerador(&gerador, trabalho->semente, (uint64_t) trabalho->indice);
+    
+    for (long p = 0; p < trabalho->partidas; p++) {
+        uint32_t jogos[2];
+        RespostaServidor resposta;
+        uint8_t ordem[2][TOTAL_CELULAS];
+        
+        // Dois tabuleiros com frotas aleatórias
+        for (int lado = 0; lado < 2; lado++) {
+            PedidoServidor criar = {COMANDO_CRIAR_JOGO, 0, 0, 0, 0};
+            Navio navios[NAVIOS_PADRAO_PARTIDA];
+            if (!trocarQuadros(descritor, trabalho, criar, &resposta) || resposta.status != RESPOSTA_OK) {
+                trabalho->falhas++;
+                close(descritor);
+                return NULL;
+            }
+            jogos[lado] = resposta.jogo;
+            if (gerarFrotaAleatoria(&gerador, NAVIOS_PADRAO_PARTIDA, navios, NULL) == 0) {
+                trabalho->falhas++;
+                close(descritor);
+                return NULL;
+            }
+            for (int n = 0; n < NAVIOS_PADRAO_PARTIDA; n++) {
+                PedidoServidor posicionar = {COMANDO_POSICIONAR_NAVIO, (uint8_t) navios[n].orientacao,
+                                             (uint8_t) navios[n].linha, (uint8_t) navios[n].coluna, jogos[lado]};
+                if (!trocarQuadros(descritor, trabalho, posicionar, &resposta)) {
+                    trabalho->falhas++;
+                    close(descritor);
+                    return NULL;
+                }
+                trabalho->falhas += resposta.status != RESPOSTA_OK;
+            }
+            
+            // Ordem de tiro aleatória sem repetição (Fisher-Yates)
+            for (int i = 0; i < TOTAL_CELULAS; i++) {
+                ordem[lado][i] = (uint8_t) i;
+            }
+            for (int i = TOTAL_CELULAS - 1; i > 0; i--) {
+                int j = (int) aleatorioAte(&gerador, (uint32_t) i + 1);
+                uint8_t troca = ordem[lado][i];
+                ordem[lado][i] = ordem[lado][j];
+                ordem[lado][j] = troca;
+            }
+        }
+        
+        // Tiros alternados até uma frota afundar; os afundamentos informados precisam bater com as células restantes
+        bool terminou = false;
+        int afundados[2] = {0, 0};
+        for (int rodada = 0; rodada < TOTAL_CELULAS && !terminou; rodada++) {
+            for (int lado = 0; lado < 2 && !terminou; lado++) {
+                int alvo = ordem[lado][rodada];
+                PedidoServidor tiro = {COMANDO_ATIRAR, 0, (uint8_t) (alvo / TAMANHO_TABULEIRO),
+                                       (uint8_t) (alvo % TAMANHO_TABULEIRO), jogos[1 - lado]};
+                if (!trocarQuadros(descritor, trabalho, tiro, &resposta)) {
+                    trabalho->falhas++;
+                    close(descritor);
+                    return NULL;
+                }
+                afundados[lado] += resposta.valor == TIRO_AFUNDOU;
+                terminou = resposta.extra == 0;
+                trabalho->falhas += terminou != (afundados[lado] == NAVIOS_PADRAO_PARTIDA);
+            }
+        }
+        
+        for (int lado = 0; lado < 2; lado++) {
+            PedidoServidor encerrar = {COMANDO_ENCERRAR_JOGO, 0, 0, 0, jogos[lado]};
+            if (!trocarQuadros(descritor, trabalho, encerrar, &resposta)) {
+                trabalho->falhas++;
+                close(descritor);
+                return NULL;
+            }
+        }
+    }
+    
+    close(descritor);
+    return NULL;
+}
+
+// Função para executar o cliente de teste com várias conexões simultâneas
+bool executarClienteTeste(const char* endereco, long partidas, int conexoes, uint64_t semente) {
+    if (conexoes < 1) {
+        conexoes = 1;
+    }
+    TrabalhoCliente* trabalhos = alocarMemoriaZerada((size_t) conexoes, sizeof(TrabalhoCliente));
+    pthread_t* threads = alocarMemoria(sizeof(pthread_t) * (size_t) conexoes);
+    if (trabalhos == NULL || threads == NULL) {
+        free(trabalhos);
+        free(threads);
+        return false;
+    }
+    
+    double inicio = segundosMonotonicos();
+    int iniciadas = 0;
+    for (int c = 0; c < conexoes; c++) {
+        trabalhos[c].endereco = endereco;
+        trabalhos[c].partidas = partidas / conexoes + (c < partidas % conexoes);
+        trabalhos[c].semente = semente;
+        trabalhos[c].indice = c;
+        if (pthread_create(&threads[c], NULL, executarThreadCliente, &trabalhos[c]) != 0) {
+            break;
+        }
+        iniciadas++;
+    }
+    for (int c = 0; c < iniciadas; c++) {
+        pthread_join(threads[c], NULL);
+    }
+    double duracao = segundosMonotonicos() - inicio;
+    
+    // Junta as latências de todas as conexões para média e percentis
+    static uint32_t latencias[FAIXAS_LATENCIA];
+    memset(latencias, 0, sizeof(latencias));
+    long pedidos = 0, falhas = 0;
+    double soma = 0.0;
+    for (int c = 0; c < iniciadas; c++) {
+        pedidos += trabalhos[c].pedidos;
+        falhas += trabalhos[c].falhas;
+        for (int f = 0; f < FAIXAS_LATENCIA; f++) {
+            latencias[f] += trabalhos[c].latencias[f];
+            soma += (double) f * trabalhos[c].latencias[f];
+        }
+    }
+    long acumulado = 0;
+    int p50 = -1, p99 = -1;
+    for (int f = 0; f < FAIXAS_LATENCIA; f++) {
+        acumulado += latencias[f];
+        if (p50 < 0 && acumulado * 2 >= pedidos) {
+            p50 = f;
+        }
+        if (p99 < 0 && acumulado * 100 >= pedidos * 99) {
+            p99 = f;
+        }
+    }
+    
+    printf("%ld partidas, %d conexões, %ld pedidos, %ld falhas\n", partidas, iniciadas, pedidos, falhas);
+    printf("%.0f pedidos/s, latência média %.1f us, p50 %d us, p99 %d us\n", duracao > 0 ? pedidos / duracao : 0.0,
+           pedidos > 0 ? soma / pedidos : 0.0, p50, p99);
+    
+    free(trabalhos);
+    free(threads);
+    return falhas == 0 && iniciadas == conexoes;
+}
+
+// =====================================================================
+// MICROBENCHMARKS DOS CAMINHOS CRÍTICOS
+// =====================================================================
+
+// Tempo mínimo de medição por caso, em segundos
+#define TEMPO_MINIMO_BENCHMARK 0.05
+
+// Resultado de um caso de benchmark
+typedef struct {
+    const char* nome;
+    int tamanho;          // Lado do tabuleiro
+    int habilidades;      // Habilidades aplicadas por operação (0 quando não se aplica)
+    long iteracoes;
+    double ns_por_operacao;
+    double alocacoes_por_operacao;
+    double bytes_por_operacao;
+} ResultadoBenchmark;
+
+// Estado compartilhado pelos casos de benchmark
+typedef struct {
+    int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO];
+    TabuleiroGrande grande;
+    TabuleiroPreguicoso preguicoso;
+    TabuleiroBits bits;
+    HabilidadeEspecial habilidades[4096];
+    int num_habilidades;
+    int tamanho;
+    uint32_t* cobertura;
+    EstadoJogo modelo;
+    ArenaEstados arena;
+    TabuleiroDenso denso;
+} ContextoBenchmark;
+
+typedef void (*OperacaoBenchmark)(ContextoBenchmark* contexto, long iteracao);
+
+// Acumulador volátil: impede que o compilador descarte operações cujo resultado não é usado
+static volatile long sumidouroBenchmark;
+
+// Função para medir uma operação: dobra o número de iterações até passar do tempo mínimo
+static ResultadoBenchmark medirOperacao(const char* nome, OperacaoBenchmark operacao, ContextoBenchmark* contexto) {
+    ResultadoBenchmark resultado = {nome, contexto->tamanho, contexto->num_habilidades, 0, 0.0, 0.0, 0.0};
+    
+    for (long iteracoes = 1; ; iteracoes *= 2) {
+        long alocacoes_antes = alocacoesDaThread;
+        long bytes_antes = bytesAlocadosDaThread;
+        double inicio = segundosMonotonicos();
+        
+        for (long i = 0; i < iteracoes; i++) {
+            operacao(contexto, i);
+        }
+        
+        double duracao = segundosMonotonicos() - inicio;
+        if (duracao >= TEMPO_MINIMO_BENCHMARK || iteracoes >= (1L << 30)) {
+            resultado.iteracoes = iteracoes;
+            resultado.ns_por_operacao = duracao * 1e9 / iteracoes;
+            resultado.alocacoes_por_operacao = (double) (alocacoesDaThread - alocacoes_antes) / iteracoes;
+            resultado.bytes_por_operacao = (double) (bytesAlocadosDaThread - bytes_antes) / iteracoes;
+            return resultado;
+        }
+    }
+}
+
+// Operações medidas no tabuleiro fixo 10x10
+static void benchInicializarTabuleiro(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    inicializarTabuleiro(contexto->tabuleiro);
+}
+
+static void benchPosicaoValida(ContextoBenchmark* contexto, long iteracao) {
+    (void) contexto;
+    sumidouroBenchmark += posicaoValida((int) (iteracao % 12) - 1, (int) (iteracao / 12 % 12) - 1,
+                                        TAMANHO_NAVIO, (OrientacaoNavio) (iteracao & 3));
+}
+
+static void benchVerificarSobreposicao(ContextoBenchmark* contexto, long iteracao) {
+    int indice = (int) (iteracao % numPosicionamentosLegais);
+    const PosicionamentoLegal* posicionamento = &posicionamentosLegais[indice];
+    sumidouroBenchmark += verificarSobreposicao(contexto->tabuleiro, posicionamento->linha, posicionamento->coluna,
+                                                TAMANHO_NAVIO, posicionamento->orientacao);
+}
+
+static void benchPosicionarNavio(ContextoBenchmark* contexto, long iteracao) {
+    const PosicionamentoLegal* posicionamento = &posicionamentosLegais[iteracao % numPosicionamentosLegais];
+    Navio navio = {posicionamento->linha, posicionamento->coluna, posicionamento->orientacao, "Benchmark"};
+    
+    sumidouroBenchmark += posicionarNavio(contexto->tabuleiro, navio, NULL, NULL);
+    
+    // Desfaz o navio para que a próxima iteração encontre o tabuleiro vazio
+    for (int i = 0; i < TAMANHO_NAVIO; i++) {
+        int linha_atual, coluna_atual;
+        calcularPosicaoNavio(navio.linha, navio.coluna, navio.orientacao, i, &linha_atual, &coluna_atual);
+        contexto->tabuleiro[linha_atual][coluna_atual] = AGUA;
+    }
+}
+
+static void benchCriarHabilidadeCone(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    criarHabilidadeCone(&contexto->habilidades[0]);
+}
+
+static void benchCriarHabilidadeCruz(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    criarHabilidadeCruz(&contexto->habilidades[0]);
+}
+
+static void benchCriarHabilidadeOctaedro(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    criarHabilidadeOctaedro(&contexto->habilidades[0]);
+}
+
+static void benchAplicarHabilidade(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    for (int h = 0; h < contexto->num_habilidades; h++) {
+        aplicarHabilidade(contexto->tabuleiro, &contexto->habilidades[h], NULL, NULL);
+    }
+}
+
+// Aplica cada habilidade e a desfaz em seguida, como numa busca em árvore
+static void benchFazerDesfazerHabilidade(ContextoBenchmark* contexto, long iteracao) {
+    AlteracaoTabuleiro alteracao;
+    (void) iteracao;
+    for (int h = 0; h < contexto->num_habilidades; h++) {
+        marcarAreaHabilidade(contexto->tabuleiro, &contexto->habilidades[h], NULL, &alteracao);
+        desfazerAlteracao(contexto->tabuleiro, &alteracao, NULL);
+    }
+}
+
+static void benchExibirTabuleiro(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    exibirTabuleiro(contexto->tabuleiro);
+}
+
+static void benchExibirTabuleiroNumerico(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    exibirTabuleiroNumerico(contexto->tabuleiro);
+}
+
+// Operações medidas no motor em bits
+// Estado montado do zero (navio a navio, habilidade a habilidade) versus clonado do modelo
+static void benchMontarEstadoJogo(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    EstadoJogo* estado = alocarEstadoArena(&contexto->arena);
+    if (estado == NULL) {
+        reiniciarArenaEstados(&contexto->arena);
+        estado = alocarEstadoArena(&contexto->arena);
+    }
+    montarEstadoNivelMestre(estado);
+    sumidouroBenchmark += estado->num_navios;
+}
+
+static void benchClonarEstadoJogo(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    EstadoJogo* estado = clonarEstadoArena(&contexto->arena, &contexto->modelo);
+    if (estado == NULL) {
+        reiniciarArenaEstados(&contexto->arena);
+        estado = clonarEstadoArena(&contexto->arena, &contexto->modelo);
+    }
+    sumidouroBenchmark += estado->num_navios;
+}
+
+static void benchPosicionarNavioBits(ContextoBenchmark* contexto, long iteracao) {
+    const PosicionamentoLegal* posicionamento = &posicionamentosLegais[iteracao % numPosicionamentosLegais];
+    inicializarTabuleiroBits(&contexto->bits);
+    sumidouroBenchmark += tentarPosicionarNavioBits(&contexto->bits, posicionamento->linha, posicionamento->coluna,
+                                                    posicionamento->orientacao);
+}
+
+static void benchAplicarHabilidadeBits(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    for (int h = 0; h < contexto->num_habilidades; h++) {
+        aplicarHabilidadeBits(&contexto->bits, &contexto->habilidades[h]);
+    }
+}
+
+// Operações medidas no tabuleiro grande, com o lado variando
+static void benchPosicaoValidaGrande(ContextoBenchmark* contexto, long iteracao) {
+    int lado = contexto->tamanho;
+    sumidouroBenchmark += posicaoValidaDimensoes((int) (iteracao * 7 % lado), (int) (iteracao * 13 % lado),
+                                                 TAMANHO_NAVIO, (OrientacaoNavio) (iteracao & 3), lado, lado);
+}
+
+static void benchPosicionarNavioGrande(ContextoBenchmark* contexto, long iteracao) {
+    // Posições espalhadas por hash, sem repetir em ciclo curto mesmo nos tabuleiros maiores
+    uint64_t semente = (uint64_t) iteracao;
+    uint64_t hash = misturarSplitMix64(&semente);
+    int lado = contexto->tamanho;
+    Navio navio = {(int) ((hash & 0xFFFFFFFF) % (uint64_t) lado), (int) ((hash >> 32) % (uint64_t) lado),
+                   (OrientacaoNavio) (iteracao & 3), "Benchmark"};
+    sumidouroBenchmark += posicionarNavioGrande(&contexto->grande, navio);
+}
+
+static void benchAplicarHabilidadeGrande(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    for (int h = 0; h < contexto->num_habilidades; h++) {
+        aplicarHabilidadeGrande(&contexto->grande, &contexto->habilidades[h]);
+    }
+}
+
+static void benchEnfileirarHabilidadePreguicosa(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    for (int h = 0; h < contexto->num_habilidades; h++) {
+        enfileirarHabilidadePreguicosa(&contexto->preguicoso, &contexto->habilidades[h]);
+    }
+}
+
+static void benchPosicionarNavioDenso(ContextoBenchmark* contexto, long iteracao) {
+    int lado = contexto->denso.lado;
+    Navio navio = {(int) (iteracao % lado), (int) ((iteracao / lado) % lado), (OrientacaoNavio) (iteracao & 3), "Bench"};
+    if ((iteracao & 255) == 0) {
+        contexto->denso.motor->inicializar(contexto->denso.celulas, lado);
+    }
+    sumidouroBenchmark += posicionarNavioDenso(&contexto->denso, navio);
+}
+
+static void benchAplicarHabilidadeDenso(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    for (int h = 0; h < contexto->num_habilidades; h++) {
+        sumidouroBenchmark += aplicarHabilidadeDenso(&contexto->denso, &contexto->habilidades[h]);
+    }
+}
+
+static void benchCalcularCoberturaLote(ContextoBenchmark* contexto, long iteracao) {
+    (void) iteracao;
+    calcularCoberturaLote(contexto->habilidades, contexto->num_habilidades, contexto->tamanho, contexto->tamanho,
+                          contexto->cobertura);
+}
+
+// Função para preparar num_habilidades habilidades de tipos alternados espalhadas por um tabuleiro de lado 'lado'
+static void prepararHabilidadesBenchmark(ContextoBenchmark* contexto, int num_habilidades, int lado) {
+    GeradorAleatorio gerador;
+    semearGerador(&gerador, 12345, (uint64_t) lado);
+    
+    contexto->num_habilidades = num_habilidades;
+    for (int h = 0; h < num_habilidades; h++) {
+        HabilidadeEspecial* habilidade = &contexto->habilidades[h];
+        habilidade->tipo = (TipoHabilidade) (h % 3);
+        habilidade->nome = "Benchmark";
+        habilidade->linha_origem = (int) aleatorioAte(&gerador, (uint32_t) lado);
+        habilidade->coluna_origem = (int) aleatorioAte(&gerador, (uint32_t) lado);
+        criarHabilidadePorTipo(habilidade, habilidade->tipo);
+    }
+}
+
+// Função para gravar um resultado em CSV ou em JSON (um objeto por linha)
+static void gravarResultadoBenchmark(FILE* saida, const ResultadoBenchmark* resultado, bool json) {
+    if (json) {
+        fprintf(saida, "{\"funcao\":\"%s\",\"tamanho\":%d,\"habilidades\":%d,\"iteracoes\":%ld,"
+                "\"ns_por_op\":%.2f,\"alocacoes_por_op\":%.4f,\"bytes_por_op\":%.2f}\n",
+                resultado->nome, resultado->tamanho, resultado->habilidades, resultado->iteracoes,
+                resultado->ns_por_operacao, resultado->alocacoes_por_operacao, resultado->bytes_por_operacao);
+    } else {
+        fprintf(saida, "%s,%d,%d,%ld,%.2f,%.4f,%.2f\n", resultado->nome, resultado->tamanho,
+                resultado->habilidades, resultado->iteracoes, resultado->ns_por_operacao,
+                resultado->alocacoes_por_operacao, resultado->bytes_por_operacao);
+    }
+    fflush(saida);
+}
+
+// Função para executar toda a suíte e gravar os resultados em 'saida'.
+// A saída padrão é desviada para /dev/null durante as medições, porque várias funções imprimem.
+bool executarBenchmarks(FILE* saida, bool json) {
+    static ContextoBenchmark contexto;
+    static const int lados[] = {10, 100, 1000, 10000};
+    static const int contagens_habilidades[] = {1, 16, 256, 4096};
+    const int num_lados = (int) (sizeof(lados) / sizeof(lados[0]));
+    const int num_contagens = (int) (sizeof(contagens_habilidades) / sizeof(contagens_habilidades[0]));
+    
+    inicializarPosicionamentosLegais();
+    inicializarEstenceis();
+    montarEstadoNivelMestre(&contexto.modelo);
+    if (!criarArenaEstados(&contexto.arena, LOTE_ARENA_ESTADOS)) {
+        return false;
+    }
+    
+    fflush(stdout);
+    int saida_original = dup(STDOUT_FILENO);
+    int nulo = open("/dev/null", O_WRONLY);
+    if (saida_original < 0 || nulo < 0) {
+        destruirArenaEstados(&contexto.arena);
+        return false;
+    }
+    // Se 'saida' é a própria saída padrão, os resultados vão para a cópia guardada
+    FILE* destino = saida == stdout ? fdopen(dup(saida_original), "w") : saida;
+    if (destino == NULL) {
+        destruirArenaEstados(&contexto.arena);
+        return false;
+    }
+    dup2(nulo, STDOUT_FILENO);
+    
+    if (!json) {
+        fprintf(destino, "funcao,tamanho,habilidades,iteracoes,ns_por_op,alocacoes_por_op,bytes_por_op\n");
+    }
+    
+    // Casos do tabuleiro fixo
+    ResultadoBenchmark resultado;
+    contexto.tamanho = TAMANHO_TABULEIRO;
+    contexto.num_habilidades = 0;
+    memset(contexto.tabuleiro, 0, sizeof(contexto.tabuleiro));
+    
+    struct {
+        const char* nome;
+        OperacaoBenchmark operacao;
+    } casos_fixos[] = {
+        {"inicializarTabuleiro", benchInicializarTabuleiro},
+        {"posicaoValida", benchPosicaoValida},
+        {"verificarSobreposicao", benchVerificarSobreposicao},
+        {"posicionarNavio", benchPosicionarNavio},
+        {"criarHabilidadeCone", benchCriarHabilidadeCone},
+        {"criarHabilidadeCruz", benchCriarHabilidadeCruz},
+        {"criarHabilidadeOctaedro", benchCriarHabilidadeOctaedro},
+        {"exibirTabuleiro", benchExibirTabuleiro},
+        {"exibirTabuleiroNumerico", benchExibirTabuleiroNumerico},
+        {"posicionarNavioBits", benchPosicionarNavioBits},
+        {"montarEstadoJogo", benchMontarEstadoJogo},
+        {"clonarEstadoJogo", benchClonarEstadoJogo},
+    };
+    for (size_t c = 0; c < sizeof(casos_fixos) / sizeof(casos_fixos[0]); c++) {
+        resultado = medirOperacao(casos_fixos[c].nome, casos_fixos[c].operacao, &contexto);
+        gravarResultadoBenchmark(destino, &resultado, json);
+    }
+    destruirArenaEstados(&contexto.arena);
+    
+    // Aplicação de habilidades no tabuleiro fixo, variando a quantidade
+    for (int k = 0; k < num_contagens; k++) {
+        prepararHabilidadesBenchmark(&contexto, contagens_habilidades[k], TAMANHO_TABULEIRO);
+        
+        memset(contexto.tabuleiro, 0, sizeof(contexto.tabuleiro));
+        resultado = medirOperacao("aplicarHabilidade", benchAplicarHabilidade, &contexto);
+        gravarResultadoBenchmark(destino, &resultado, json);
+        
+        resultado = medirOperacao("fazerDesfazerHabilidade", benchFazerDesfazerHabilidade, &contexto);
+        gravarResultadoBenchmark(destino, &resultado, json);
+        
+        inicializarTabuleiroBits(&contexto.bits);
+        resultado = medirOperacao("aplicarHabilidadeBits", benchAplicarHabilidadeBits, &contexto);
+        gravarResultadoBenchmark(destino, &resultado, json);
+    }
+    
+    // Motores densos: o especializado de cada lado contra o genérico (17 não tem especialização)
+    static const int lados_motor[] = {10, 16, 17, 64};
+    for (size_t l = 0; l < sizeof(lados_motor) / sizeof(lados_motor[0]); l++) {
+        const MotorTabuleiro* motores[2] = {obterMotorTabuleiro(lados_motor[l]), &motorGenerico};
+        for (int m = 0; m < 2; m++) {
+            if (m == 1 && motores[0] == &motorGenerico) {
+                continue;
+            }
+            if (!criarTabuleiroDenso(&contexto.denso, lados_motor[l], motores[m])) {
+                continue;
+            }
+            
+            contexto.tamanho = lados_motor[l];
+            contexto.num_habilidades = 0;
+            resultado = medirOperacao(m == 0 ? "posicionarNavioDenso" : "posicionarNavioDensoGenerico",
+                                      benchPosicionarNavioDenso, &contexto);
+            gravarResultadoBenchmark(destino, &resultado, json);
+            
+            prepararHabilidadesBenchmark(&contexto, 16, lados_motor[l]);
+            contexto.tamanho = lados_motor[l];
+            resultado = medirOperacao(m == 0 ? "aplicarHabilidadeDenso" : "aplicarHabilidadeDensoGenerico",
+                                      benchAplicarHabilidadeDenso, &contexto);
+            gravarResultadoBenchmark(destino, &resultado, json);
+            destruirTabuleiroDenso(&contexto.denso);
+        }
+    }
+    
+    // Tabuleiro grande, variando o lado e a quantidade de habilidades
+    for (int l = 0; l < num_lados; l++) {
+        contexto.tamanho = lados[l];
+        contexto.num_habilidades = 0;
+        
+        resultado = medirOperacao("posicaoValidaDimensoes", benchPosicaoValidaGrande, &contexto);
+        gravarResultadoBenchmark(destino, &resultado, json);
+        
+        criarTabuleiroGrande(&contexto.grande, lados[l], lados[l]);
+        resultado = medirOperacao("posicionarNavioGrande", benchPosicionarNavioGrande, &contexto);
+        gravarResultadoBenchmark(destino, &resultado, json);
+        destruirTabuleiroGrande(&contexto.grande);
+        
+        for (int k = 0; k < num_contagens; k++) {
+            prepararHabilidadesBenchmark(&contexto, contagens_habilidades[k], lados[l]);
+            contexto.tamanho = lados[l];
+            criarTabuleiroGrande(&contexto.grande, lados[l], lados[l]);
+            resultado = medirOperacao("aplicarHabilidadeGrande", benchAplicarHabilidadeGrande, &contexto);
+            gravarResultadoBenchmark(destino, &resultado, json);
+            destruirTabuleiroGrande(&contexto.grande);
+            
+            if (criarTabuleiroPreguicoso(&contexto.preguicoso, lados[l], lados[l])) {
+                resultado = medirOperacao("enfileirarHabilidadePreguicosa", benchEnfileirarHabilidadePreguicosa, &contexto);
+                gravarResultadoBenchmark(destino, &resultado, json);
+            }
+            destruirTabuleiroPreguicoso(&contexto.preguicoso);
+            
+            // A cobertura em lote usa um contador por célula; o maior tabuleiro não cabe com folga
+            if (lados[l] <= 1000) {
+                contexto.cobertura = alocarMemoria((size_t) lados[l] * lados[l] * sizeof(uint32_t));
+                if (contexto.cobertura != NULL) {
+                    resultado = medirOperacao("calcularCoberturaLote", benchCalcularCoberturaLote, &contexto);
+                    gravarResultadoBenchmark(destino, &resultado, json);
+                    free(contexto.cobertura);
+                }
+            }
+        }
+    }
+    
+    fflush(stdout);
+    dup2(saida_original, STDOUT_FILENO);
+    close(saida_original);
+    close(nulo);
+    if (destino != saida) {
+        fclose(destino);
+    }
+    return true;
+}
+
 // =====================================================================
 // FUNÇÕES DOS NÍVEIS DO JOGO
 // =====================================================================
@@ -394,7 +7885,9 @@ void executarNivelNovato() {
     printf("Posicionamento básico de 2 navios\n\n");
     
     int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO];
+    INSTRUMENTAR_FASE_INICIO(FASE_INICIALIZACAO);
     inicializarTabuleiro(tabuleiro);
+    INSTRUMENTAR_FASE_FIM(FASE_INICIALIZACAO);
     
     // Definir 2 navios: horizontal e vertical
     Navio navios[2] = {
@@ -403,17 +7896,21 @@ void executarNivelNovato() {
     };
     
     printf("=== POSICIONAMENTO DOS NAVIOS ===\n");
+    INSTRUMENTAR_FASE_INICIO(FASE_POSICIONAMENTO);
     bool sucesso = true;
     for (int i = 0; i < 2; i++) {
-        if (!posicionarNavio(tabuleiro, navios[i])) {
+        if (!posicionarNavio(tabuleiro, navios[i], NULL, NULL)) {
             sucesso = false;
             break;
         }
     }
+    INSTRUMENTAR_FASE_FIM(FASE_POSICIONAMENTO);
     
     if (sucesso) {
+        INSTRUMENTAR_FASE_INICIO(FASE_RENDERIZACAO);
         exibirTabuleiro(tabuleiro);
         exibirTabuleiroNumerico(tabuleiro);
+        INSTRUMENTAR_FASE_FIM(FASE_RENDERIZACAO);
         
         printf("=== RESUMO DO NÍVEL NOVATO ===\n");
         printf("✅ 2 navios posicionados com sucesso!\n");
@@ -434,7 +7931,9 @@ void executarNivelAventureiro() {
     printf("Posicionamento avançado de 4 navios com orientações diagonais\n\n");
     
     int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO];
+    INSTRUMENTAR_FASE_INICIO(FASE_INICIALIZACAO);
     inicializarTabuleiro(tabuleiro);
+    INSTRUMENTAR_FASE_FIM(FASE_INICIALIZACAO);
     
     // Definir 4 navios com diferentes orientações
     Navio navios[4] = {
@@ -445,17 +7944,21 @@ void executarNivelAventureiro() {
     };
     
     printf("=== POSICIONAMENTO DOS NAVIOS ===\n");
+    INSTRUMENTAR_FASE_INICIO(FASE_POSICIONAMENTO);
     bool sucesso = true;
     for (int i = 0; i < 4; i++) {
-        if (!posicionarNavio(tabuleiro, navios[i])) {
+        if (!posicionarNavio(tabuleiro, navios[i], NULL, NULL)) {
             sucesso = false;
             break;
         }
     }
+    INSTRUMENTAR_FASE_FIM(FASE_POSICIONAMENTO);
     
     if (sucesso) {
+        INSTRUMENTAR_FASE_INICIO(FASE_RENDERIZACAO);
         exibirTabuleiro(tabuleiro);
         exibirTabuleiroNumerico(tabuleiro);
+        INSTRUMENTAR_FASE_FIM(FASE_RENDERIZACAO);
         
         printf("=== RESUMO DO NÍVEL AVENTUREIRO ===\n");
         printf("✅ 4 navios posicionados com sucesso!\n");
@@ -483,25 +7986,26 @@ void executarNivelMestre() {
     printf("Sistema completo com navios e habilidades especiais\n\n");
     
     int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO];
+    EstatisticasTabuleiro estatisticas;
+    INSTRUMENTAR_FASE_INICIO(FASE_INICIALIZACAO);
     inicializarTabuleiro(tabuleiro);
+    inicializarEstatisticas(&estatisticas);
+    INSTRUMENTAR_FASE_FIM(FASE_INICIALIZACAO);
     
     // Definir 4 navios
-    Navio navios[4] = {
-        {1, 1, HORIZONTAL, "Fragata (Horizontal)"},
-        {6, 8, VERTICAL, "Destroyer (Vertical)"},
-        {0, 5, DIAGONAL_PRINCIPAL, "Cruzador (Diagonal \\)"},
-        {8, 4, DIAGONAL_SECUNDARIA, "Submarino (Diagonal /)"}
-    };
+    const Navio* navios = naviosNivelMestre;
     
     // Posicionar navios
     printf("=== POSICIONAMENTO DOS NAVIOS ===\n");
+    INSTRUMENTAR_FASE_INICIO(FASE_POSICIONAMENTO);
     bool sucesso = true;
     for (int i = 0; i < 4; i++) {
-        if (!posicionarNavio(tabuleiro, navios[i])) {
+        if (!posicionarNavio(tabuleiro, navios[i], &estatisticas, NULL)) {
             sucesso = false;
             break;
         }
     }
+    INSTRUMENTAR_FASE_FIM(FASE_POSICIONAMENTO);
     
     if (!sucesso) {
         printf("❌ Erro no posicionamento dos navios!\n");
@@ -512,6 +8016,7 @@ void executarNivelMestre() {
     // Criar e configurar habilidades especiais
     printf("=== CRIANDO HABILIDADES ESPECIAIS ===\n");
     HabilidadeEspecial habilidades[3];
+    INSTRUMENTAR_FASE_INICIO(FASE_CONSTRUCAO_HABILIDADES);
     
     // Habilidade 1: CONE
     habilidades[0].linha_origem = 2;
@@ -536,6 +8041,7 @@ void executarNivelMestre() {
     habilidades[2].nome = "OCTAEDRO";
     printf("Criando habilidade OCTAEDRO...\n");
     criarHabilidadeOctaedro(&habilidades[2]);
+    INSTRUMENTAR_FASE_FIM(FASE_CONSTRUCAO_HABILIDADES);
     
     printf("Todas as habilidades criadas com sucesso!\n\n");
     
@@ -547,26 +8053,18 @@ void executarNivelMestre() {
     
     // Aplicar habilidades ao tabuleiro
     printf("=== APLICANDO HABILIDADES ===\n");
+    INSTRUMENTAR_FASE_INICIO(FASE_APLICACAO_HABILIDADES);
     for (int i = 0; i < 3; i++) {
-        aplicarHabilidade(tabuleiro, &habilidades[i]);
+        aplicarHabilidade(tabuleiro, &habilidades[i], &estatisticas, NULL);
     }
+    INSTRUMENTAR_FASE_FIM(FASE_APLICACAO_HABILIDADES);
     
     // Exibir resultado final
     printf("=== RESULTADO FINAL ===\n");
+    INSTRUMENTAR_FASE_INICIO(FASE_RENDERIZACAO);
     exibirTabuleiro(tabuleiro);
     exibirTabuleiroNumerico(tabuleiro);
-    
-    // Estatísticas finais
-    int contador_agua = 0, contador_navio = 0, contador_efeito = 0;
-    for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
-        for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
-            switch (tabuleiro[i][j]) {
-                case AGUA: contador_agua++; break;
-                case NAVIO: contador_navio++; break;
-                case AREA_EFEITO: contador_efeito++; break;
-            }
-        }
-    }
+    INSTRUMENTAR_FASE_FIM(FASE_RENDERIZACAO);
     
     printf("=== RESUMO DO NÍVEL MESTRE ===\n");
     printf("✅ 4 navios posicionados com sucesso!\n");
@@ -574,14 +8072,143 @@ void executarNivelMestre() {
     printf("✅ Tipos de habilidade: CONE, CRUZ, OCTAEDRO\n");
     printf("✅ Sistema de área de efeito implementado\n");
     printf("\n=== ESTATÍSTICAS FINAIS ===\n");
-    printf("Posições com água: %d\n", contador_agua);
-    printf("Posições com navios: %d\n", contador_navio);
-    printf("Posições com área de efeito: %d\n", contador_efeito);
+    printf("Posições com água: %d\n", estatisticas.agua);
+    printf("Posições com navios: %d\n", estatisticas.navios);
+    printf("Posições com área de efeito: %d\n", estatisticas.efeito);
     printf("Total de posições: %d\n", TAMANHO_TABULEIRO * TAMANHO_TABULEIRO);
     
     pausar();
 }
 
+// =====================================================================
+// MODO EM LOTE (SEM MENU, SEM TERMINAL)
+// =====================================================================
+
+// Formato de entrada: um cenário por linha, com itens separados por espaços
+//   N:linha,coluna,orientacao   navio (orientação H, V, P, S ou 0-3)
+//   H:tipo,linha,coluna         habilidade (tipo C, X, O ou 0-2)
+// Linhas vazias ou iniciadas por '#' são ignoradas. Os itens são aplicados na ordem em que aparecem.
+//
+// Saída: uma linha por cenário no formato
+//   cenario,status,navios_posicionados,agua,navios,efeito
+// onde status é OK, INVALIDO, SOBREPOSTO ou SINTAXE.
+
+// Estado do cenário processado
+typedef enum {
+    CENARIO_OK,
+    CENARIO_INVALIDO,
+    CENARIO_SOBREPOSTO,
+    CENARIO_SINTAXE
+} StatusCenario;
+
+// Função para obter o nome de um status de cenário
+const char* obterNomeStatusCenario(StatusCenario status) {
+    switch (status) {
+        case CENARIO_OK: return "OK";
+        case CENARIO_INVALIDO: return "INVALIDO";
+        case CENARIO_SOBREPOSTO: return "SOBREPOSTO";
+        case CENARIO_SINTAXE: return "SINTAXE";
+        default: return "?";
+    }
+}
+
+// Função para converter o código textual de uma orientação (-1 se inválido)
+int lerCodigoOrientacao(char codigo) {
+    switch (codigo) {
+        case 'H': case 'h': case '0': return HORIZONTAL;
+        case 'V': case 'v': case '1': return VERTICAL;
+        case 'P': case 'p': case '2': return DIAGONAL_PRINCIPAL;
+        case 'S': case 's': case '3': return DIAGONAL_SECUNDARIA;
+        default: return -1;
+    }
+}
+
+// Função para converter o código textual de um tipo de habilidade (-1 se inválido)
+int lerCodigoHabilidade(char codigo) {
+    switch (codigo) {
+        case 'C': case 'c': case '0': return CONE;
+        case 'X': case 'x': case '1': return CRUZ;
+        case 'O': case 'o': case '2': return OCTAEDRO;
+        default: return -1;
+    }
+}
+
+// Função para processar um cenário (uma linha) sobre um tabuleiro em bits
+StatusCenario processarCenarioLote(const char* linha, TabuleiroBits* tabuleiro, int* navios_posicionados) {
+    const char* p = linha;
+    
+    inicializarTabuleiroBits(tabuleiro);
+    *navios_posicionados = 0;
+    
+    while (true) {
+        while (*p == ' ' || *p == '\t') {
+            p++;
+        }
+        if (*p == '\0' || *p == '\n' || *p == '\r') {
+            return CENARIO_OK;
+        }
+        
+        char item = *p++;
+        if (!consumirCaractere(&p, ':')) {
+            return CENARIO_SINTAXE;
+        }
+        
+        int codigo, linha_item, coluna_item;
+        if (item == 'N' || item == 'n') {
+            if (!lerInteiroTexto(&p, &linha_item) || !consumirCaractere(&p, ',') ||
+                !lerInteiroTexto(&p, &coluna_item) || !consumirCaractere(&p, ',') ||
+                (codigo = lerCodigoOrientacao(*p++)) < 0) {
+                return CENARIO_SINTAXE;
+            }
+            
+            ResultadoPosicionamento resultado = tentarPosicionarNavioBits(tabuleiro, linha_item, coluna_item, codigo);
+            if (resultado == POSICIONAMENTO_INVALIDO) {
+                return CENARIO_INVALIDO;
+            }
+            if (resultado == POSICIONAMENTO_SOBREPOSTO) {
+                return CENARIO_SOBREPOSTO;
+            }
+            (*navios_posicionados)++;
+        } else if (item == 'H' || item == 'h') {
+            if ((codigo = lerCodigoHabilidade(*p++)) < 0 || !consumirCaractere(&p, ',') ||
+                !lerInteiroTexto(&p, &linha_item) || !consumirCaractere(&p, ',') ||
+                !lerInteiroTexto(&p, &coluna_item)) {
+                return CENARIO_SINTAXE;
+            }
+            aplicarHabilidadeTipoBits(tabuleiro, codigo, linha_item, coluna_item);
+        } else {
+            return CENARIO_SINTAXE;
+        }
+    }
+}
+
+// Função para executar o modo em lote: lê cenários de entrada e grava um registro por cenário em saida
+long executarModoLote(FILE* entrada, FILE* saida) {
+    static char buffer_saida[1 << 16];
+    setvbuf(saida, buffer_saida, _IOFBF, sizeof(buffer_saida));
+    
+    char* linha = NULL;
+    size_t capacidade = 0;
+    long cenarios = 0;
+    TabuleiroBits tabuleiro;
+    
+    while (getline(&linha, &capacidade, entrada) != -1) {
+        if (linha[0] == '#' || linha[0] == '\n' || linha[0] == '\0') {
+            continue;
+        }
+        
+        int navios_posicionados;
+        StatusCenario status = processarCenarioLote(linha, &tabuleiro, &navios_posicionados);
+        fprintf(saida, "%ld,%s,%d,%d,%d,%d\n", cenarios, obterNomeStatusCenario(status), navios_posicionados,
+                contarAguaBits(&tabuleiro), contarNaviosBits(&tabuleiro), contarEfeitoBits(&tabuleiro));
+        cenarios++;
+    }
+    
+    free(linha);
+    fflush(saida);
+    return cenarios;
+}
+
 // =====================================================================
 // SISTEMA DE MENU PRINCIPAL
 // =====================================================================
@@ -621,11 +8248,883 @@ void exibirCabecalho() {
     printf("╚══════════════════════════════════════════════════════╝\n");
 }
 
+// =====================================================================
+// MODOS DE LINHA DE COMANDO
+// =====================================================================
+
+// Função para exibir os modos não interativos disponíveis
+void exibirAjudaLinhaComando(const char* programa) {
+    fprintf(stderr, "Uso: %s [modo]\n", programa);
+    fprintf(stderr, "Sem argumentos, abre o menu interativo.\n\n");
+    fprintf(stderr, "Modos:\n");
+    fprintf(stderr, "  --lote [arquivo]    Processa cenários (um por linha) de arquivo ou da entrada padrão\n");
+    fprintf(stderr, "  --gerar N [semente] [navios]\n");
+    fprintf(stderr, "                      Gera N frotas aleatórias válidas no formato do modo em lote\n");
+    fprintf(stderr, "  --mira navios threads orcamento_ms semente [+l,c|-l,c ...]\n");
+    fprintf(stderr, "                      Escolhe o próximo tiro por Monte Carlo (+ acerto, - erro)\n");
+    fprintf(stderr, "  --torneio partidas threads semente [estrategia ...]\n");
+    fprintf(stderr, "                      Joga todos os confrontos entre as estratégias (aleatoria,\n");
+    fprintf(stderr, "                      caca-alvo, densidade) e exibe taxas de vitória em CSV\n");
+    fprintf(stderr, "  --simular estrategia partidas [threads] [semente]\n");
+    fprintf(stderr, "                      Joga muitas partidas contra cópias do cenário do nível Mestre\n");
+    fprintf(stderr, "  --mapa-calor estrategia partidas [threads] [semente] [csv|bin] [arquivo]\n");
+    fprintf(stderr, "                      Soma, por célula, navios por orientação, tiros e primeiros acertos\n");
+    fprintf(stderr, "                      de muitas partidas simuladas e exporta em CSV ou binário\n");
+    fprintf(stderr, "  --assistir estrategia [semente] [atraso_ms]\n");
+    fprintf(stderr, "                      Mostra ao vivo uma estratégia afundando uma frota aleatória\n");
+    fprintf(stderr, "  --transmitir arquivo espectadores [semente] [atraso_ms]\n");
+    fprintf(stderr, "                      Publica uma partida em memória compartilhada para threads espectadoras,\n");
+    fprintf(stderr, "                      cada uma com sua visão (neblina de guerra, anotações com cópia na escrita)\n");
+    fprintf(stderr, "  --espiar arquivo [papel]\n");
+    fprintf(stderr, "                      Mostra o estado atual de uma transmissão (jogador-a, jogador-b,\n");
+    fprintf(stderr, "                      espectador ou arbitro)\n");
+    fprintf(stderr, "  --bench [csv|json] [arquivo]\n");
+    fprintf(stderr, "                      Mede ns/op e alocações das funções do tabuleiro\n");
+    fprintf(stderr, "  --cobertura linhas colunas habilidades [semente]\n");
+    fprintf(stderr, "                      Conta quantas habilidades aleatórias cobrem cada célula\n");
+    fprintf(stderr, "  --formas arquivo [linhas colunas aplicacoes semente]\n");
+    fprintf(stderr, "                      Compila as formas de habilidade do arquivo ('-' só as padrão) e,\n");
+    fprintf(stderr, "                      opcionalmente, acumula aplicações aleatórias num tabuleiro\n");
+    fprintf(stderr, "  --combate linhas colunas navios habilidades [rodadas] [semente]\n");
+    fprintf(stderr, "                      Rodadas de combate num mapa grande: cada rodada consulta no índice\n");
+    fprintf(stderr, "                      espacial os navios alcançados pelas habilidades e os remove\n");
+    fprintf(stderr, "  --preguicoso linhas colunas habilidades consultas [rodadas] [semente]\n");
+    fprintf(stderr, "                      Compara a aplicação imediata de habilidades com a preguiçosa, que só\n");
+    fprintf(stderr, "                      materializa as células lidas\n");
+    fprintf(stderr, "  --salvar arquivo [semente] [habilidades]\n");
+    fprintf(stderr, "                      Grava um instantâneo binário de uma partida aleatória\n");
+    fprintf(stderr, "  --carregar arquivo  Abre um instantâneo (mmap), confere o checksum e o exibe\n");
+    fprintf(stderr, "  --gravar-eventos arquivo eventos [semente] [lado] [intervalo]\n");
+    fprintf(stderr, "                      Grava um registro de eventos aleatórios (navios, habilidades, tiros)\n");
+    fprintf(stderr, "  --reproduzir arquivo [evento]\n");
+    fprintf(stderr, "                      Reconstrói o tabuleiro até o evento pedido (padrão: o último)\n");
+    fprintf(stderr, "  --contar navios threads [+l,c|-l,c ...]\n");
+    fprintf(stderr, "                      Conta exatamente as frotas consistentes com os tiros e a\n");
+    fprintf(stderr, "                      ocupação de cada célula (referência para o modo --mira)\n");
+    fprintf(stderr, "  --servidor endereco Hospeda jogos para muitos clientes (unix:/caminho, tcp:porta ou tcp:ip:porta)\n");
+    fprintf(stderr, "  --cliente endereco partidas [conexoes] [semente]\n");
+    fprintf(stderr, "                      Joga partidas entre robôs contra o servidor e mede a latência\n");
+    fprintf(stderr, "  --ajuda             Exibe esta mensagem\n");
+}
+
+// Função para executar um modo não interativo; retorna o código de saída do programa
+int executarLinhaComando(int argc, char* argv[]) {
+    const char* modo = argv[1];
+    
+    if (strcmp(modo, "--lote") == 0) {
+        FILE* entrada = stdin;
+        if (argc > 2 && strcmp(argv[2], "-") != 0) {
+            entrada = fopen(argv[2], "r");
+            if (entrada == NULL) {
+                fprintf(stderr, "ERRO: não foi possível abrir %s\n", argv[2]);
+                return 1;
+            }
+        }
+        
+        double inicio = segundosMonotonicos();
+        long cenarios = executarModoLote(entrada, stdout);
+        double duracao = segundosMonotonicos() - inicio;
+        fprintf(stderr, "%ld cenários em %.3f s (%.0f cenários/s)\n",
+                cenarios, duracao, duracao > 0 ? cenarios / duracao : 0.0);
+        
+        if (entrada != stdin) {
+            fclose(entrada);
+        }
+        return 0;
+    }
+    
+    if (strcmp(modo, "--gerar") == 0 && argc > 2) {
+        long quantidade = atol(argv[2]);
+        uint64_t semente = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+        int num_navios = argc > 4 ? atoi(argv[4]) : 4;
+        
+        double inicio = segundosMonotonicos();
+        bool sucesso = executarGeradorFrotas(quantidade, semente, num_navios, stdout);
+        double duracao = segundosMonotonicos() - inicio;
+        fprintf(stderr, "%ld frotas em %.3f s (%.0f frotas/s)\n",
+                quantidade, duracao, duracao > 0 ? quantidade / duracao : 0.0);
+        return sucesso ? 0 : 1;
+    }
+    
+    if (strcmp(modo, "--mira") == 0 && argc > 5) {
+        int num_navios = atoi(argv[2]);
+        int num_threads = atoi(argv[3]);
+        double orcamento_ms = atof(argv[4]);
+        uint64_t semente = strtoull(argv[5], NULL, 10);
+        EstadoTiros tiros;
+        uint32_t contagens[TOTAL_CELULAS];
+        
+        inicializarEstadoTiros(&tiros);
+        for (int i = 6; i < argc; i++) {
+            if (!lerTiroTexto(argv[i], &tiros)) {
+                fprintf(stderr, "ERRO: tiro inválido: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        if (num_navios < 1 || num_navios > MAX_NAVIOS_FROTA) {
+            fprintf(stderr, "ERRO: a frota deve ter entre 1 e %d navios\n", MAX_NAVIOS_FROTA);
+            return 1;
+        }
+        
+        ResultadoMira mira = escolherAlvoMonteCarlo(&tiros, num_navios, num_threads, orcamento_ms,
+                                                    LONG_MAX, semente, contagens);
+        exibirMapaDensidade(contagens, mira.amostras, &tiros);
+        printf("alvo %d,%d probabilidade %.3f amostras %ld tentativas %ld\n",
+               mira.linha, mira.coluna, mira.probabilidade, mira.amostras, mira.tentativas);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--torneio") == 0 && argc > 4) {
+        long partidas = atol(argv[2]);
+        int num_threads = atoi(argv[3]);
+        uint64_t semente = strtoull(argv[4], NULL, 10);
+        EstrategiaTiro estrategias[NUM_ESTRATEGIAS];
+        int num_estrategias = 0;
+        
+        for (int i = 5; i < argc && num_estrategias < NUM_ESTRATEGIAS; i++) {
+            int estrategia = lerNomeEstrategia(argv[i]);
+            if (estrategia < 0) {
+                fprintf(stderr, "ERRO: estratégia desconhecida: %s\n", argv[i]);
+                return 1;
+            }
+            estrategias[num_estrategias++] = estrategia;
+        }
+        if (num_estrategias == 0) {
+            for (int e = 0; e < NUM_ESTRATEGIAS; e++) {
+                estrategias[num_estrategias++] = e;
+            }
+        }
+        
+        // Todos contra todos; com uma única estratégia, ela joga contra si mesma
+        EstrategiaTiro confrontos[NUM_ESTRATEGIAS * NUM_ESTRATEGIAS][2];
+        EstatisticasConfronto estatisticas[NUM_ESTRATEGIAS * NUM_ESTRATEGIAS];
+        int num_confrontos = 0;
+        for (int a = 0; a < num_estrategias; a++) {
+            for (int b = a + 1; b < num_estrategias; b++) {
+                confrontos[num_confrontos][0] = estrategias[a];
+                confrontos[num_confrontos][1] = estrategias[b];
+                num_confrontos++;
+            }
+        }
+        if (num_confrontos == 0) {
+            confrontos[0][0] = confrontos[0][1] = estrategias[0];
+            num_confrontos = 1;
+        }
+        
+        double inicio = segundosMonotonicos();
+        if (!executarTorneio(confrontos, num_confrontos, partidas, NAVIOS_PADRAO_PARTIDA, num_threads,
+                             semente, estatisticas)) {
+            fprintf(stderr, "ERRO: memória insuficiente ou frota impossível de posicionar no torneio\n");
+            return 1;
+        }
+        double duracao = segundosMonotonicos() - inicio;
+        
+        exibirRelatorioTorneio(confrontos, num_confrontos, estatisticas);
+        fprintf(stderr, "%ld partidas em %.3f s (%.0f partidas/s)\n", partidas * num_confrontos, duracao,
+                duracao > 0 ? partidas * num_confrontos / duracao : 0.0);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--simular") == 0 && argc > 3) {
+        int estrategia = lerNomeEstrategia(argv[2]);
+        if (estrategia < 0) {
+            fprintf(stderr, "ERRO: estratégia desconhecida: %s\n", argv[2]);
+            return 1;
+        }
+        long partidas = atol(argv[3]);
+        int num_threads = argc > 4 ? atoi(argv[4]) : obterNumeroNucleos();
+        uint64_t semente = argc > 5 ? strtoull(argv[5], NULL, 10) : 1;
+        EstadoJogo modelo;
+        double media_tiros;
+        int min_tiros, max_tiros;
+        
+        montarEstadoNivelMestre(&modelo);
+        double inicio = segundosMonotonicos();
+        if (!simularSobreModelo(&modelo, estrategia, partidas, num_threads, semente,
+                                &media_tiros, &min_tiros, &max_tiros)) {
+            fprintf(stderr, "ERRO: memória insuficiente para a simulação\n");
+            return 1;
+        }
+        double duracao = segundosMonotonicos() - inicio;
+        
+        printf("estrategia,partidas,media_tiros,min_tiros,max_tiros\n");
+        printf("%s,%ld,%.2f,%d,%d\n", obterNomeEstrategia(estrategia), partidas, media_tiros, min_tiros, max_tiros);
+        fprintf(stderr, "%ld partidas em %.3f s (%.0f partidas/s)\n", partidas, duracao,
+                duracao > 0 ? partidas / duracao : 0.0);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--mapa-calor") == 0 && argc > 3) {
+        int estrategia = lerNomeEstrategia(argv[2]);
+        long partidas = atol(argv[3]);
+        int num_threads = argc > 4 ? atoi(argv[4]) : 0;
+        uint64_t semente = argc > 5 ? strtoull(argv[5], NULL, 10) : 1;
+        bool binario = argc > 6 && strcmp(argv[6], "bin") == 0;
+        const char* caminho = argc > 7 ? argv[7] : NULL;
+        if (estrategia < 0) {
+            fprintf(stderr, "ERRO: estratégia desconhecida: %s\n", argv[2]);
+            return 1;
+        }
+        if (partidas < 1 || (binario && caminho == NULL)) {
+            fprintf(stderr, "ERRO: informe partidas > 0 (e um arquivo para o formato binário)\n");
+            return 1;
+        }
+        
+        MapaCalor* mapa = alocarMemoriaAlinhada(64, sizeof(MapaCalor));
+        double inicio = segundosMonotonicos();
+        if (mapa == NULL || !gerarMapaCalor(mapa, estrategia, partidas, num_threads, semente)) {
+            fprintf(stderr, "ERRO: memória insuficiente ou frota impossível de posicionar no mapa de calor\n");
+            free(mapa);
+            return 1;
+        }
+        double duracao = segundosMonotonicos() - inicio;
+        
+        bool sucesso = true;
+        if (binario) {
+            sucesso = exportarMapaCalorBinario(mapa, caminho);
+        } else {
+            FILE* saida = caminho != NULL ? fopen(caminho, "w") : stdout;
+            sucesso = saida != NULL;
+            if (sucesso) {
+                exportarMapaCalorCsv(mapa, saida);
+                sucesso = saida == stdout ? fflush(saida) == 0 : fclose(saida) == 0;
+            }
+        }
+        free(mapa);
+        if (!sucesso) {
+            fprintf(stderr, "ERRO: não foi possível gravar o mapa de calor\n");
+            return 1;
+        }
+        fprintf(stderr, "%ld partidas em %.3f s (%.0f partidas/s)\n", partidas, duracao,
+                duracao > 0 ? partidas / duracao : 0.0);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--assistir") == 0 && argc > 2) {
+        int estrategia = lerNomeEstrategia(argv[2]);
+        if (estrategia < 0) {
+            fprintf(stderr, "ERRO: estratégia desconhecida: %s\n", argv[2]);
+            return 1;
+        }
+        uint64_t semente = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+        int atraso_ms = argc > 4 ? atoi(argv[4]) : 100;
+        
+        return assistirPartida(estrategia, semente, atraso_ms) ? 0 : 1;
+    }
+    
+    if (strcmp(modo, "--transmitir") == 0 && argc > 3) {
+        int espectadores = atoi(argv[3]);
+        uint64_t semente = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+        int atraso_ms = argc > 5 ? atoi(argv[5]) : 1;
+        
+        if (!executarTransmissao(argv[2], espectadores, semente, atraso_ms)) {
+            fprintf(stderr, "ERRO: falha na transmissão em %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (strcmp(modo, "--espiar") == 0 && argc > 2) {
+        int papel = argc > 3 ? lerNomePapel(argv[3]) : PAPEL_ESPECTADOR;
+        if (papel < 0) {
+            fprintf(stderr, "ERRO: papel desconhecido: %s\n", argv[3]);
+            return 1;
+        }
+        if (!espiarTransmissao(argv[2], papel)) {
+            fprintf(stderr, "ERRO: não foi possível abrir a transmissão %s\n", argv[2]);
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (strcmp(modo, "--bench") == 0) {
+        bool json = argc > 2 && strcmp(argv[2], "json") == 0;
+        FILE* saida = stdout;
+        if (argc > 3) {
+            saida = fopen(argv[3], "w");
+            if (saida == NULL) {
+                fprintf(stderr, "ERRO: não foi possível criar %s\n", argv[3]);
+                return 1;
+            }
+        }
+        
+        bool sucesso = executarBenchmarks(saida, json);
+        if (saida != stdout) {
+            fclose(saida);
+        }
+        return sucesso ? 0 : 1;
+    }
+    
+    if (strcmp(modo, "--cobertura") == 0 && argc > 4) {
+        int linhas = atoi(argv[2]);
+        int colunas = atoi(argv[3]);
+        long num_habilidades = atol(argv[4]);
+        uint64_t semente = argc > 5 ? strtoull(argv[5], NULL, 10) : 1;
+        if (linhas <= 0 || colunas <= 0 || num_habilidades < 0) {
+            fprintf(stderr, "ERRO: dimensões ou quantidade inválidas\n");
+            return 1;
+        }
+        
+        HabilidadeEspecial* habilidades = alocarMemoria((size_t) num_habilidades * sizeof(HabilidadeEspecial) + 1);
+        uint32_t* cobertura = alocarMemoria((size_t) linhas * colunas * sizeof(uint32_t));
+        if (habilidades == NULL || cobertura == NULL) {
+            fprintf(stderr, "ERRO: memória insuficiente\n");
+            free(habilidades);
+            free(cobertura);
+            return 1;
+        }
+        
+        // Só o tipo e a origem importam para a cobertura; a matriz não é preenchida
+        GeradorAleatorio gerador;
+        semearGerador(&gerador, semente, 0);
+        for (long h = 0; h < num_habilidades; h++) {
+            habilidades[h].tipo = (TipoHabilidade) aleatorioAte(&gerador, 3);
+            habilidades[h].linha_origem = (int) aleatorioAte(&gerador, (uint32_t) linhas);
+            habilidades[h].coluna_origem = (int) aleatorioAte(&gerador, (uint32_t) colunas);
+            habilidades[h].nome = "Lote";
+        }
+        
+        double inicio = segundosMonotonicos();
+        calcularCoberturaLote(habilidades, num_habilidades, linhas, colunas, cobertura);
+        double duracao = segundosMonotonicos() - inicio;
+        
+        uint64_t soma = 0;
+        uint32_t maximo = 0;
+        size_t cobertas = 0;
+        for (size_t i = 0; i < (size_t) linhas * colunas; i++) {
+            soma += cobertura[i];
+            cobertas += cobertura[i] > 0;
+            maximo = cobertura[i] > maximo ? cobertura[i] : maximo;
+        }
+        
+        // Tabuleiros pequenos são exibidos por inteiro
+        if (linhas <= 40 && colunas <= 40) {
+            for (int i = 0; i < linhas; i++) {
+                for (int j = 0; j < colunas; j++) {
+                    printf("%3u", cobertura[(size_t) i * colunas + j]);
+                }
+                printf("\n");
+            }
+        }
+        printf("celulas_cobertas %zu cobertura_maxima %u soma %llu\n", cobertas, maximo, (unsigned long long) soma);
+        fprintf(stderr, "%ld habilidades em %.3f s (%.0f habilidades/s)\n", num_habilidades, duracao,
+                duracao > 0 ? num_habilidades / duracao : 0.0);
+        
+        free(habilidades);
+        free(cobertura);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--formas") == 0 && argc > 2) {
+        static CatalogoFormas catalogo;
+        if (!adicionarFormasPadrao(&catalogo)) {
+            fprintf(stderr, "ERRO: memória insuficiente para as formas\n");
+            return 1;
+        }
+        if (strcmp(argv[2], "-") != 0) {
+            FILE* entrada = fopen(argv[2], "r");
+            if (entrada == NULL) {
+                fprintf(stderr, "ERRO: não foi possível abrir %s\n", argv[2]);
+                liberarCatalogoFormas(&catalogo);
+                return 1;
+            }
+            int linha_erro;
+            bool carregado = carregarFormasHabilidade(entrada, &catalogo, &linha_erro);
+            fclose(entrada);
+            if (!carregado) {
+                if (linha_erro > 0) {
+                    fprintf(stderr, "ERRO: forma inválida em %s, linha %d\n", argv[2], linha_erro);
+                } else {
+                    fprintf(stderr, "ERRO: memória ou catálogo insuficiente para as formas\n");
+                }
+                liberarCatalogoFormas(&catalogo);
+                return 1;
+            }
+        }
+        exibirCatalogoFormas(&catalogo, stdout);
+        
+        if (argc > 5) {
+            int linhas = atoi(argv[3]);
+            int colunas = atoi(argv[4]);
+            long num_aplicacoes = atol(argv[5]);
+            uint64_t semente = argc > 6 ? strtoull(argv[6], NULL, 10) : 1;
+            if (linhas < 1 || colunas < 1 || num_aplicacoes < 0) {
+                fprintf(stderr, "ERRO: dimensões ou quantidade inválidas\n");
+                liberarCatalogoFormas(&catalogo);
+                return 1;
+            }
+            
+            AplicacaoForma* aplicacoes = alocarMemoria(sizeof(AplicacaoForma) * (size_t) (num_aplicacoes > 0 ? num_aplicacoes : 1));
+            uint32_t* intensidade = alocarMemoria((size_t) linhas * colunas * sizeof(uint32_t));
+            if (aplicacoes == NULL || intensidade == NULL) {
+                fprintf(stderr, "ERRO: memória insuficiente para %ld aplicações em %dx%d\n", num_aplicacoes, linhas, colunas);
+                free(aplicacoes);
+                free(intensidade);
+                liberarCatalogoFormas(&catalogo);
+                return 1;
+            }
+            GeradorAleatorio gerador;
+            semearGerador(&gerador, semente, 0);
+            for (long a = 0; a < num_aplicacoes; a++) {
+                aplicacoes[a].forma = (int) aleatorioAte(&gerador, (uint32_t) catalogo.num_formas);
+                aplicacoes[a].linha = (int) aleatorioAte(&gerador, (uint32_t) linhas);
+                aplicacoes[a].coluna = (int) aleatorioAte(&gerador, (uint32_t) colunas);
+            }
+            
+            double inicio = segundosMonotonicos();
+            acumularFormasLote(&catalogo, aplicacoes, num_aplicacoes, linhas, colunas, intensidade);
+            double duracao = segundosMonotonicos() - inicio;
+            
+            uint64_t soma = 0;
+            uint32_t maximo = 0;
+            for (size_t c = 0; c < (size_t) linhas * colunas; c++) {
+                soma += intensidade[c];
+                maximo = intensidade[c] > maximo ? intensidade[c] : maximo;
+            }
+            printf("intensidade total %llu, máxima %u\n", (unsigned long long) soma, maximo);
+            fprintf(stderr, "%ld aplicações em %dx%d em %.3f s (%.1f ns por aplicação)\n", num_aplicacoes, linhas,
+                    colunas, duracao, num_aplicacoes > 0 ? duracao * 1e9 / num_aplicacoes : 0.0);
+            free(aplicacoes);
+            free(intensidade);
+        }
+        liberarCatalogoFormas(&catalogo);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--combate") == 0 && argc > 5) {
+        int linhas = atoi(argv[2]);
+        int colunas = atoi(argv[3]);
+        long num_navios = atol(argv[4]);
+        long num_habilidades = atol(argv[5]);
+        int rodadas = argc > 6 ? atoi(argv[6]) : 1;
+        uint64_t semente = argc > 7 ? strtoull(argv[7], NULL, 10) : 1;
+        if (linhas < TAMANHO_NAVIO || colunas < TAMANHO_NAVIO || num_navios < 0 || num_habilidades < 1 || rodadas < 1) {
+            fprintf(stderr, "ERRO: parâmetros inválidos para o combate\n");
+            return 1;
+        }
+        
+        TabuleiroGrande mapa;
+        IndiceEspacialNavios indice;
+        ResultadoConsultaLote resultado;
+        memset(&resultado, 0, sizeof(resultado));
+        HabilidadeEspecial* habilidades = alocarMemoria(sizeof(HabilidadeEspecial) * (size_t) num_habilidades);
+        bool sucesso = habilidades != NULL && criarTabuleiroGrande(&mapa, linhas, colunas);
+        if (sucesso && !criarIndiceNavios(&indice, linhas, colunas)) {
+            destruirTabuleiroGrande(&mapa);
+            sucesso = false;
+        }
+        if (!sucesso) {
+            fprintf(stderr, "ERRO: memória insuficiente para o mapa %dx%d\n", linhas, colunas);
+            free(habilidades);
+            return 1;
+        }
+        
+        // Frota sem sobreposição: o mapa rejeita posições ocupadas
+        GeradorAleatorio gerador;
+        semearGerador(&gerador, semente, 0);
+        long tentativas = 0;
+        while (indice.num_navios < num_navios && tentativas++ < num_navios * 8) {
+            Navio navio = {(int) aleatorioAte(&gerador, (uint32_t) linhas), (int) aleatorioAte(&gerador, (uint32_t) colunas),
+                           (OrientacaoNavio) aleatorioAte(&gerador, 4), "Navio"};
+            if (posicionarNavioGrande(&mapa, navio) && inserirNavioIndice(&indice, navio) < 0) {
+                sucesso = false;
+                break;
+            }
+        }
+        printf("%d navios posicionados em %dx%d\n", indice.num_navios, linhas, colunas);
+        
+        double tempo_consultas = 0.0;
+        long total_acertos = 0;
+        for (int r = 0; r < rodadas && sucesso; r++) {
+            for (long h = 0; h < num_habilidades; h++) {
+                habilidades[h].tipo = (TipoHabilidade) aleatorioAte(&gerador, 3);
+                habilidades[h].linha_origem = (int) aleatorioAte(&gerador, (uint32_t) linhas);
+                habilidades[h].coluna_origem = (int) aleatorioAte(&gerador, (uint32_t) colunas);
+            }
+            
+            double inicio = segundosMonotonicos();
+            sucesso = consultarHabilidadesIndice(&indice, habilidades, num_habilidades, &resultado);
+            tempo_consultas += segundosMonotonicos() - inicio;
+            
+            // Navios alcançados saem do combate (o mesmo navio pode ter sido alcançado por várias habilidades)
+            int afundados = 0;
+            for (long a = 0; sucesso && a < resultado.num_acertos; a++) {
+                afundados += removerNavioIndice(&indice, resultado.navios[a]);
+            }
+            total_acertos += resultado.num_acertos;
+            printf("rodada %d: %ld acertos, %d navios removidos, %d restantes\n", r + 1, resultado.num_acertos,
+                   afundados, indice.num_navios);
+        }
+        fprintf(stderr, "%ld consultas em %.3f s (%.1f ns por habilidade, %ld acertos)\n",
+                num_habilidades * rodadas, tempo_consultas, tempo_consultas * 1e9 / ((double) num_habilidades * rodadas),
+                total_acertos);
+        
+        liberarResultadoConsulta(&resultado);
+        destruirIndiceNavios(&indice);
+        destruirTabuleiroGrande(&mapa);
+        free(habilidades);
+        if (!sucesso) {
+            fprintf(stderr, "ERRO: memória insuficiente durante o combate\n");
+            return 1;
+        }
+        return 0;
+    }
+    
+    if (strcmp(modo, "--preguicoso") == 0 && argc > 5) {
+        int linhas = atoi(argv[2]);
+        int colunas = atoi(argv[3]);
+        long num_habilidades = atol(argv[4]);
+        long consultas = atol(argv[5]);
+        int rodadas = argc > 6 ? atoi(argv[6]) : 1;
+        uint64_t semente = argc > 7 ? strtoull(argv[7], NULL, 10) : 1;
+        if (linhas < 1 || colunas < 1 || num_habilidades < 1 || consultas < 1 || rodadas < 1) {
+            fprintf(stderr, "ERRO: parâmetros inválidos para a comparação\n");
+            return 1;
+        }
+        
+        TabuleiroGrande imediato;
+        TabuleiroPreguicoso preguicoso;
+        HabilidadeEspecial* habilidades = alocarMemoria(sizeof(HabilidadeEspecial) * (size_t) num_habilidades);
+        int* celulas = alocarMemoria(sizeof(int) * 2 * (size_t) consultas);
+        bool criado_imediato = criarTabuleiroGrande(&imediato, linhas, colunas);
+        bool criado_preguicoso = criarTabuleiroPreguicoso(&preguicoso, linhas, colunas);
+        if (habilidades == NULL || celulas == NULL || !criado_imediato || !criado_preguicoso) {
+            fprintf(stderr, "ERRO: memória insuficiente para o mapa %dx%d\n", linhas, colunas);
+            free(habilidades);
+            free(celulas);
+            destruirTabuleiroGrande(&imediato);
+            destruirTabuleiroPreguicoso(&preguicoso);
+            return 1;
+        }
+        
+        // Mesma frota nos dois tabuleiros: um navio a cada 200 células, em média
+        GeradorAleatorio gerador;
+        semearGerador(&gerador, semente, 0);
+        for (long n = (long) linhas * colunas / 200; n > 0; n--) {
+            Navio navio = {(int) aleatorioAte(&gerador, (uint32_t) linhas), (int) aleatorioAte(&gerador, (uint32_t) colunas),
+                           (OrientacaoNavio) aleatorioAte(&gerador, 4), "Navio"};
+            posicionarNavioGrande(&imediato, navio);
+            posicionarNavioPreguicoso(&preguicoso, navio);
+        }
+        
+        // A cada rodada chegam as habilidades e são lidas as células; ao fim, os dois tabuleiros
+        // são materializados e comparados célula a célula
+        double tempo_imediato = 0, tempo_preguicoso = 0;
+        long divergencias = 0;
+        for (int r = 0; r < rodadas; r++) {
+            for (long h = 0; h < num_habilidades; h++) {
+                habilidades[h].tipo = (TipoHabilidade) aleatorioAte(&gerador, 3);
+                habilidades[h].linha_origem = (int) aleatorioAte(&gerador, (uint32_t) linhas);
+                habilidades[h].coluna_origem = (int) aleatorioAte(&gerador, (uint32_t) colunas);
+            }
+            for (long q = 0; q < consultas; q++) {
+                celulas[2 * q] = (int) aleatorioAte(&gerador, (uint32_t) linhas);
+                celulas[2 * q + 1] = (int) aleatorioAte(&gerador, (uint32_t) colunas);
+            }
+            
+            long soma_imediato = 0, soma_preguicoso = 0;
+            double inicio = segundosMonotonicos();
+            for (long h = 0; h < num_habilidades; h++) {
+                aplicarHabilidadeGrande(&imediato, &habilidades[h]);
+            }
+            for (long q = 0; q < consultas; q++) {
+                soma_imediato += obterCelulaGrande(&imediato, celulas[2 * q], celulas[2 * q + 1]);
+            }
+            double meio = segundosMonotonicos();
+            for (long h = 0; h < num_habilidades; h++) {
+                enfileirarHabilidadePreguicosa(&preguicoso, &habilidades[h]);
+            }
+            for (long q = 0; q < consultas; q++) {
+                soma_preguicoso += obterCelulaPreguicosa(&preguicoso, celulas[2 * q], celulas[2 * q + 1]);
+            }
+            double fim = segundosMonotonicos();
+            
+            tempo_imediato += meio - inicio;
+            tempo_preguicoso += fim - meio;
+            divergencias += soma_imediato != soma_preguicoso;
+        }
+        long resolvidas_nas_rodadas = preguicoso.celulas_resolvidas;
+        long pendentes = contarPendentesPreguicoso(&preguicoso);
+        
+        bool sucesso = materializarTudoPreguicoso(&preguicoso);
+        for (int i = 0; i < linhas && sucesso; i++) {
+            for (int j = 0; j < colunas; j++) {
+                divergencias += obterCelulaGrande(&imediato, i, j) != obterCelulaGrande(&preguicoso.base, i, j);
+            }
+        }
+        divergencias += contarEfeitoGrande(&imediato) != contarEfeitoGrande(&preguicoso.base);
+        
+        printf("modo,segundos,celulas_escritas\n");
+        printf("imediato,%.6f,%ld\n", tempo_imediato, preguicoso.celulas_enfileiradas);
+        printf("preguicoso,%.6f,%ld\n", tempo_preguicoso, resolvidas_nas_rodadas);
+        fprintf(stderr, "%ld células enfileiradas, %ld pendentes ao fim (sem repetições), %ld materializadas no total\n",
+                preguicoso.celulas_enfileiradas, pendentes, preguicoso.celulas_resolvidas);
+        if (divergencias > 0) {
+            fprintf(stderr, "ERRO: %ld divergências entre a aplicação imediata e a preguiçosa\n", divergencias);
+        }
+        
+        free(habilidades);
+        free(celulas);
+        destruirTabuleiroGrande(&imediato);
+        destruirTabuleiroPreguicoso(&preguicoso);
+        return sucesso && divergencias == 0 ? 0 : 1;
+    }
+    
+    if (strcmp(modo, "--salvar") == 0 && argc > 2) {
+        uint64_t semente = argc > 3 ? strtoull(argv[3], NULL, 10) : 1;
+        int num_habilidades = argc > 4 ? atoi(argv[4]) : 3;
+        Navio navios[NAVIOS_PADRAO_PARTIDA];
+        HabilidadeEspecial habilidades[64];
+        TabuleiroBits bits;
+        int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO];
+        GeradorAleatorio gerador;
+        
+        if (num_habilidades < 0 || num_habilidades > 64) {
+            fprintf(stderr, "ERRO: o número de habilidades deve estar entre 0 e 64\n");
+            return 1;
+        }
+        
+        semearGerador(&gerador, semente, 0);
+        if (gerarFrotaAleatoria(&gerador, NAVIOS_PADRAO_PARTIDA, navios, &bits) == 0) {
+            fprintf(stderr, "ERRO: não foi possível posicionar a frota\n");
+            return 1;
+        }
+        for (int h = 0; h < num_habilidades; h++) {
+            habilidades[h].tipo = (TipoHabilidade) (h % 3);
+            habilidades[h].linha_origem = (int) aleatorioAte(&gerador, TAMANHO_TABULEIRO);
+            habilidades[h].coluna_origem = (int) aleatorioAte(&gerador, TAMANHO_TABULEIRO);
+            habilidades[h].nome = "Aleatória";
+            aplicarHabilidadeBits(&bits, &habilidades[h]);
+        }
+        tabuleiroBitsParaMatriz(&bits, tabuleiro);
+        
+        size_t tamanho = tamanhoInstantaneo(TAMANHO_TABULEIRO, TAMANHO_TABULEIRO, NAVIOS_PADRAO_PARTIDA,
+                                            num_habilidades);
+        void* dados = alocarMemoria(tamanho);
+        if (dados == NULL) {
+            fprintf(stderr, "ERRO: memória insuficiente\n");
+            return 1;
+        }
+        serializarInstantaneoMatriz(dados, tabuleiro, navios, NAVIOS_PADRAO_PARTIDA, habilidades, num_habilidades);
+        bool sucesso = gravarInstantaneoArquivo(argv[2], dados, tamanho);
+        free(dados);
+        
+        if (!sucesso) {
+            fprintf(stderr, "ERRO: não foi possível gravar %s\n", argv[2]);
+            return 1;
+        }
+        printf("%zu bytes gravados em %s\n", tamanho, argv[2]);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--carregar") == 0 && argc > 2) {
+        VistaInstantaneo vista;
+        double inicio = segundosMonotonicos();
+        StatusInstantaneo status = abrirInstantaneo(argv[2], &vista);
+        double duracao = segundosMonotonicos() - inicio;
+        if (status != INSTANTANEO_OK) {
+            fprintf(stderr, "ERRO: %s: %s\n", argv[2], obterDescricaoStatusInstantaneo(status));
+            return 1;
+        }
+        
+        const CabecalhoInstantaneo* cabecalho = vista.cabecalho;
+        printf("Instantâneo v%u: %ux%u, %u navios, %u habilidades, %llu bytes\n", cabecalho->versao,
+               cabecalho->linhas, cabecalho->colunas, cabecalho->num_navios, cabecalho->num_habilidades,
+               (unsigned long long) cabecalho->tamanho_total);
+        for (uint32_t i = 0; i < cabecalho->num_navios; i++) {
+            Navio navio = obterNavioInstantaneo(&vista, (int) i);
+            printf("Navio %u: (%d,%d) - %s\n", i + 1, navio.linha, navio.coluna,
+                   obterNomeOrientacao(navio.orientacao));
+        }
+        for (uint32_t i = 0; i < cabecalho->num_habilidades; i++) {
+            HabilidadeEspecial habilidade;
+            obterHabilidadeInstantaneo(&vista, (int) i, &habilidade);
+            printf("Habilidade %u: %s em (%d,%d)\n", i + 1, habilidade.nome, habilidade.linha_origem,
+                   habilidade.coluna_origem);
+        }
+        printf("\n");
+        
+        // O tabuleiro padrão é exibido; os demais são carregados e resumidos
+        if (cabecalho->linhas == TAMANHO_TABULEIRO && cabecalho->colunas == TAMANHO_TABULEIRO) {
+            int tabuleiro[TAMANHO_TABULEIRO][TAMANHO_TABULEIRO];
+            for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
+                for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+                    tabuleiro[i][j] = obterCelulaInstantaneo(&vista, i, j);
+                }
+            }
+            exibirTabuleiro(tabuleiro);
+        } else {
+            TabuleiroGrande grande;
+            if (!carregarInstantaneoGrande(&vista, &grande)) {
+                fprintf(stderr, "ERRO: memória insuficiente\n");
+                fecharInstantaneo(&vista);
+                return 1;
+            }
+            printf("Água: %ld, navios: %ld, área de efeito: %ld\n", contarAguaGrande(&grande),
+                   contarNaviosGrande(&grande), contarEfeitoGrande(&grande));
+            destruirTabuleiroGrande(&grande);
+        }
+        
+        fecharInstantaneo(&vista);
+        fprintf(stderr, "aberto e verificado em %.3f ms\n", duracao * 1000.0);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--gravar-eventos") == 0 && argc > 3) {
+        long quantidade = atol(argv[3]);
+        uint64_t semente = argc > 4 ? strtoull(argv[4], NULL, 10) : 1;
+        int lado = argc > 5 ? atoi(argv[5]) : 1000;
+        int intervalo = argc > 6 ? atoi(argv[6]) : INTERVALO_PONTO_CONTROLE_PADRAO;
+        RegistroEventos registro;
+        GeradorAleatorio gerador;
+        
+        if (lado <= 0 || !criarRegistroEventos(&registro, argv[2], lado, lado, intervalo)) {
+            fprintf(stderr, "ERRO: não foi possível criar %s\n", argv[2]);
+            return 1;
+        }
+        
+        // Mistura de eventos: 20% navios, 10% habilidades e 70% tiros. Navios inválidos não entram no registro.
+        semearGerador(&gerador, semente, 0);
+        double inicio = segundosMonotonicos();
+        long registrados = 0;
+        for (long i = 0; i < quantidade; i++) {
+            uint32_t sorteio = aleatorioAte(&gerador, 10);
+            int linha = (int) aleatorioAte(&gerador, (uint32_t) lado);
+            int coluna = (int) aleatorioAte(&gerador, (uint32_t) lado);
+            
+            if (sorteio < 2) {
+                Navio navio = {linha, coluna, (OrientacaoNavio) aleatorioAte(&gerador, 4), "Navio"};
+                registrados += registrarEventoNavio(&registro, navio);
+            } else if (sorteio < 3) {
+                HabilidadeEspecial habilidade;
+                habilidade.tipo = (TipoHabilidade) aleatorioAte(&gerador, 3);
+                habilidade.linha_origem = linha;
+                habilidade.coluna_origem = coluna;
+                registrados += registrarEventoHabilidade(&registro, &habilidade);
+            } else {
+                registrados += registrarEventoTiro(&registro, linha, coluna);
+            }
+        }
+        if (!fecharRegistroEventos(&registro)) {
+            fprintf(stderr, "ERRO: falha ao gravar %s\n", argv[2]);
+            return 1;
+        }
+        double duracao = segundosMonotonicos() - inicio;
+        
+        struct stat informacoes;
+        long bytes = stat(argv[2], &informacoes) == 0 ? (long) informacoes.st_size : 0;
+        printf("%ld eventos, %ld bytes (%.2f bytes/evento)\n", registrados, bytes,
+               registrados > 0 ? (double) bytes / registrados : 0.0);
+        fprintf(stderr, "gravados em %.3f s (%.0f eventos/s)\n", duracao, duracao > 0 ? registrados / duracao : 0.0);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--reproduzir") == 0 && argc > 2) {
+        ReprodutorEventos reprodutor;
+        if (!abrirReprodutor(&reprodutor, argv[2])) {
+            fprintf(stderr, "ERRO: não foi possível abrir o registro %s\n", argv[2]);
+            return 1;
+        }
+        long alvo = argc > 3 ? atol(argv[3]) : reprodutor.total_eventos;
+        
+        double inicio = segundosMonotonicos();
+        long alcancado = reproduzirAte(&reprodutor, alvo);
+        double duracao = segundosMonotonicos() - inicio;
+        if (alcancado < 0) {
+            fprintf(stderr, "ERRO: ponto de controle corrompido em %s\n", argv[2]);
+            fecharReprodutor(&reprodutor);
+            return 1;
+        }
+        
+        printf("evento %ld de %ld (%d pontos de controle), tabuleiro %dx%d\n", alcancado, reprodutor.total_eventos,
+               reprodutor.num_pontos, reprodutor.linhas, reprodutor.colunas);
+        printf("água %ld, navios %ld, área de efeito %ld, tiros %ld, acertos %ld\n",
+               contarAguaGrande(&reprodutor.tabuleiro), contarNaviosGrande(&reprodutor.tabuleiro),
+               contarEfeitoGrande(&reprodutor.tabuleiro), reprodutor.tiros, reprodutor.acertos);
+        fprintf(stderr, "reproduzido em %.3f s\n", duracao);
+        fecharReprodutor(&reprodutor);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--contar") == 0 && argc > 3) {
+        int num_navios = atoi(argv[2]);
+        int num_threads = atoi(argv[3]);
+        EstadoTiros tiros;
+        ResultadoContagemExata contagem;
+        char texto[48];
+        
+        inicializarEstadoTiros(&tiros);
+        for (int i = 4; i < argc; i++) {
+            if (!lerTiroTexto(argv[i], &tiros)) {
+                fprintf(stderr, "ERRO: tiro inválido: %s\n", argv[i]);
+                return 1;
+            }
+        }
+        if (num_navios < 1 || num_navios > MAX_NAVIOS_FROTA) {
+            fprintf(stderr, "ERRO: a frota deve ter entre 1 e %d navios\n", MAX_NAVIOS_FROTA);
+            return 1;
+        }
+        if (!contarFrotasExato(&tiros, num_navios, num_threads, &contagem)) {
+            fprintf(stderr, "ERRO: memória insuficiente para a contagem\n");
+            return 1;
+        }
+        
+        // Mapa em porcentagem de frotas com navio em cada célula, no mesmo formato do modo --mira
+        printf("   ");
+        for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+            printf("%4d", j);
+        }
+        printf("\n");
+        for (int i = 0; i < TAMANHO_TABULEIRO; i++) {
+            printf("%2d|", i);
+            for (int j = 0; j < TAMANHO_TABULEIRO; j++) {
+                int indice = i * TAMANHO_TABULEIRO + j;
+                if (mascaraTestarCelula(tiros.acertos, indice)) {
+                    printf("   X");
+                } else if (mascaraTestarCelula(tiros.erros, indice)) {
+                    printf("   o");
+                } else {
+                    printf("%4.0f", contagem.total > 0
+                           ? 100.0 * (double) contagem.ocupacao[indice] / (double) contagem.total : 0.0);
+                }
+            }
+            printf("\n");
+        }
+        
+        printf("frotas %s\n", formatarContagemExata(contagem.total, texto));
+        fprintf(stderr, "contadas em %.3f s\n", contagem.segundos);
+        return 0;
+    }
+    
+    if (strcmp(modo, "--servidor") == 0 && argc > 2) {
+        return executarServidor(argv[2]) ? 0 : 1;
+    }
+    
+    if (strcmp(modo, "--cliente") == 0 && argc > 3) {
+        long partidas = atol(argv[3]);
+        int conexoes = argc > 4 ? atoi(argv[4]) : 1;
+        uint64_t semente = argc > 5 ? strtoull(argv[5], NULL, 10) : 1;
+        return executarClienteTeste(argv[2], partidas, conexoes, semente) ? 0 : 1;
+    }
+    
+    if (strcmp(modo, "--ajuda") != 0) {
+        fprintf(stderr, "Modo desconhecido: %s\n\n", modo);
+    }
+    exibirAjudaLinhaComando(argv[0]);
+    return strcmp(modo, "--ajuda") == 0 ? 0 : 1;
+}
+
 // =====================================================================
 // FUNÇÃO PRINCIPAL
 // =====================================================================
 
-int main() {
+int main(int argc, char* argv[]) {
+    inicializarInstrumentacao();
+    
+    if (argc > 1) {
+        return executarLinhaComando(argc, argv);
+    }
+    
     int opcao;
     
     do {